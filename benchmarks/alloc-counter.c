@@ -0,0 +1,71 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <glib.h>
+#include <stdlib.h>
+
+#include "alloc-counter.h"
+
+static guint64 n_allocations = 0;
+static __thread guint64 n_thread_allocations = 0;
+
+#ifdef __GLIBC__
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n_members, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+  __atomic_add_fetch(&n_allocations, 1, __ATOMIC_RELAXED);
+  n_thread_allocations++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n_members, size_t size) {
+  __atomic_add_fetch(&n_allocations, 1, __ATOMIC_RELAXED);
+  n_thread_allocations++;
+  return __libc_calloc(n_members, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  __atomic_add_fetch(&n_allocations, 1, __ATOMIC_RELAXED);
+  n_thread_allocations++;
+  return __libc_realloc(ptr, size);
+}
+
+gboolean kuro_alloc_counter_is_supported(void) { return TRUE; }
+
+#else
+
+gboolean kuro_alloc_counter_is_supported(void) { return FALSE; }
+
+#endif /* __GLIBC__ */
+
+void kuro_alloc_counter_reset(void) {
+  __atomic_store_n(&n_allocations, 0, __ATOMIC_RELAXED);
+  n_thread_allocations = 0;
+}
+
+guint64 kuro_alloc_counter_get(void) {
+  return __atomic_load_n(&n_allocations, __ATOMIC_RELAXED);
+}
+
+/* Only those made by the calling thread since it last reset the count */
+guint64 kuro_alloc_counter_get_thread(void) { return n_thread_allocations; }
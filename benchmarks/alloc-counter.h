@@ -0,0 +1,38 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef KURO_ALLOC_COUNTER_H
+#define KURO_ALLOC_COUNTER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Counts heap allocations made by anything in the process, GLib included,
+ * by replacing malloc() and friends. Only glibc is supported; elsewhere the
+ * count stays at zero. */
+gboolean kuro_alloc_counter_is_supported(void);
+void kuro_alloc_counter_reset(void);
+guint64 kuro_alloc_counter_get(void);
+guint64 kuro_alloc_counter_get_thread(void);
+
+G_END_DECLS
+
+#endif /* KURO_ALLOC_COUNTER_H */
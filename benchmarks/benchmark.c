@@ -0,0 +1,679 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+
+#define G_SETTINGS_ENABLE_BACKEND
+
+#include <cairo.h>
+#include <gio/gio.h>
+#include <gio/gsettingsbackend.h>
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc-counter.h"
+#include "board.h"
+#include "book.h"
+#include "count.h"
+#include "generator.h"
+#include "hint.h"
+#include "rules.h"
+#include "score.h"
+#include "search.h"
+#include "undo.h"
+
+/* Every run uses the same boards, so the numbers can be compared */
+#define BASE_SEED 20260101u
+#define GENERATION_SAMPLES 100
+#define UNDO_DEPTH 256
+#define RENDER_SIZE 600
+
+static const guint generate_sizes[] = {5, 6, 7, 8, 9, 10, 15, 20, 30};
+static const guint check_sizes[] = {8, 15, 30};
+static const guint hint_sizes[] = {8, 10, 15};
+static const guint count_sizes[] = {8, 10};
+static const guint sat_sizes[] = {10, 20, 30};
+
+typedef void (*BenchFunc)(gpointer data, guint64 iteration);
+
+typedef struct {
+  gchar *benchmark;
+  gchar *metric;
+  gdouble value;
+} Result;
+
+static gdouble min_time = 0.2;
+static gchar *filter = NULL;
+static gchar *output_path = NULL;
+static gchar *baseline_path = NULL;
+static gdouble max_regression = 0.0;
+
+static const GOptionEntry options[] = {
+    {"filter", 'f', 0, G_OPTION_ARG_STRING, &filter,
+     "Only run benchmarks whose names start with FILTER", "FILTER"},
+    {"min-time", 't', 0, G_OPTION_ARG_DOUBLE, &min_time,
+     "Time each benchmark for at least SECONDS", "SECONDS"},
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output_path,
+     "Also write the results to FILE, for use as a baseline", "FILE"},
+    {"baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline_path,
+     "Compare the results with a baseline written by --output", "FILE"},
+    {"max-regression", 0, 0, G_OPTION_ARG_DOUBLE, &max_regression,
+     "Fail if anything's more than PERCENT slower than the baseline, or "
+     "allocates more",
+     "PERCENT"},
+    {NULL}};
+
+static GArray *results; /* of Result */
+
+/* Results are printed as CSV, one metric to a line */
+static void add_result(const gchar *benchmark, const gchar *metric,
+                       gdouble value) {
+  Result result = {g_strdup(benchmark), g_strdup(metric), value};
+
+  g_array_append_val(results, result);
+  g_print("%s,%s,%.3f\n", benchmark, metric, value);
+}
+
+static gboolean is_selected(const gchar *benchmark) {
+  return filter == NULL || g_str_has_prefix(benchmark, filter);
+}
+
+/* Whether any benchmark in @group, such as "undo/", might be selected */
+static gboolean is_group_selected(const gchar *group) {
+  return is_selected(group) || g_str_has_prefix(filter, group);
+}
+
+/* Run @func for twice as many iterations each time until they take at least
+ * min_time, and report the time and allocations per iteration of the last
+ * round. Iterations are numbered from 0 in every round, so each round does
+ * the same work as the last one plus as much again. */
+static void measure(const gchar *benchmark, BenchFunc func, gpointer data) {
+  guint64 n_iterations = 1, n_allocations, i;
+  gint64 start, elapsed;
+
+  /* Warm up */
+  func(data, 0);
+
+  for (;;) {
+    kuro_alloc_counter_reset();
+    start = g_get_monotonic_time();
+
+    for (i = 0; i < n_iterations; i++)
+      func(data, i);
+
+    elapsed = g_get_monotonic_time() - start;
+    n_allocations = kuro_alloc_counter_get();
+
+    if (elapsed >= min_time * G_USEC_PER_SEC || n_iterations >= G_MAXUINT32)
+      break;
+
+    n_iterations *= 2;
+  }
+
+  add_result(benchmark, "ns_per_op", elapsed * 1000.0 / n_iterations);
+  if (kuro_alloc_counter_is_supported())
+    add_result(benchmark, "allocs_per_op",
+               (gdouble)n_allocations / n_iterations);
+}
+
+static gint compare_uint(gconstpointer a, gconstpointer b) {
+  guint value_a = *(const guint *)a;
+  guint value_b = *(const guint *)b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void generate_func(gpointer data, guint64 iteration) {
+  const guint *size = data;
+  guint seed = kuro_generator_derive_seed(BASE_SEED, (guint)iteration);
+
+  kuro_board_free(kuro_generator_new_board(*size, seed, FALSE));
+}
+
+static void generate_speculative_func(gpointer data, guint64 iteration) {
+  const guint *size = data;
+  guint seed = kuro_generator_derive_seed(BASE_SEED, (guint)iteration);
+
+  kuro_board_free(kuro_generator_new_board_speculative(*size, seed, 0, FALSE));
+}
+
+/* The generator tries successive seeds until one works, so the number of
+ * attempts a board took is how far its seed moved on */
+static void report_attempts(const gchar *benchmark, guint size) {
+  guint attempts[GENERATION_SAMPLES];
+  guint64 total = 0;
+  guint i;
+
+  for (i = 0; i < GENERATION_SAMPLES; i++) {
+    guint seed = kuro_generator_derive_seed(BASE_SEED, i);
+    KuroBoard *board = kuro_generator_new_board(size, seed, FALSE);
+
+    attempts[i] = board->seed - seed + 1;
+    total += attempts[i];
+    kuro_board_free(board);
+  }
+
+  qsort(attempts, GENERATION_SAMPLES, sizeof(guint), compare_uint);
+
+  add_result(benchmark, "attempts_mean", (gdouble)total / GENERATION_SAMPLES);
+  add_result(benchmark, "attempts_p50", attempts[GENERATION_SAMPLES / 2]);
+  add_result(benchmark, "attempts_p90", attempts[GENERATION_SAMPLES * 9 / 10]);
+  add_result(benchmark, "attempts_max", attempts[GENERATION_SAMPLES - 1]);
+}
+
+static void bench_generate(void) {
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(generate_sizes); i++) {
+    gchar *benchmark = g_strdup_printf("generate/%ux%u", generate_sizes[i],
+                                       generate_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      measure(benchmark, generate_func, (gpointer)&generate_sizes[i]);
+      report_attempts(benchmark, generate_sizes[i]);
+    }
+
+    g_free(benchmark);
+
+    /* The same boards, with the attempts shared out between processors */
+    benchmark = g_strdup_printf("generate/speculative/%ux%u",
+                                generate_sizes[i], generate_sizes[i]);
+
+    if (is_selected(benchmark))
+      measure(benchmark, generate_speculative_func,
+              (gpointer)&generate_sizes[i]);
+
+    g_free(benchmark);
+  }
+}
+
+/* A board painted in as its solution, so every check runs to the end */
+static KuroBoard *new_solved_board(guint size) {
+  KuroBoard *board = kuro_generator_new_board(size, BASE_SEED, FALSE);
+  KuroVector iter;
+
+  for (iter.x = 0; iter.x < size; iter.x++) {
+    for (iter.y = 0; iter.y < size; iter.y++) {
+      if (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED)
+        board->cells[iter.x][iter.y].status |= CELL_PAINTED;
+    }
+  }
+
+  return board;
+}
+
+static void rule1_func(gpointer data, guint64 iteration) {
+  kuro_check_rule1(data);
+}
+
+static void rule2_func(gpointer data, guint64 iteration) {
+  kuro_check_rule2(data);
+}
+
+static void rule3_func(gpointer data, guint64 iteration) {
+  kuro_check_rule3(data);
+}
+
+static void win_func(gpointer data, guint64 iteration) {
+  kuro_check_board(data);
+}
+
+static void hint_func(gpointer data, guint64 iteration) {
+  KuroHint hint;
+
+  kuro_hint_find(data, &hint);
+}
+
+/* The first hint on a fresh board, which has the most left to work out */
+static void bench_hints(void) {
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(hint_sizes); i++) {
+    gchar *benchmark =
+        g_strdup_printf("hint/%ux%u", hint_sizes[i], hint_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      KuroBoard *board =
+          kuro_generator_new_board(hint_sizes[i], BASE_SEED, FALSE);
+
+      measure(benchmark, hint_func, board);
+      kuro_board_free(board);
+    }
+
+    g_free(benchmark);
+  }
+}
+
+static void count_func(gpointer data, guint64 iteration) {
+  guint64 n_solutions;
+
+  kuro_count_solutions(data, G_MAXUINT64, &n_solutions);
+}
+
+static void sat_func(gpointer data, guint64 iteration) {
+  guint64 n_solutions;
+
+  kuro_count_solutions_sat(data, 2, 0, &n_solutions);
+}
+
+static void search_func(gpointer data) {
+  guint64 n_solutions;
+
+  kuro_search_count_solutions(data, 2, 0, 0, &n_solutions);
+}
+
+/* Counting every solution, as the uniqueness check does on narrow boards, and
+ * looking for a second one with the SAT solver, as it does on wide ones, or
+ * with the parallel search it falls back to */
+static void bench_count(void) {
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(count_sizes); i++) {
+    gchar *benchmark =
+        g_strdup_printf("count/%ux%u", count_sizes[i], count_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      KuroBoard *board =
+          kuro_generator_new_board(count_sizes[i], BASE_SEED, FALSE);
+
+      measure(benchmark, count_func, board);
+      kuro_board_free(board);
+    }
+
+    g_free(benchmark);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS(sat_sizes); i++) {
+    gchar *benchmark =
+        g_strdup_printf("count/sat/%ux%u", sat_sizes[i], sat_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      KuroBoard *board =
+          kuro_generator_new_board(sat_sizes[i], BASE_SEED, FALSE);
+
+      measure(benchmark, sat_func, board);
+      kuro_board_free(board);
+    }
+
+    g_free(benchmark);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS(sat_sizes); i++) {
+    gchar *benchmark =
+        g_strdup_printf("count/search/%ux%u", sat_sizes[i], sat_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      KuroBoard *board =
+          kuro_generator_new_board(sat_sizes[i], BASE_SEED, FALSE);
+
+      measure(benchmark, search_func, board);
+      kuro_board_free(board);
+    }
+
+    g_free(benchmark);
+  }
+}
+
+static void bench_checks(void) {
+  static const struct {
+    const gchar *name;
+    BenchFunc func;
+  } checks[] = {
+      {"rules/rule1", rule1_func},
+      {"rules/rule2", rule2_func},
+      {"rules/rule3", rule3_func},
+      {"win", win_func},
+  };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS(check_sizes); i++) {
+    KuroBoard *board = NULL;
+
+    for (j = 0; j < G_N_ELEMENTS(checks); j++) {
+      gchar *benchmark = g_strdup_printf("%s/%ux%u", checks[j].name,
+                                         check_sizes[i], check_sizes[i]);
+
+      if (is_selected(benchmark)) {
+        if (board == NULL)
+          board = new_solved_board(check_sizes[i]);
+        measure(benchmark, checks[j].func, board);
+      }
+
+      g_free(benchmark);
+    }
+
+    if (board != NULL)
+      kuro_board_free(board);
+  }
+}
+
+typedef struct {
+  KuroBoard *board;
+  KuroUndoStack *stack;
+  guint n_moves;
+  gboolean redoing;
+} UndoData;
+
+static void push_move(UndoData *data, guint64 move) {
+  KuroVector cell;
+
+  cell.x = (guint16)(move % data->board->size);
+  cell.y = (guint16)((move / data->board->size) % data->board->size);
+
+  kuro_undo_push(data->stack, UNDO_PAINT, cell);
+  kuro_undo_apply(data->stack->current, data->board);
+}
+
+static void undo_push_func(gpointer user_data, guint64 iteration) {
+  UndoData *data = user_data;
+
+  push_move(data, iteration);
+
+  /* Start a new game now and then, as a player would */
+  if (++data->n_moves == UNDO_DEPTH) {
+    kuro_undo_clear(data->stack);
+    data->n_moves = 0;
+  }
+}
+
+/* Undo all the way back, then redo all the way forward, a step at a time */
+static void undo_step_func(gpointer user_data, guint64 iteration) {
+  UndoData *data = user_data;
+  KuroUndoStack *stack = data->stack;
+
+  if (!data->redoing && stack->current->type == UNDO_NEW_GAME)
+    data->redoing = TRUE;
+  else if (data->redoing && stack->current->redo == NULL)
+    data->redoing = FALSE;
+
+  if (data->redoing) {
+    stack->current = stack->current->redo;
+    kuro_undo_apply(stack->current, data->board);
+  } else {
+    kuro_undo_apply(stack->current, data->board);
+    stack->current = stack->current->undo;
+  }
+}
+
+static void bench_undo(void) {
+  UndoData data = {NULL};
+  guint i;
+
+  if (!is_group_selected("undo/"))
+    return;
+
+  data.board = kuro_generator_new_board(8, BASE_SEED, FALSE);
+  data.stack = kuro_undo_stack_new();
+
+  if (is_selected("undo/push"))
+    measure("undo/push", undo_push_func, &data);
+
+  kuro_undo_clear(data.stack);
+  for (i = 0; i < UNDO_DEPTH; i++)
+    push_move(&data, i);
+
+  if (is_selected("undo/step"))
+    measure("undo/step", undo_step_func, &data);
+
+  kuro_undo_stack_free(data.stack);
+  kuro_board_free(data.board);
+}
+
+static guint score_time(guint64 iteration) {
+  return kuro_generator_derive_seed(BASE_SEED, (guint)iteration) % 600000;
+}
+
+static void score_add_func(gpointer data, guint64 iteration) {
+  guint size = generate_sizes[iteration % G_N_ELEMENTS(generate_sizes)];
+
+  kuro_score_add(data, size, "Benchmark", score_time(iteration));
+}
+
+static void score_query_func(gpointer data, guint64 iteration) {
+  guint size = generate_sizes[iteration % G_N_ELEMENTS(generate_sizes)];
+
+  kuro_score_is_high_score(data, size, score_time(iteration));
+}
+
+static void bench_scores(void) {
+  GSettingsSchema *schema;
+  GSettingsBackend *backend;
+  GSettings *settings;
+  KuroScoreStore *store;
+
+  if (!is_group_selected("scores/"))
+    return;
+
+  /* The store needs the real schema, but mustn't touch the real scores */
+  schema = g_settings_schema_source_lookup(
+      g_settings_schema_source_get_default(), APPLICATION_ID, TRUE);
+  if (schema == NULL) {
+    g_printerr("Skipping scores: the %s schema isn’t installed; set "
+               "GSETTINGS_SCHEMA_DIR\n",
+               APPLICATION_ID);
+    return;
+  }
+
+  backend = g_memory_settings_backend_new();
+  settings = g_settings_new_full(schema, backend, NULL);
+  store = kuro_score_store_new(settings);
+
+  if (is_selected("scores/add"))
+    measure("scores/add", score_add_func, store);
+  if (is_selected("scores/is-high-score"))
+    measure("scores/is-high-score", score_query_func, store);
+
+  kuro_score_store_free(store);
+  g_object_unref(settings);
+  g_object_unref(backend);
+  g_settings_schema_unref(schema);
+}
+
+typedef struct {
+  cairo_t *cr;
+  KuroBoard *board;
+} RenderData;
+
+static void render_func(gpointer user_data, guint64 iteration) {
+  RenderData *data = user_data;
+
+  kuro_book_draw_board(data->cr, data->board, TRUE, "Benchmark", 0.0, 0.0,
+                       RENDER_SIZE, RENDER_SIZE);
+}
+
+static void bench_render(void) {
+  cairo_surface_t *surface;
+  RenderData data;
+  guint i;
+
+  if (!is_group_selected("render/"))
+    return;
+
+  surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, RENDER_SIZE, RENDER_SIZE);
+  data.cr = cairo_create(surface);
+
+  for (i = 0; i < G_N_ELEMENTS(check_sizes); i++) {
+    gchar *benchmark = g_strdup_printf("render/%ux%u", check_sizes[i],
+                                       check_sizes[i]);
+
+    if (is_selected(benchmark)) {
+      data.board = new_solved_board(check_sizes[i]);
+      measure(benchmark, render_func, &data);
+      kuro_board_free(data.board);
+    }
+
+    g_free(benchmark);
+  }
+
+  cairo_destroy(data.cr);
+  cairo_surface_destroy(surface);
+}
+
+static gboolean write_results(const gchar *path, GError **error) {
+  GString *csv = g_string_new("benchmark,metric,value\n");
+  gboolean success;
+  guint i;
+
+  for (i = 0; i < results->len; i++) {
+    const Result *result = &g_array_index(results, Result, i);
+    g_string_append_printf(csv, "%s,%s,%.3f\n", result->benchmark,
+                           result->metric, result->value);
+  }
+
+  success = g_file_set_contents(path, csv->str, csv->len, error);
+  g_string_free(csv, TRUE);
+
+  return success;
+}
+
+/* Returns "benchmark,metric" → value */
+static GHashTable *load_baseline(const gchar *path, GError **error) {
+  GHashTable *baseline;
+  gchar *contents, **lines;
+  guint i;
+
+  if (!g_file_get_contents(path, &contents, NULL, error))
+    return NULL;
+
+  baseline = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  lines = g_strsplit(contents, "\n", -1);
+
+  for (i = 0; lines[i] != NULL; i++) {
+    gchar *comma = strrchr(lines[i], ',');
+    gdouble *value;
+
+    if (comma == NULL || g_str_has_prefix(lines[i], "benchmark,"))
+      continue;
+
+    value = g_new(gdouble, 1);
+    *value = g_ascii_strtod(comma + 1, NULL);
+    g_hash_table_insert(baseline, g_strndup(lines[i], comma - lines[i]),
+                        value);
+  }
+
+  g_strfreev(lines);
+  g_free(contents);
+
+  return baseline;
+}
+
+/* Print how each time and allocation count has changed. Returns FALSE if any
+ * got worse by more than max_regression. */
+static gboolean compare_results(GHashTable *baseline) {
+  gboolean success = TRUE;
+  guint i;
+
+  for (i = 0; i < results->len; i++) {
+    const Result *result = &g_array_index(results, Result, i);
+    gchar *key;
+    const gdouble *old;
+    gboolean regressed;
+
+    if (g_strcmp0(result->metric, "ns_per_op") != 0 &&
+        g_strcmp0(result->metric, "allocs_per_op") != 0)
+      continue;
+
+    key = g_strconcat(result->benchmark, ",", result->metric, NULL);
+    old = g_hash_table_lookup(baseline, key);
+    g_free(key);
+
+    if (old == NULL)
+      continue;
+
+    regressed = max_regression > 0.0 && result->value > *old &&
+                result->value > *old * (1.0 + max_regression / 100.0);
+
+    if (*old > 0.0)
+      g_printerr("%-24s %-14s %12.3f → %12.3f  %+7.1f%%%s\n",
+                 result->benchmark, result->metric, *old, result->value,
+                 (result->value - *old) * 100.0 / *old,
+                 regressed ? "  REGRESSED" : "");
+    else
+      g_printerr("%-24s %-14s %12.3f → %12.3f%s\n", result->benchmark,
+                 result->metric, *old, result->value,
+                 regressed ? "  REGRESSED" : "");
+
+    if (regressed)
+      success = FALSE;
+  }
+
+  return success;
+}
+
+int main(int argc, char *argv[]) {
+  GOptionContext *context;
+  GError *error = NULL;
+  gboolean success = TRUE;
+  guint i;
+
+  context = g_option_context_new("- benchmark Kuro’s hot paths");
+  g_option_context_add_main_entries(context, options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("%s\n", error->message);
+    g_error_free(error);
+    g_option_context_free(context);
+    return EXIT_FAILURE;
+  }
+  g_option_context_free(context);
+
+  if (!kuro_alloc_counter_is_supported())
+    g_printerr("Allocations can’t be counted on this platform\n");
+
+  results = g_array_new(FALSE, FALSE, sizeof(Result));
+  g_print("benchmark,metric,value\n");
+
+  bench_generate();
+  bench_checks();
+  bench_hints();
+  bench_count();
+  bench_undo();
+  bench_scores();
+  bench_render();
+
+  if (output_path != NULL && !write_results(output_path, &error)) {
+    g_printerr("Couldn’t write results: %s\n", error->message);
+    g_clear_error(&error);
+    success = FALSE;
+  }
+
+  if (baseline_path != NULL) {
+    GHashTable *baseline = load_baseline(baseline_path, &error);
+
+    if (baseline == NULL) {
+      g_printerr("Couldn’t read baseline: %s\n", error->message);
+      g_clear_error(&error);
+      success = FALSE;
+    } else {
+      success = compare_results(baseline) && success;
+      g_hash_table_unref(baseline);
+    }
+  }
+
+  for (i = 0; i < results->len; i++) {
+    Result *result = &g_array_index(results, Result, i);
+    g_free(result->benchmark);
+    g_free(result->metric);
+  }
+  g_array_unref(results);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
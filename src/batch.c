@@ -0,0 +1,255 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "batch.h"
+#include "board.h"
+#include "count.h"
+#include "format.h"
+#include "hint.h"
+#include "rules.h"
+#include "search.h"
+
+/* Solutions are only counted this far, which is enough to tell a proper
+ * puzzle from one with several answers */
+#define SOLUTION_LIMIT 2
+
+/* Conflicts the SAT solver's allowed on each puzzle before it's searched
+ * instead, unless the options say otherwise */
+#define SOLVE_MAX_CONFLICTS 100000
+
+/* Puzzles are solved by a pool of worker threads and written out in the order
+ * they were read, through a ring of slots, so only a window's worth of boards
+ * is ever alive at once, however long the input is. */
+typedef struct {
+  KuroBoard *board;
+  guint puzzle;
+  guint line; /* where the puzzle started */
+  guint64 n_solutions;
+  KuroHintTechnique rating; /* the hardest technique needed to solve it */
+  guint n_hints;
+  gint64 time;
+  gboolean ready;
+} BatchItem;
+
+typedef struct {
+  KuroBatchOptions options;
+  KuroFormatReader *reader;
+  guint n_read;
+  gboolean at_end;
+
+  guint window;
+  BatchItem *items;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+} BatchJob;
+
+/* Solve the puzzle the way the hints would, painting one hinted cell at a
+ * time, and note the hardest technique it took */
+static void rate_item(BatchItem *item) {
+  KuroBoard *board = item->board;
+  KuroHint hint;
+
+  item->rating = KURO_HINT_NONE;
+  item->n_hints = 0;
+
+  while (!kuro_check_board(board) && item->n_hints < board->size * board->size &&
+         kuro_hint_find(board, &hint)) {
+    kuro_board_toggle(board, hint.cell, CELL_PAINTED);
+    item->rating = MAX(item->rating, hint.technique);
+    item->n_hints++;
+  }
+}
+
+static void solve_item_cb(gpointer data, gpointer user_data) {
+  BatchJob *job = user_data;
+  BatchItem *item = &job->items[(GPOINTER_TO_UINT(data) - 1) % job->window];
+  guint64 max_conflicts = (job->options.max_conflicts != 0)
+                              ? job->options.max_conflicts
+                              : SOLVE_MAX_CONFLICTS;
+  gint64 start = g_get_monotonic_time();
+
+  /* A puzzle the SAT solver gets stuck on holds up every puzzle written
+   * after it, so the search it's handed over to gets every processor */
+  if (!kuro_count_solve(item->board, SOLUTION_LIMIT, max_conflicts,
+                        &item->n_solutions))
+    kuro_search_solve(item->board, SOLUTION_LIMIT, 0, 0, &item->n_solutions);
+  if (item->n_solutions == 1)
+    rate_item(item);
+  item->time = g_get_monotonic_time() - start;
+
+  g_mutex_lock(&job->lock);
+  item->ready = TRUE;
+  g_cond_broadcast(&job->cond);
+  g_mutex_unlock(&job->lock);
+}
+
+/* Read the next puzzle into its slot and queue it up for solving */
+static gboolean queue_item(BatchJob *job, GError **error) {
+  BatchItem *item = &job->items[job->n_read % job->window];
+  KuroBoard *board;
+
+  if (!kuro_format_read(job->reader, &board, error))
+    return FALSE;
+
+  if (board == NULL) {
+    job->at_end = TRUE;
+    return TRUE;
+  }
+
+  memset(item, 0, sizeof(BatchItem));
+  item->board = board;
+  item->puzzle = ++job->n_read;
+  item->line = job->reader->puzzle_line;
+  g_thread_pool_push(job->pool, GUINT_TO_POINTER(item->puzzle), NULL);
+
+  return TRUE;
+}
+
+static BatchItem *take_item(BatchJob *job, guint puzzle) {
+  BatchItem *item = &job->items[(puzzle - 1) % job->window];
+
+  g_mutex_lock(&job->lock);
+  while (item->ready == FALSE)
+    g_cond_wait(&job->cond, &job->lock);
+  g_mutex_unlock(&job->lock);
+
+  return item;
+}
+
+static gboolean write_item(BatchJob *job, const BatchItem *item,
+                           GOutputStream *output, GError **error) {
+  const gchar *rating = (item->n_solutions == 1)
+                            ? kuro_hint_technique_name(item->rating)
+                            : NULL;
+  GString *text = g_string_new(NULL);
+  gboolean success;
+
+  if (job->options.format == KURO_BATCH_JSON) {
+    g_string_append_printf(
+        text,
+        "{\"puzzle\":%u,\"line\":%u,\"size\":%u,\"solutions\":%" G_GUINT64_FORMAT
+        ",",
+        item->puzzle, item->line, item->board->size, item->n_solutions);
+    if (rating != NULL)
+      g_string_append_printf(text, "\"rating\":\"%s\",\"hints\":%u,", rating,
+                             item->n_hints);
+    else
+      g_string_append(text, "\"rating\":null,\"hints\":null,");
+    g_string_append_printf(text, "\"time_us\":%" G_GINT64_FORMAT "}\n",
+                           item->time);
+  } else {
+    g_string_append_printf(text, "%u,%u,%u,%" G_GUINT64_FORMAT ",",
+                           item->puzzle, item->line, item->board->size,
+                           item->n_solutions);
+    if (rating != NULL)
+      g_string_append_printf(text, "%s,%u,", rating, item->n_hints);
+    else
+      g_string_append(text, ",,");
+    g_string_append_printf(text, "%" G_GINT64_FORMAT "\n", item->time);
+  }
+
+  success = g_output_stream_write_all(output, text->str, text->len, NULL,
+                                      NULL, error);
+  g_string_free(text, TRUE);
+
+  return success;
+}
+
+static void count_item(const BatchItem *item, KuroBatchStats *stats) {
+  stats->n_puzzles++;
+  stats->solve_time += item->time;
+
+  if (item->n_solutions == 0)
+    stats->n_unsolvable++;
+  else if (item->n_solutions == 1)
+    stats->n_unique++;
+  else
+    stats->n_multiple++;
+}
+
+/* Read the puzzles @reader has left, in any of the formats kuro_format_read()
+ * understands, solve them on a pool of threads, and write a line to @output
+ * for each, in the order they were read: how many solutions it has (counting
+ * stops at 2), and for proper puzzles the hardest hint technique solving it
+ * took and how many hints that was, along with how long it took to solve.
+ * Stops at the first puzzle which can't be read. */
+gboolean kuro_batch_run(KuroFormatReader *reader, GOutputStream *output,
+                        const KuroBatchOptions *options, KuroBatchStats *stats,
+                        GError **error) {
+  static const gchar csv_header[] = "puzzle,line,size,solutions,rating,hints,"
+                                    "time_us\n";
+  BatchJob job;
+  gboolean success = TRUE;
+  guint n_threads, n_written = 0, i;
+  gint64 start = g_get_monotonic_time();
+
+  g_return_val_if_fail(reader != NULL, FALSE);
+  g_return_val_if_fail(G_IS_OUTPUT_STREAM(output), FALSE);
+  g_return_val_if_fail(options != NULL, FALSE);
+  g_return_val_if_fail(stats != NULL, FALSE);
+
+  memset(stats, 0, sizeof(KuroBatchStats));
+  memset(&job, 0, sizeof(BatchJob));
+  job.options = *options;
+  job.reader = reader;
+  g_mutex_init(&job.lock);
+  g_cond_init(&job.cond);
+
+  /* Enough puzzles in flight to keep every thread busy while one is written */
+  n_threads = (options->n_threads > 0) ? options->n_threads
+                                       : g_get_num_processors();
+  job.window = 4 * n_threads;
+  job.items = g_new0(BatchItem, job.window);
+  job.pool = g_thread_pool_new(solve_item_cb, &job, n_threads, FALSE, NULL);
+
+  if (options->format == KURO_BATCH_CSV)
+    success = g_output_stream_write_all(output, csv_header,
+                                        strlen(csv_header), NULL, NULL, error);
+
+  while (success && !job.at_end && job.n_read < job.window)
+    success = queue_item(&job, error);
+
+  while (success && n_written < job.n_read) {
+    BatchItem *item = take_item(&job, n_written + 1);
+
+    success = write_item(&job, item, output, error);
+    if (success)
+      count_item(item, stats);
+    g_clear_pointer(&item->board, kuro_board_free);
+    n_written++;
+
+    if (success && !job.at_end)
+      success = queue_item(&job, error);
+  }
+
+  /* Let anything still in flight finish before its slot goes */
+  g_thread_pool_free(job.pool, FALSE, TRUE);
+  for (i = 0; i < job.window; i++)
+    g_clear_pointer(&job.items[i].board, kuro_board_free);
+  g_free(job.items);
+  g_mutex_clear(&job.lock);
+  g_cond_clear(&job.cond);
+
+  stats->elapsed = g_get_monotonic_time() - start;
+
+  return success;
+}
@@ -0,0 +1,54 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_BATCH_H
+#define KURO_BATCH_H
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "format.h"
+
+G_BEGIN_DECLS
+
+typedef enum { KURO_BATCH_CSV, KURO_BATCH_JSON } KuroBatchFormat;
+
+typedef struct {
+  KuroBatchFormat format;
+  guint n_threads; /* 0 for one per processor */
+  guint64 max_conflicts; /* SAT conflicts on a puzzle before searching instead,
+                          * 0 for the default */
+} KuroBatchOptions;
+
+typedef struct {
+  guint64 n_puzzles;
+  guint64 n_unsolvable;
+  guint64 n_unique;
+  guint64 n_multiple;
+  gint64 elapsed;    /* µs from the first puzzle read to the last written */
+  gint64 solve_time; /* µs spent solving, summed over every puzzle */
+} KuroBatchStats;
+
+gboolean kuro_batch_run(KuroFormatReader *reader, GOutputStream *output,
+                        const KuroBatchOptions *options, KuroBatchStats *stats,
+                        GError **error);
+
+G_END_DECLS
+
+#endif /* KURO_BATCH_H */
@@ -0,0 +1,151 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "board.h"
+
+KuroBoard *kuro_board_new(guint size) {
+  KuroBoard *board;
+  guint i;
+
+  g_return_val_if_fail(size > 0, NULL);
+
+  board = g_new0(KuroBoard, 1);
+  board->size = size;
+
+  board->cells = g_new(KuroCell *, size);
+  for (i = 0; i < size; i++)
+    board->cells[i] = g_slice_alloc0(sizeof(KuroCell) * size);
+
+  board->workspace.seen = g_new0(gboolean, size + 1);
+  board->workspace.reached = g_new0(gboolean, size * size);
+  board->workspace.stack = g_new(KuroVector, size * size);
+
+  return board;
+}
+
+/* A copy of the numbers and cell states, for working on in another thread */
+KuroBoard *kuro_board_copy(const KuroBoard *board) {
+  KuroBoard *copy = kuro_board_new(board->size);
+
+  kuro_board_copy_into(copy, board);
+
+  return copy;
+}
+
+/* Copy @board over @dest, which must be the same size, without allocating */
+void kuro_board_copy_into(KuroBoard *dest, const KuroBoard *board) {
+  guint i;
+
+  g_return_if_fail(dest->size == board->size);
+
+  dest->seed = board->seed;
+  dest->debug = board->debug;
+  dest->numbers_hash = board->numbers_hash;
+  dest->marks_hash = board->marks_hash;
+  for (i = 0; i < board->size; i++)
+    memcpy(dest->cells[i], board->cells[i], sizeof(KuroCell) * board->size);
+}
+
+void kuro_board_clear(KuroBoard *board) {
+  guint i;
+
+  for (i = 0; i < board->size; i++)
+    memset(board->cells[i], 0, sizeof(KuroCell) * board->size);
+
+  board->numbers_hash = board->marks_hash = 0;
+}
+
+void kuro_board_free(KuroBoard *board) {
+  guint i;
+
+  if (board == NULL)
+    return;
+
+  for (i = 0; i < board->size; i++)
+    g_slice_free1(sizeof(KuroCell) * board->size, board->cells[i]);
+  g_free(board->cells);
+
+  g_free(board->workspace.seen);
+  g_free(board->workspace.reached);
+  g_free(board->workspace.stack);
+  g_free(board);
+}
+
+/* Zobrist keys are derived from what they stand for (splitmix64) rather than
+ * kept in a table, so boards of any size are covered */
+static guint64 zobrist_key(guint64 value) {
+  guint64 z = value + G_GUINT64_CONSTANT(0x9e3779b97f4a7c15);
+
+  z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT(0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
+static guint64 number_key(const KuroBoard *board, guint x, guint y, guint num) {
+  return zobrist_key((guint64)(x * board->size + y) << 16 | num);
+}
+
+/* The key for some of CELL_MARKS on a cell */
+static guint64 marks_key(const KuroBoard *board, guint x, guint y,
+                         guchar marks) {
+  guint64 cell = (guint64)(x * board->size + y) << 16, key = 0;
+
+  if (marks & CELL_PAINTED)
+    key ^= zobrist_key(cell | 0x1000 | CELL_PAINTED);
+  if (marks & CELL_TAG1)
+    key ^= zobrist_key(cell | 0x1000 | CELL_TAG1);
+  if (marks & CELL_TAG2)
+    key ^= zobrist_key(cell | 0x1000 | CELL_TAG2);
+
+  return key;
+}
+
+/* Flip some of CELL_MARKS on @cell, updating the hash as it goes */
+void kuro_board_toggle(KuroBoard *board, KuroVector cell, guchar marks) {
+  g_return_if_fail((marks & ~CELL_MARKS) == 0);
+
+  board->cells[cell.x][cell.y].status ^= marks;
+  board->marks_hash ^= marks_key(board, cell.x, cell.y, marks);
+}
+
+/* Hash the board from scratch, once its numbers are filled in or its cells
+ * have been changed directly */
+void kuro_board_rehash(KuroBoard *board) {
+  guint x, y;
+
+  board->numbers_hash = zobrist_key((guint64)board->size << 48);
+  board->marks_hash = 0;
+
+  for (x = 0; x < board->size; x++) {
+    for (y = 0; y < board->size; y++) {
+      const KuroCell *cell = &board->cells[x][y];
+
+      board->numbers_hash ^= number_key(board, x, y, cell->num);
+      board->marks_hash ^= marks_key(board, x, y, cell->status & CELL_MARKS);
+    }
+  }
+}
+
+/* Tells positions apart by the puzzle and the player's marks on it */
+guint64 kuro_board_hash(const KuroBoard *board) {
+  return board->numbers_hash ^ board->marks_hash;
+}
@@ -0,0 +1,85 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_BOARD_H
+#define KURO_BOARD_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define DEFAULT_BOARD_SIZE 5
+#define MAX_BOARD_SIZE 255
+
+typedef struct {
+  guint16 x;
+  guint16 y;
+} KuroVector;
+
+typedef enum {
+  CELL_PAINTED = 1 << 1,
+  CELL_SHOULD_BE_PAINTED = 1 << 2,
+  CELL_TAG1 = 1 << 3,
+  CELL_TAG2 = 1 << 4,
+  CELL_ERROR = 1 << 5
+} KuroCellStatus;
+
+/* The player's marks on a cell, which make up the position */
+#define CELL_MARKS (CELL_PAINTED | CELL_TAG1 | CELL_TAG2)
+
+typedef struct {
+  guint16 num; /* boards use the numbers 1 to size + 1 */
+  guchar status;
+} KuroCell;
+
+/* Scratch space for checking the rules, allocated along with the board so
+ * that checking a move doesn't allocate */
+typedef struct {
+  gboolean *seen;     /* one flag per number */
+  gboolean *reached;  /* one flag per cell, indexed as [x * size + y] */
+  KuroVector *stack;  /* flood fill frontier, which never holds a cell twice */
+} KuroBoardWorkspace;
+
+/* A board on its own, with no UI attached, so that it can be generated and
+ * checked from any thread. Cells are indexed as cells[x][y]. */
+typedef struct {
+  guint size;
+  guint seed; /* seed the board was generated from */
+  gboolean debug;
+  KuroCell **cells;
+  KuroBoardWorkspace workspace;
+
+  /* Zobrist hashes, kept up to date by kuro_board_toggle() */
+  guint64 numbers_hash; /* the puzzle */
+  guint64 marks_hash;   /* the painted and tagged cells */
+} KuroBoard;
+
+KuroBoard *kuro_board_new(guint size) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+KuroBoard *kuro_board_copy(const KuroBoard *board) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_MALLOC;
+void kuro_board_copy_into(KuroBoard *dest, const KuroBoard *board);
+void kuro_board_clear(KuroBoard *board);
+void kuro_board_toggle(KuroBoard *board, KuroVector cell, guchar marks);
+void kuro_board_rehash(KuroBoard *board);
+guint64 kuro_board_hash(const KuroBoard *board);
+void kuro_board_free(KuroBoard *board);
+
+G_END_DECLS
+
+#endif /* KURO_BOARD_H */
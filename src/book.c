@@ -0,0 +1,357 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <pango/pangocairo.h>
+
+#include "config.h"
+#include "board.h"
+#include "book.h"
+#include "generator.h"
+
+/* A4, in points */
+#define PAGE_WIDTH 595.0
+#define PAGE_HEIGHT 842.0
+#define PAGE_MARGIN 36.0
+#define BOX_SPACING 24.0
+#define CAPTION_HEIGHT 20.0
+#define NUMBER_SCALE 0.55
+
+/* The book is a stream of items: every puzzle, followed by every solution if
+ * they've been asked for. Items are generated by a pool of worker threads and
+ * handed to the writer through a small ring of slots, so only a window's worth
+ * of boards is ever alive at once, however long the book is. */
+typedef struct {
+  KuroBookOptions options;
+  GFile *file;
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *write_error;
+
+  guint n_items;
+  guint window;
+  KuroBoard **slots;
+  gboolean *ready;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+} BookJob;
+
+static void book_job_free(BookJob *job) {
+  guint i;
+
+  if (job->pool != NULL)
+    g_thread_pool_free(job->pool, TRUE, TRUE);
+
+  for (i = 0; i < job->window; i++)
+    kuro_board_free(job->slots[i]);
+  g_free(job->slots);
+  g_free(job->ready);
+
+  g_clear_object(&job->stream);
+  g_clear_object(&job->cancellable);
+  g_clear_error(&job->write_error);
+  g_object_unref(job->file);
+  g_mutex_clear(&job->lock);
+  g_cond_clear(&job->cond);
+  g_free(job);
+}
+
+static guint puzzle_size(const KuroBookOptions *options, guint puzzle) {
+  return options->min_size +
+         puzzle % (options->max_size - options->min_size + 1);
+}
+
+static void generate_item_cb(gpointer data, gpointer user_data) {
+  BookJob *job = user_data;
+  guint item = GPOINTER_TO_UINT(data) - 1;
+  guint puzzle = item % job->options.n_puzzles;
+  KuroBoard *board = NULL;
+
+  /* Solutions are regenerated from the same seed rather than kept around
+   * until the end of the book. */
+  if (!g_cancellable_is_cancelled(job->cancellable))
+    board = kuro_generator_new_board(
+        puzzle_size(&job->options, puzzle),
+        kuro_generator_derive_seed(job->options.seed, puzzle), FALSE);
+
+  g_mutex_lock(&job->lock);
+  job->slots[item % job->window] = board;
+  job->ready[item % job->window] = TRUE;
+  g_cond_broadcast(&job->cond);
+  g_mutex_unlock(&job->lock);
+}
+
+static void queue_item(BookJob *job, guint item) {
+  if (item < job->n_items)
+    g_thread_pool_push(job->pool, GUINT_TO_POINTER(item + 1), NULL);
+}
+
+static KuroBoard *take_item(BookJob *job, guint item) {
+  guint slot = item % job->window;
+  KuroBoard *board;
+
+  g_mutex_lock(&job->lock);
+  while (job->ready[slot] == FALSE)
+    g_cond_wait(&job->cond, &job->lock);
+
+  board = job->slots[slot];
+  job->slots[slot] = NULL;
+  job->ready[slot] = FALSE;
+  g_mutex_unlock(&job->lock);
+
+  return board;
+}
+
+static cairo_status_t write_cb(void *closure, const unsigned char *data,
+                               unsigned int length) {
+  BookJob *job = closure;
+
+  if (job->write_error != NULL)
+    return CAIRO_STATUS_WRITE_ERROR;
+
+  if (!g_output_stream_write_all(job->stream, data, length, NULL,
+                                 job->cancellable, &job->write_error))
+    return CAIRO_STATUS_WRITE_ERROR;
+
+  return CAIRO_STATUS_SUCCESS;
+}
+
+/* Draw @board with @caption above it, fitted into the given rectangle. This
+ * needs nothing but cairo and Pango, so it works without a display. */
+void kuro_book_draw_board(cairo_t *cr, const KuroBoard *board,
+                          gboolean solution, const gchar *caption, gdouble x,
+                          gdouble y, gdouble width, gdouble height) {
+  PangoLayout *layout;
+  PangoFontDescription *font_desc;
+  gdouble grid_size, cell_size;
+  gint text_width, text_height;
+  KuroVector iter;
+  gchar text[8];
+
+  layout = pango_cairo_create_layout(cr);
+
+  /* Caption */
+  font_desc = pango_font_description_from_string("Sans Bold 11");
+  pango_layout_set_font_description(layout, font_desc);
+  pango_layout_set_text(layout, caption, -1);
+  cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+  cairo_move_to(cr, x, y);
+  pango_cairo_show_layout(cr, layout);
+
+  grid_size = MIN(width, height - CAPTION_HEIGHT);
+  cell_size = grid_size / board->size;
+  x += (width - grid_size) / 2.0;
+  y += CAPTION_HEIGHT;
+
+  pango_font_description_set_weight(font_desc, PANGO_WEIGHT_NORMAL);
+  pango_font_description_set_absolute_size(
+      font_desc, cell_size * NUMBER_SCALE * PANGO_SCALE);
+  pango_layout_set_font_description(layout, font_desc);
+
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      gdouble x_pos = x + iter.x * cell_size;
+      gdouble y_pos = y + iter.y * cell_size;
+      gboolean painted =
+          solution &&
+          (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED);
+
+      if (painted) {
+        cairo_set_source_rgb(cr, 0.25, 0.25, 0.25);
+        cairo_rectangle(cr, x_pos, y_pos, cell_size, cell_size);
+        cairo_fill(cr);
+        cairo_set_source_rgb(cr, 0.85, 0.85, 0.85);
+      } else {
+        cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+      }
+
+      g_snprintf(text, sizeof(text), "%u", board->cells[iter.x][iter.y].num);
+      pango_layout_set_text(layout, text, -1);
+      pango_layout_get_pixel_size(layout, &text_width, &text_height);
+      cairo_move_to(cr, x_pos + (cell_size - text_width) / 2.0,
+                    y_pos + (cell_size - text_height) / 2.0);
+      pango_cairo_show_layout(cr, layout);
+    }
+  }
+
+  /* Grid lines, with a heavier outline */
+  cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+  cairo_set_line_width(cr, 0.5);
+  for (iter.x = 1; iter.x < board->size; iter.x++) {
+    cairo_move_to(cr, x + iter.x * cell_size, y);
+    cairo_line_to(cr, x + iter.x * cell_size, y + grid_size);
+    cairo_move_to(cr, x, y + iter.x * cell_size);
+    cairo_line_to(cr, x + grid_size, y + iter.x * cell_size);
+  }
+  cairo_stroke(cr);
+
+  cairo_set_line_width(cr, 1.5);
+  cairo_rectangle(cr, x, y, grid_size, grid_size);
+  cairo_stroke(cr);
+
+  pango_font_description_free(font_desc);
+  g_object_unref(layout);
+}
+
+static void write_book_thread(GTask *task, gpointer source_object,
+                              gpointer task_data, GCancellable *cancellable) {
+  BookJob *job = task_data;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  cairo_status_t status;
+  guint item, columns, rows;
+  gdouble box_width, box_height;
+  GError *error = NULL;
+
+  job->stream = G_OUTPUT_STREAM(
+      g_file_replace(job->file, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION,
+                     cancellable, &error));
+  if (job->stream == NULL) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  columns = ceil(sqrt(job->options.per_page));
+  rows = (job->options.per_page + columns - 1) / columns;
+  box_width =
+      (PAGE_WIDTH - 2 * PAGE_MARGIN - (columns - 1) * BOX_SPACING) / columns;
+  box_height =
+      (PAGE_HEIGHT - 2 * PAGE_MARGIN - (rows - 1) * BOX_SPACING) / rows;
+
+  surface = cairo_pdf_surface_create_for_stream(write_cb, job, PAGE_WIDTH,
+                                                PAGE_HEIGHT);
+  cr = cairo_create(surface);
+
+  /* Prime the pipeline */
+  for (item = 0; item < job->window; item++)
+    queue_item(job, item);
+
+  for (item = 0; item < job->n_items; item++) {
+    guint puzzle = item % job->options.n_puzzles;
+    guint position = puzzle % job->options.per_page;
+    gboolean solution = (item >= job->options.n_puzzles);
+    KuroBoard *board;
+    gchar *caption;
+
+    board = take_item(job, item);
+    if (board == NULL || job->write_error != NULL) {
+      kuro_board_free(board);
+      break;
+    }
+
+    /* Keep the workers busy while we draw this one */
+    queue_item(job, item + job->window);
+
+    /* Start a new page once this one is full. Solutions line up with their
+     * puzzles, so they always start on a fresh page too. */
+    if (item > 0 && position == 0)
+      cairo_show_page(cr);
+
+    if (solution)
+      caption = g_strdup_printf(_("Solution %u"), puzzle + 1);
+    else
+      caption = g_strdup_printf(_("Puzzle %u — %u × %u"), puzzle + 1,
+                                board->size, board->size);
+
+    kuro_book_draw_board(cr, board, solution, caption,
+               PAGE_MARGIN + (position % columns) * (box_width + BOX_SPACING),
+               PAGE_MARGIN + (position / columns) * (box_height + BOX_SPACING),
+               box_width, box_height);
+
+    g_free(caption);
+    kuro_board_free(board);
+  }
+
+  cairo_destroy(cr);
+  cairo_surface_finish(surface);
+  status = cairo_surface_status(surface);
+  cairo_surface_destroy(surface);
+
+  if (g_task_return_error_if_cancelled(task))
+    return;
+
+  if (job->write_error != NULL) {
+    g_task_return_error(task, g_steal_pointer(&job->write_error));
+    return;
+  }
+
+  if (status != CAIRO_STATUS_SUCCESS) {
+    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s",
+                            cairo_status_to_string(status));
+    return;
+  }
+
+  if (!g_output_stream_close(job->stream, cancellable, &error)) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  g_task_return_boolean(task, TRUE);
+}
+
+void kuro_book_write_async(GFile *file, const KuroBookOptions *options,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback, gpointer user_data) {
+  GTask *task;
+  BookJob *job;
+  guint n_threads;
+
+  g_return_if_fail(G_IS_FILE(file));
+  g_return_if_fail(options != NULL);
+  g_return_if_fail(options->n_puzzles > 0);
+  g_return_if_fail(options->per_page > 0);
+  g_return_if_fail(options->min_size > 0 &&
+                   options->min_size <= options->max_size);
+
+  job = g_new0(BookJob, 1);
+  job->options = *options;
+  if (job->options.seed == 0)
+    job->options.seed = g_random_int();
+  job->file = g_object_ref(file);
+  job->cancellable = (cancellable != NULL) ? g_object_ref(cancellable)
+                                           : g_cancellable_new();
+  g_mutex_init(&job->lock);
+  g_cond_init(&job->cond);
+
+  job->n_items = options->n_puzzles * (options->solutions ? 2 : 1);
+
+  /* Enough boards in flight to keep every core busy while a page is drawn */
+  n_threads = g_get_num_processors();
+  job->window = MIN(MAX(2 * n_threads, options->per_page), job->n_items);
+  job->slots = g_new0(KuroBoard *, job->window);
+  job->ready = g_new0(gboolean, job->window);
+  job->pool =
+      g_thread_pool_new(generate_item_cb, job, n_threads, FALSE, NULL);
+
+  task = g_task_new(NULL, job->cancellable, callback, user_data);
+  g_task_set_source_tag(task, kuro_book_write_async);
+  g_task_set_task_data(task, job, (GDestroyNotify)book_job_free);
+  g_task_run_in_thread(task, write_book_thread);
+  g_object_unref(task);
+}
+
+gboolean kuro_book_write_finish(GAsyncResult *result, GError **error) {
+  g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
@@ -0,0 +1,51 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_BOOK_H
+#define KURO_BOOK_H
+
+#include <cairo.h>
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+typedef struct {
+  guint n_puzzles;
+  guint min_size;
+  guint max_size;    /* sizes cycle from min_size to max_size */
+  guint per_page;
+  gboolean solutions; /* append solution pages after the puzzles */
+  guint seed;
+} KuroBookOptions;
+
+void kuro_book_write_async(GFile *file, const KuroBookOptions *options,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback, gpointer user_data);
+gboolean kuro_book_write_finish(GAsyncResult *result, GError **error);
+
+void kuro_book_draw_board(cairo_t *cr, const KuroBoard *board,
+                          gboolean solution, const gchar *caption, gdouble x,
+                          gdouble y, gdouble width, gdouble height);
+
+G_END_DECLS
+
+#endif /* KURO_BOOK_H */
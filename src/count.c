@@ -0,0 +1,561 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "count.h"
+#include "profiler.h"
+#include "sat.h"
+
+/* Solutions are counted a row at a time, keeping track of every distinct way
+ * the rows so far can end. Two partial solutions which end the same way have
+ * the same completions, so only the number of each is kept. The way they end
+ * is summed up by:
+ *  - which cells of the last row are painted, and which of its unpainted
+ *    cells are joined up through the rows above (as labels, 0 for painted
+ *    cells, numbered in order of first appearance along the row); and
+ *  - which repeated numbers in each column have already been left unpainted
+ *    above, as one bit for each which still has repeats to come. */
+
+#define LABEL_BITS 4
+#define LABEL_MASK ((1u << LABEL_BITS) - 1)
+#define MAX_SLOTS 64 /* repeated numbers which can be open at once */
+
+typedef struct {
+  guint64 labels; /* LABEL_BITS per cell of the last row */
+  guint64 used;   /* a bit per open repeated number, set once it's unpainted */
+  guint64 count;  /* partial solutions which end this way */
+} State;
+
+static guint state_hash(gconstpointer key) {
+  const State *state = key;
+  guint64 h = state->labels * 0x9E3779B97F4A7C15u ^ state->used;
+
+  h = (h ^ (h >> 31)) * 0xBF58476D1CE4E5B9u;
+  return (guint)(h ^ (h >> 32));
+}
+
+static gboolean state_equal(gconstpointer a, gconstpointer b) {
+  const State *state_a = a, *state_b = b;
+
+  return state_a->labels == state_b->labels && state_a->used == state_b->used;
+}
+
+static guint get_label(guint64 labels, guint x) {
+  return (guint)(labels >> (x * LABEL_BITS)) & LABEL_MASK;
+}
+
+/* Add @count ways of ending with @labels and @used to @states */
+static void add_state(GHashTable *states, guint64 labels, guint64 used,
+                      guint64 count, guint64 limit) {
+  State key = {labels, used, 0}, *state;
+
+  state = g_hash_table_lookup(states, &key);
+  if (state == NULL) {
+    state = g_new(State, 1);
+    *state = key;
+    g_hash_table_add(states, state);
+  }
+
+  /* Counts saturate at @limit, as they can get astronomical */
+  state->count = (count > limit - state->count) ? limit : state->count + count;
+}
+
+static guint find_root(guint *parent, guint node) {
+  while (parent[node] != node)
+    node = parent[node] = parent[parent[node]];
+  return node;
+}
+
+/* Join row @y, painted as in @mask, onto the end described by @labels. Returns
+ * FALSE if some unpainted cells above would be cut off for good. */
+static gboolean join_row(guint width, guint64 labels, gboolean first,
+                         guint mask, guint64 *new_labels) {
+  guint parent[KURO_COUNT_MAX_WIDTH * 2], renumbered[KURO_COUNT_MAX_WIDTH * 2];
+  guint x, next_label = 1;
+
+  /* Nodes 0 to width - 1 are the old labels less one, and width onwards are
+   * the new row's cells */
+  for (x = 0; x < width * 2; x++) {
+    parent[x] = x;
+    renumbered[x] = 0;
+  }
+
+  for (x = 0; x < width; x++) {
+    guint above = first ? 0 : get_label(labels, x);
+
+    if (mask & (1u << x))
+      continue;
+    if (x > 0 && !(mask & (1u << (x - 1))))
+      parent[find_root(parent, width + x)] = find_root(parent, width + x - 1);
+    if (above != 0)
+      parent[find_root(parent, above - 1)] = find_root(parent, width + x);
+  }
+
+  /* Every group of unpainted cells above must carry on into this row, as
+   * nothing below could join it up to the others otherwise */
+  if (!first) {
+    for (x = 0; x < width; x++) {
+      guint above = get_label(labels, x), i;
+      gboolean carried_on = FALSE;
+
+      if (above == 0)
+        continue;
+      for (i = 0; i < width && !carried_on; i++)
+        carried_on = !(mask & (1u << i)) &&
+                     find_root(parent, width + i) ==
+                         find_root(parent, above - 1);
+      if (!carried_on)
+        return FALSE;
+    }
+  }
+
+  *new_labels = 0;
+  for (x = 0; x < width; x++) {
+    guint root;
+
+    if (mask & (1u << x))
+      continue;
+
+    root = find_root(parent, width + x);
+    if (renumbered[root] == 0)
+      renumbered[root] = next_label++;
+    *new_labels |= (guint64)renumbered[root] << (x * LABEL_BITS);
+  }
+
+  return TRUE;
+}
+
+/* Whether @mask is a possible way of painting row @y on its own: no painted
+ * cells next to each other, and no number unpainted twice */
+static gboolean is_row_possible(const KuroBoard *board, guint y, guint mask) {
+  guint64 seen = 0;
+  guint x;
+
+  if (mask & (mask >> 1))
+    return FALSE;
+
+  for (x = 0; x < board->size; x++) {
+    guint64 bit = (guint64)1 << board->cells[x][y].num;
+
+    if (mask & (1u << x))
+      continue;
+    if (seen & bit)
+      return FALSE;
+    seen |= bit;
+  }
+
+  return TRUE;
+}
+
+/* Work out which slot each repeated number in each column uses. Slots are
+ * handed out as each number first appears and taken back after it last does,
+ * so that finished columns don't make otherwise equal ends look different.
+ * @slots[x * size + y] is the slot for cell (x, y), or -1 if its number
+ * isn't repeated in its column, and @closing[y] has the slots taken back
+ * after row y. Returns FALSE if too many are needed at once. */
+static gboolean assign_slots(const KuroBoard *board, gint *slots,
+                             guint64 *closing) {
+  guint size = board->size, x, y, i;
+  guint64 free_slots = G_MAXUINT64;
+
+  memset(closing, 0, sizeof(guint64) * size);
+
+  for (y = 0; y < size; y++) {
+    for (x = 0; x < size; x++) {
+      guint num = board->cells[x][y].num, first = size, last = 0, n = 0;
+
+      for (i = 0; i < size; i++) {
+        if (board->cells[x][i].num == num) {
+          first = MIN(first, i);
+          last = MAX(last, i);
+          n++;
+        }
+      }
+
+      if (n < 2) {
+        slots[x * size + y] = -1;
+      } else if (y != first) {
+        slots[x * size + y] = slots[x * size + first];
+      } else if (free_slots == 0) {
+        return FALSE;
+      } else {
+        gint slot;
+
+        /* The lowest free slot */
+        for (slot = 0; !(free_slots & ((guint64)1 << slot)); slot++)
+          ;
+        free_slots &= ~((guint64)1 << slot);
+        slots[x * size + y] = slot;
+        closing[last] |= (guint64)1 << slot;
+      }
+    }
+
+    free_slots |= closing[y];
+  }
+
+  return TRUE;
+}
+
+/* Count the solutions to @board, stopping at @limit. Returns FALSE, leaving
+ * @n_solutions alone, if the board's too wide or has too many repeated
+ * numbers to count this way. */
+gboolean kuro_count_solutions(const KuroBoard *board, guint64 limit,
+                              guint64 *n_solutions) {
+  guint size = board->size, y, mask;
+  gint *slots;
+  guint64 *closing, total = 0;
+  GHashTable *states, *next_states, *tmp;
+  GHashTableIter iter;
+  State *state;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  g_return_val_if_fail(limit > 0, FALSE);
+
+  if (size > KURO_COUNT_MAX_WIDTH)
+    return FALSE;
+
+  slots = g_new(gint, size * size);
+  closing = g_new(guint64, size);
+  if (!assign_slots(board, slots, closing)) {
+    g_free(slots);
+    g_free(closing);
+    return FALSE;
+  }
+
+  states = g_hash_table_new_full(state_hash, state_equal, g_free, NULL);
+  next_states = g_hash_table_new_full(state_hash, state_equal, g_free, NULL);
+  add_state(states, 0, 0, 1, limit);
+
+  for (y = 0; y < size; y++) {
+    for (mask = 0; mask < (1u << size); mask++) {
+      guint64 column_bits = 0;
+      guint x;
+
+      if (!is_row_possible(board, y, mask))
+        continue;
+
+      /* The repeated numbers this row leaves unpainted */
+      for (x = 0; x < size; x++) {
+        if (!(mask & (1u << x)) && slots[x * size + y] >= 0)
+          column_bits |= (guint64)1 << slots[x * size + y];
+      }
+
+      g_hash_table_iter_init(&iter, states);
+      while (g_hash_table_iter_next(&iter, (gpointer *)&state, NULL)) {
+        guint64 new_labels;
+        gboolean clash = FALSE;
+
+        /* Rule 2 down the columns, and rule 1 up them */
+        for (x = 0; x < size && !clash && y > 0; x++)
+          clash = (mask & (1u << x)) && get_label(state->labels, x) == 0;
+        if (clash || (state->used & column_bits) != 0)
+          continue;
+
+        if (join_row(size, state->labels, y == 0, mask, &new_labels))
+          add_state(next_states, new_labels,
+                    (state->used | column_bits) & ~closing[y], state->count,
+                    limit);
+      }
+    }
+
+    g_hash_table_remove_all(states);
+    tmp = states;
+    states = next_states;
+    next_states = tmp;
+  }
+
+  /* Rule 3: the unpainted cells all have to have ended up joined together */
+  g_hash_table_iter_init(&iter, states);
+  while (g_hash_table_iter_next(&iter, (gpointer *)&state, NULL)) {
+    guint x, max_label = 0;
+
+    for (x = 0; x < size; x++)
+      max_label = MAX(max_label, get_label(state->labels, x));
+    if (max_label == 1)
+      total = (state->count > limit - total) ? limit : total + state->count;
+  }
+
+  g_hash_table_unref(states);
+  g_hash_table_unref(next_states);
+  g_free(slots);
+  g_free(closing);
+
+  *n_solutions = total;
+
+  KURO_PROFILER_ADD_MARK_PRINTF(begin, "Count solutions", "%u×%u", size, size);
+
+  return TRUE;
+}
+
+/* Counting with the SAT solver. Each cell is a variable, true if it's
+ * painted. Rules 1 and 2 are clauses from the start; rule 3 can't be put
+ * into clauses directly without a lot of them, so instead each solution is
+ * checked, and whenever its unpainted cells are split up, a clause is added
+ * ruling out that split, and the solver tries again. */
+
+/* The cells next to @cell, in @neighbours */
+static guint get_neighbours(guint size, guint cell, guint *neighbours) {
+  guint n_neighbours = 0;
+
+  if (cell >= size)
+    neighbours[n_neighbours++] = cell - size;
+  if (cell + size < size * size)
+    neighbours[n_neighbours++] = cell + size;
+  if (cell % size > 0)
+    neighbours[n_neighbours++] = cell - 1;
+  if (cell % size < size - 1)
+    neighbours[n_neighbours++] = cell + 1;
+
+  return n_neighbours;
+}
+
+typedef struct {
+  KuroSat *sat;
+  guint size;
+  guint *groups;  /* each cell's group of unpainted cells, or 0 if painted */
+  guint *firsts;  /* each group's first cell, indexed from 1 */
+  guint *edges;   /* the last group each painted cell was found on the edge of */
+  guint *stack;
+  guint *clause;
+} CutChecker;
+
+/* Rule out painting every cell on the edge of group @group while leaving its
+ * first cell and @other unpainted, as @other could never be reached */
+static void add_cut(CutChecker *checker, guint group, guint other) {
+  guint n_cells = checker->size * checker->size, n_clause = 0, cell;
+
+  checker->clause[n_clause++] = KURO_SAT_LIT(checker->firsts[group], FALSE);
+  checker->clause[n_clause++] = KURO_SAT_LIT(other, FALSE);
+
+  for (cell = 0; cell < n_cells; cell++) {
+    guint neighbours[4], n_neighbours, i;
+
+    if (checker->groups[cell] != group)
+      continue;
+
+    n_neighbours = get_neighbours(checker->size, cell, neighbours);
+    for (i = 0; i < n_neighbours; i++) {
+      guint next = neighbours[i];
+
+      if (checker->groups[next] == 0 && checker->edges[next] != group) {
+        checker->edges[next] = group;
+        checker->clause[n_clause++] = KURO_SAT_LIT(next, TRUE);
+      }
+    }
+  }
+
+  kuro_sat_add_clause(checker->sat, checker->clause, n_clause);
+}
+
+/* Check the solver's solution against rule 3. If it's broken, add cuts
+ * ruling out each group of unpainted cells being split off from the first
+ * one, and the first from the second, and return FALSE. */
+static gboolean check_cuts(CutChecker *checker) {
+  guint n_cells = checker->size * checker->size, n_groups = 0, cell, group;
+
+  for (cell = 0; cell < n_cells; cell++) {
+    checker->groups[cell] = 0;
+    checker->edges[cell] = 0;
+  }
+
+  for (cell = 0; cell < n_cells; cell++) {
+    guint n_stack = 0;
+
+    if (kuro_sat_get_model(checker->sat, cell) || checker->groups[cell] != 0)
+      continue;
+
+    checker->firsts[++n_groups] = cell;
+    checker->groups[cell] = n_groups;
+    checker->stack[n_stack++] = cell;
+
+    while (n_stack > 0) {
+      guint neighbours[4], n_neighbours, i;
+
+      n_neighbours =
+          get_neighbours(checker->size, checker->stack[--n_stack], neighbours);
+      for (i = 0; i < n_neighbours; i++) {
+        guint next = neighbours[i];
+
+        if (checker->groups[next] == 0 &&
+            !kuro_sat_get_model(checker->sat, next)) {
+          checker->groups[next] = n_groups;
+          checker->stack[n_stack++] = next;
+        }
+      }
+    }
+  }
+
+  /* Painting everything isn't a solution either */
+  if (n_groups == 0) {
+    for (cell = 0; cell < n_cells; cell++)
+      checker->clause[cell] = KURO_SAT_LIT(cell, TRUE);
+    kuro_sat_add_clause(checker->sat, checker->clause, n_cells);
+    return FALSE;
+  } else if (n_groups == 1) {
+    return TRUE;
+  }
+
+  add_cut(checker, 1, checker->firsts[2]);
+  for (group = 2; group <= n_groups; group++)
+    add_cut(checker, group, checker->firsts[1]);
+
+  return FALSE;
+}
+
+/* Add rules 1 and 2 for @board as clauses */
+static void add_rules(KuroSat *sat, const KuroBoard *board) {
+  guint size = board->size, x, y, i;
+
+  for (x = 0; x < size; x++) {
+    for (y = 0; y < size; y++) {
+      guint cell = x * size + y, clause[2];
+
+      /* Rule 1: of two equal numbers in a row or column, one is painted */
+      clause[0] = KURO_SAT_LIT(cell, FALSE);
+      for (i = y + 1; i < size; i++) {
+        if (board->cells[x][i].num == board->cells[x][y].num) {
+          clause[1] = KURO_SAT_LIT(x * size + i, FALSE);
+          kuro_sat_add_clause(sat, clause, 2);
+        }
+      }
+      for (i = x + 1; i < size; i++) {
+        if (board->cells[i][y].num == board->cells[x][y].num) {
+          clause[1] = KURO_SAT_LIT(i * size + y, FALSE);
+          kuro_sat_add_clause(sat, clause, 2);
+        }
+      }
+
+      /* Rule 2: of two cells next to each other, one isn't painted */
+      clause[0] = KURO_SAT_LIT(cell, TRUE);
+      if (x + 1 < size) {
+        clause[1] = KURO_SAT_LIT(cell + size, TRUE);
+        kuro_sat_add_clause(sat, clause, 2);
+      }
+      if (y + 1 < size) {
+        clause[1] = KURO_SAT_LIT(cell + 1, TRUE);
+        kuro_sat_add_clause(sat, clause, 2);
+      }
+    }
+  }
+}
+
+/* Count with the SAT solver, marking the first solution found in @solution
+ * if it isn't NULL. If @keep_painted, only solutions which paint every cell
+ * painted on @board are counted. */
+static gboolean count_sat(const KuroBoard *board, guint64 limit,
+                          guint64 max_conflicts, guint64 *n_solutions,
+                          KuroCell **solution, gboolean keep_painted) {
+  guint n_cells = board->size * board->size, cell;
+  guint64 count = 0;
+  CutChecker checker;
+  KuroSatResult result = KURO_SAT_UNKNOWN;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  g_return_val_if_fail(limit > 0, FALSE);
+
+  checker.sat = kuro_sat_new(n_cells);
+  checker.size = board->size;
+  checker.groups = g_new(guint, n_cells);
+  checker.firsts = g_new(guint, n_cells + 1);
+  checker.edges = g_new(guint, n_cells);
+  checker.stack = g_new(guint, n_cells);
+  checker.clause = g_new(guint, n_cells + 2);
+
+  add_rules(checker.sat, board);
+
+  for (cell = 0; cell < n_cells && keep_painted; cell++) {
+    if (board->cells[cell / board->size][cell % board->size].status &
+        CELL_PAINTED) {
+      checker.clause[0] = KURO_SAT_LIT(cell, FALSE);
+      kuro_sat_add_clause(checker.sat, checker.clause, 1);
+    }
+  }
+
+  while (count < limit) {
+    guint64 spent = kuro_sat_get_n_conflicts(checker.sat);
+
+    /* @max_conflicts is shared out between every solve, rather than each */
+    if (max_conflicts != 0 && spent >= max_conflicts) {
+      result = KURO_SAT_UNKNOWN;
+      break;
+    }
+    result = kuro_sat_solve(checker.sat,
+                            max_conflicts != 0 ? max_conflicts - spent : 0);
+    if (result != KURO_SAT_SATISFIABLE)
+      break;
+
+    if (!check_cuts(&checker))
+      continue;
+
+    /* A solution: rule it out, and look for another */
+    if (count++ == 0 && solution != NULL) {
+      for (cell = 0; cell < n_cells; cell++) {
+        KuroCell *c = &solution[cell / board->size][cell % board->size];
+
+        if (kuro_sat_get_model(checker.sat, cell))
+          c->status |= CELL_SHOULD_BE_PAINTED;
+        else
+          c->status &= ~CELL_SHOULD_BE_PAINTED;
+      }
+    }
+    for (cell = 0; cell < n_cells; cell++)
+      checker.clause[cell] =
+          KURO_SAT_LIT(cell, kuro_sat_get_model(checker.sat, cell));
+    kuro_sat_add_clause(checker.sat, checker.clause, n_cells);
+  }
+
+  kuro_sat_free(checker.sat);
+  g_free(checker.groups);
+  g_free(checker.firsts);
+  g_free(checker.edges);
+  g_free(checker.stack);
+  g_free(checker.clause);
+
+  KURO_PROFILER_ADD_MARK_PRINTF(begin, "Count solutions (SAT)", "%u×%u",
+                                board->size, board->size);
+
+  if (result == KURO_SAT_UNKNOWN && count < limit)
+    return FALSE;
+
+  *n_solutions = count;
+  return TRUE;
+}
+
+/* Count the solutions to @board with the SAT solver, stopping at @limit,
+ * which should be small as every solution found is ruled out with a clause
+ * of its own. Works for boards of any size. Returns FALSE, leaving
+ * @n_solutions alone, if the solver gave up after @max_conflicts conflicts
+ * in total, unless that's 0. */
+gboolean kuro_count_solutions_sat(const KuroBoard *board, guint64 limit,
+                                  guint64 max_conflicts,
+                                  guint64 *n_solutions) {
+  return count_sat(board, limit, max_conflicts, n_solutions, NULL, FALSE);
+}
+
+/* Count as kuro_count_solutions_sat() does, and mark the first solution found
+ * on @board with CELL_SHOULD_BE_PAINTED, for boards which didn't come with
+ * one. The marks are left alone if there isn't a solution. Cells already
+ * painted stay painted, so this also finishes off a board being played. */
+gboolean kuro_count_solve(KuroBoard *board, guint64 limit,
+                          guint64 max_conflicts, guint64 *n_solutions) {
+  return count_sat(board, limit, max_conflicts, n_solutions, board->cells,
+                   TRUE);
+}
@@ -0,0 +1,537 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "count.h"
+#include "format.h"
+
+/* How many puzzles' worth of text is built up before it's written out */
+#define CONVERT_BUFFER_SIZE 65536
+
+/* How much is read from a stream at a time, unless asked otherwise */
+#define READ_CHUNK_SIZE 65536
+
+static const gchar *const format_names[] = {"plain", "singles", "kuro"};
+
+gboolean kuro_format_from_name(const gchar *name, KuroFormat *format) {
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(format_names); i++) {
+    if (g_strcmp0(name, format_names[i]) == 0) {
+      *format = (KuroFormat)i;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+void kuro_format_reader_init(KuroFormatReader *reader, const gchar *data,
+                             gsize length) {
+  reader->p = data;
+  reader->end = data + length;
+  reader->line = 1;
+  reader->puzzle_line = 0;
+  reader->format = KURO_FORMAT_PLAIN;
+  reader->stream = NULL;
+  reader->chunk_size = 0;
+  reader->buffer = NULL;
+  reader->buffer_size = 0;
+  reader->filled = reader->end;
+}
+
+/* Read from @stream @chunk_size bytes at a time, or a default amount if it's
+ * 0, so that however long it is only the puzzle being read is held in
+ * memory. @stream has to outlive the reader. */
+void kuro_format_reader_init_stream(KuroFormatReader *reader,
+                                    GInputStream *stream, gsize chunk_size) {
+  g_return_if_fail(G_IS_INPUT_STREAM(stream));
+
+  reader->p = reader->end = reader->filled = NULL;
+  reader->line = 1;
+  reader->puzzle_line = 0;
+  reader->format = KURO_FORMAT_PLAIN;
+  reader->stream = stream;
+  reader->chunk_size = (chunk_size > 0) ? chunk_size : READ_CHUNK_SIZE;
+  reader->buffer = NULL;
+  reader->buffer_size = 0;
+}
+
+void kuro_format_reader_clear(KuroFormatReader *reader) {
+  g_clear_pointer(&reader->buffer, g_free);
+  reader->buffer_size = 0;
+}
+
+/* Move whatever hasn't been read yet to the start of the buffer, and read
+ * another chunk after it. Only whole lines are read from until the stream
+ * runs out. */
+static gboolean refill(KuroFormatReader *reader, GError **error) {
+  gsize kept = (gsize)(reader->filled - reader->p);
+  const gchar *end;
+  gssize n_read;
+
+  if (kept > 0)
+    memmove(reader->buffer, reader->p, kept);
+  if (reader->buffer_size < kept + reader->chunk_size) {
+    reader->buffer_size =
+        MAX(kept + reader->chunk_size, reader->buffer_size * 2);
+    reader->buffer = g_renew(gchar, reader->buffer, reader->buffer_size);
+  }
+
+  n_read = g_input_stream_read(reader->stream, reader->buffer + kept,
+                               reader->chunk_size, NULL, error);
+  if (n_read < 0)
+    return FALSE;
+
+  reader->p = reader->buffer;
+  reader->filled = reader->buffer + kept + n_read;
+  if (n_read == 0) {
+    reader->stream = NULL;
+    reader->end = reader->filled;
+    return TRUE;
+  }
+
+  for (end = reader->filled; end > reader->p && end[-1] != '\n'; end--)
+    ;
+  reader->end = end;
+
+  return TRUE;
+}
+
+/* The end of the current line, not counting a trailing \r */
+static const gchar *line_end(const KuroFormatReader *reader) {
+  const gchar *eol = memchr(reader->p, '\n', reader->end - reader->p);
+
+  if (eol == NULL)
+    eol = reader->end;
+  if (eol > reader->p && eol[-1] == '\r')
+    eol--;
+
+  return eol;
+}
+
+static void next_line(KuroFormatReader *reader) {
+  const gchar *eol = memchr(reader->p, '\n', reader->end - reader->p);
+
+  reader->p = (eol != NULL) ? eol + 1 : reader->end;
+  reader->line++;
+}
+
+static const gchar *skip_spaces(const gchar *p, const gchar *eol) {
+  while (p < eol && (*p == ' ' || *p == '\t'))
+    p++;
+
+  return p;
+}
+
+/* Read a number at @p, moving past it */
+static gboolean parse_number(const gchar **p, const gchar *eol, guint *num) {
+  const gchar *start = *p;
+  guint value = 0;
+
+  while (*p < eol && g_ascii_isdigit(**p)) {
+    value = value * 10 + (guint)(**p - '0');
+    if (value > G_MAXUINT16)
+      return FALSE;
+    (*p)++;
+  }
+
+  *num = value;
+  return *p > start;
+}
+
+/* Read the row of numbers on the current line into @nums, noting which are
+ * followed by ‘#’ in @marked if it isn't NULL. Numbers are separated by spaces
+ * or commas, or if there are none of those, written a digit each. Returns how
+ * many numbers there were, or 0 if there's anything else on the line. */
+static guint scan_row(const KuroFormatReader *reader, guint16 *nums,
+                      gboolean *marked) {
+  const gchar *p = reader->p, *eol = line_end(reader);
+  gboolean separated = (marked != NULL);
+  guint n_nums = 0, num;
+
+  for (; p < eol && !separated; p++)
+    separated = (*p == ' ' || *p == '\t' || *p == ',');
+
+  for (p = skip_spaces(reader->p, eol); p < eol;) {
+    if (n_nums > MAX_BOARD_SIZE)
+      return 0;
+
+    if (separated) {
+      if (!parse_number(&p, eol, &num))
+        return 0;
+    } else if (g_ascii_isdigit(*p)) {
+      num = (guint)(*p++ - '0');
+    } else {
+      return 0;
+    }
+
+    if (marked != NULL) {
+      marked[n_nums] = (p < eol && *p == '#');
+      if (marked[n_nums])
+        p++;
+    }
+    nums[n_nums++] = (guint16)num;
+
+    p = skip_spaces(p, eol);
+    if (separated && p < eol && *p == ',')
+      p = skip_spaces(p + 1, eol);
+  }
+
+  return n_nums;
+}
+
+/* Check the numbers are ones a board of @size could have; generated boards
+ * use one more than the size */
+static gboolean check_numbers(const KuroFormatReader *reader, guint line,
+                              const guint16 *nums, guint size,
+                              GError **error) {
+  guint i;
+
+  for (i = 0; i < size; i++) {
+    if (nums[i] < 1 || nums[i] > size + 1) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Line %u: %u isn’t between 1 and %u", line, nums[i],
+                  size + 1);
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/* Read the @size rows of a plain or Kuro puzzle, starting at the current
+ * line, into @board */
+static gboolean read_rows(KuroFormatReader *reader, KuroBoard *board,
+                          gboolean solution, GError **error) {
+  guint16 nums[MAX_BOARD_SIZE + 1];
+  gboolean marked[MAX_BOARD_SIZE + 1];
+  guint size = board->size, x, y;
+
+  for (y = 0; y < size; y++) {
+    if (reader->p >= reader->end ||
+        scan_row(reader, nums, solution ? marked : NULL) != size) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Line %u: expected a row of %u numbers", reader->line, size);
+      return FALSE;
+    } else if (!check_numbers(reader, reader->line, nums, size, error)) {
+      return FALSE;
+    }
+
+    for (x = 0; x < size; x++) {
+      board->cells[x][y].num = nums[x];
+      if (solution && marked[x])
+        board->cells[x][y].status |= CELL_SHOULD_BE_PAINTED;
+    }
+
+    next_line(reader);
+  }
+
+  return TRUE;
+}
+
+static KuroBoard *read_plain(KuroFormatReader *reader, GError **error) {
+  guint16 nums[MAX_BOARD_SIZE + 1];
+  KuroBoard *board;
+  guint size = scan_row(reader, nums, NULL);
+
+  if (size == 0 || size > MAX_BOARD_SIZE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: expected a row of numbers", reader->line);
+    return NULL;
+  }
+
+  board = kuro_board_new(size);
+  if (!read_rows(reader, board, FALSE, error)) {
+    kuro_board_free(board);
+    return NULL;
+  }
+
+  return board;
+}
+
+static KuroBoard *read_kuro(KuroFormatReader *reader, GError **error) {
+  const gchar *eol = line_end(reader);
+  const gchar *p = skip_spaces(reader->p, eol) + strlen("kuro");
+  KuroBoard *board;
+  guint size;
+
+  p = skip_spaces(p, eol);
+  if (!parse_number(&p, eol, &size) || skip_spaces(p, eol) != eol ||
+      size == 0 || size > MAX_BOARD_SIZE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: expected ‘kuro’ and the size", reader->line);
+    return NULL;
+  }
+  next_line(reader);
+
+  board = kuro_board_new(size);
+  if (!read_rows(reader, board, TRUE, error)) {
+    kuro_board_free(board);
+    return NULL;
+  }
+
+  return board;
+}
+
+/* The number for a character in a Singles game ID */
+static gint singles_number(gchar c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'a' && c <= 'z')
+    return c - 'a' + 10;
+  else if (c >= 'A' && c <= 'Z')
+    return c - 'A' + 36;
+  else
+    return -1;
+}
+
+static gchar singles_character(guint num) {
+  if (num < 10)
+    return (gchar)('0' + num);
+  else if (num < 36)
+    return (gchar)('a' + num - 10);
+  else
+    return (gchar)('A' + num - 36);
+}
+
+static KuroBoard *read_singles(KuroFormatReader *reader, GError **error) {
+  const gchar *eol = line_end(reader), *p = skip_spaces(reader->p, eol);
+  guint16 nums[MAX_BOARD_SIZE + 1];
+  guint width, height, x, y;
+  KuroBoard *board;
+
+  if (!parse_number(&p, eol, &width) || p == eol || *p++ != 'x' ||
+      !parse_number(&p, eol, &height)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: expected a Singles game ID", reader->line);
+    return NULL;
+  } else if (width != height || width == 0 || width > MAX_BOARD_SIZE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: only square puzzles up to %u×%u are supported",
+                reader->line, MAX_BOARD_SIZE, MAX_BOARD_SIZE);
+    return NULL;
+  }
+
+  /* Skip the difficulty, or anything else before the description */
+  p = memchr(p, ':', eol - p);
+  if (p == NULL) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: expected a Singles game ID", reader->line);
+    return NULL;
+  }
+  p++;
+  while (eol > p && (eol[-1] == ' ' || eol[-1] == '\t'))
+    eol--;
+
+  if ((gsize)(eol - p) != (gsize)width * height) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Line %u: expected %u cells", reader->line, width * height);
+    return NULL;
+  }
+
+  board = kuro_board_new(width);
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      gint num = singles_number(*p++);
+
+      nums[x] = (guint16)MAX(num, 0);
+    }
+
+    if (!check_numbers(reader, reader->line, nums, width, error)) {
+      kuro_board_free(board);
+      return NULL;
+    }
+    for (x = 0; x < width; x++)
+      board->cells[x][y].num = nums[x];
+  }
+  next_line(reader);
+
+  return board;
+}
+
+static gboolean read_puzzle(KuroFormatReader *reader, KuroBoard **board,
+                            GError **error) {
+  const gchar *start = NULL, *eol = NULL;
+
+  *board = NULL;
+
+  /* Skip to the start of the puzzle */
+  while (reader->p < reader->end) {
+    eol = line_end(reader);
+    start = skip_spaces(reader->p, eol);
+    if (start < eol && *start != '#')
+      break;
+    next_line(reader);
+  }
+
+  if (reader->p >= reader->end)
+    return TRUE;
+
+  reader->puzzle_line = reader->line;
+
+  if (eol - start >= 4 && memcmp(start, "kuro", 4) == 0) {
+    reader->format = KURO_FORMAT_KURO;
+    *board = read_kuro(reader, error);
+  } else if (memchr(start, ':', eol - start) != NULL) {
+    reader->format = KURO_FORMAT_SINGLES;
+    *board = read_singles(reader, error);
+  } else {
+    reader->format = KURO_FORMAT_PLAIN;
+    *board = read_plain(reader, error);
+  }
+
+  if (*board == NULL)
+    return FALSE;
+
+  kuro_board_rehash(*board);
+  return TRUE;
+}
+
+/* Read the next puzzle, in whichever format it's in. @board is set to NULL
+ * once there are no puzzles left. Puzzles in the Kuro format have their
+ * solution marked with CELL_SHOULD_BE_PAINTED. */
+gboolean kuro_format_read(KuroFormatReader *reader, KuroBoard **board,
+                          GError **error) {
+  for (;;) {
+    const gchar *start = reader->p;
+    guint line = reader->line;
+    GError *read_error = NULL;
+    gboolean success = read_puzzle(reader, board, &read_error);
+
+    /* Running out of lines part way through a puzzle, or before one, only
+     * means the rest of it hasn't been read from the stream yet */
+    if (reader->stream == NULL || reader->p < reader->end ||
+        (success && *board != NULL)) {
+      if (!success)
+        g_propagate_error(error, read_error);
+      return success;
+    }
+
+    g_clear_error(&read_error);
+    reader->p = start;
+    reader->line = line;
+    if (!refill(reader, error))
+      return FALSE;
+  }
+}
+
+/* Append @board to @text in @format, which for Kuro puzzles includes the
+ * solution marked with CELL_SHOULD_BE_PAINTED. Returns FALSE, leaving @text
+ * alone, if it has numbers too big for Singles game IDs. */
+gboolean kuro_format_write(GString *text, const KuroBoard *board,
+                           KuroFormat format) {
+  guint size = board->size, x, y;
+
+  switch (format) {
+  case KURO_FORMAT_PLAIN:
+    for (y = 0; y < size; y++) {
+      for (x = 0; x < size; x++) {
+        /* A digit each, as long as every number is one */
+        if (size + 1 < 10)
+          g_string_append_c(text, (gchar)('0' + board->cells[x][y].num));
+        else
+          g_string_append_printf(text, (x > 0) ? " %u" : "%u",
+                                 board->cells[x][y].num);
+      }
+      g_string_append_c(text, '\n');
+    }
+    g_string_append_c(text, '\n');
+    break;
+  case KURO_FORMAT_SINGLES:
+    for (x = 0; x < size; x++)
+      for (y = 0; y < size; y++)
+        if (board->cells[x][y].num >= 62)
+          return FALSE;
+
+    g_string_append_printf(text, "%ux%u:", size, size);
+    for (y = 0; y < size; y++)
+      for (x = 0; x < size; x++)
+        g_string_append_c(text, singles_character(board->cells[x][y].num));
+    g_string_append_c(text, '\n');
+    break;
+  case KURO_FORMAT_KURO:
+    g_string_append_printf(text, "kuro %u\n", size);
+    for (y = 0; y < size; y++) {
+      for (x = 0; x < size; x++) {
+        g_string_append_printf(
+            text, (x > 0) ? " %u%s" : "%u%s", board->cells[x][y].num,
+            (board->cells[x][y].status & CELL_SHOULD_BE_PAINTED) ? "#" : "");
+      }
+      g_string_append_c(text, '\n');
+    }
+    g_string_append_c(text, '\n');
+    break;
+  default:
+    g_assert_not_reached();
+  }
+
+  return TRUE;
+}
+
+/* Write every puzzle @reader has left to @output in @format, in one pass.
+ * Puzzles converted to the Kuro format from one which doesn't carry the
+ * solution are solved on the way. */
+gboolean kuro_format_convert(KuroFormatReader *reader, GOutputStream *output,
+                             KuroFormat format, guint64 *n_puzzles,
+                             GError **error) {
+  GString *text = g_string_sized_new(CONVERT_BUFFER_SIZE + 1024);
+  gboolean success = TRUE;
+  KuroBoard *board;
+
+  *n_puzzles = 0;
+
+  while (success && (success = kuro_format_read(reader, &board, error)) &&
+         board != NULL) {
+    guint64 n_solutions = 1;
+
+    if (format == KURO_FORMAT_KURO && reader->format != KURO_FORMAT_KURO)
+      kuro_count_solve(board, 1, 0, &n_solutions);
+
+    if (n_solutions == 0) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Line %u: the puzzle can’t be solved", reader->puzzle_line);
+      success = FALSE;
+    } else if (!kuro_format_write(text, board, format)) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "Line %u: the puzzle’s numbers are too big for the %s "
+                  "format",
+                  reader->puzzle_line, format_names[format]);
+      success = FALSE;
+    } else {
+      (*n_puzzles)++;
+    }
+
+    if (success && text->len >= CONVERT_BUFFER_SIZE) {
+      success = g_output_stream_write_all(output, text->str, text->len, NULL,
+                                          NULL, error);
+      g_string_truncate(text, 0);
+    }
+
+    kuro_board_free(board);
+  }
+
+  if (success)
+    success = g_output_stream_write_all(output, text->str, text->len, NULL,
+                                        NULL, error);
+  g_string_free(text, TRUE);
+
+  return success;
+}
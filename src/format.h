@@ -0,0 +1,94 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_FORMAT_H
+#define KURO_FORMAT_H
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+/* Text formats puzzles can be read from and written in. A file can mix them,
+ * a puzzle at a time; blank lines and lines starting with ‘#’ between puzzles
+ * are ignored.
+ *
+ * Plain puzzles are a square of numbers, a row per line, written a digit each
+ * or separated by spaces or commas:
+ *
+ *   12345
+ *   23451
+ *
+ * Singles puzzles are game IDs from Simon Tatham's Portable Puzzle Collection:
+ * the size, anything else up to a colon, and then a character per cell, row
+ * by row, using 1–9, then a–z for 10–35 and A–Z for 36–61:
+ *
+ *   5x5:1234523451…
+ *
+ * Kuro puzzles carry their solution: a ‘kuro’ line with the size, then the
+ * rows, with numbers separated by spaces and a ‘#’ straight after each number
+ * painted in the solution:
+ *
+ *   kuro 5
+ *   1# 2 3 4 5
+ *   2 3# 4 5 1
+ */
+typedef enum {
+  KURO_FORMAT_PLAIN,
+  KURO_FORMAT_SINGLES,
+  KURO_FORMAT_KURO
+} KuroFormat;
+
+/* Reads puzzles straight out of a buffer, such as a mapped file, without
+ * copying it, or a chunk at a time out of a stream, keeping only the puzzle
+ * being read */
+typedef struct {
+  const gchar *p;
+  const gchar *end;  /* of the whole lines read so far */
+  guint line;        /* of @p */
+  guint puzzle_line; /* where the last puzzle read started */
+  KuroFormat format; /* what the last puzzle read was written in */
+
+  GInputStream *stream; /* NULL once it's all been read */
+  gsize chunk_size;
+  gchar *buffer;
+  gsize buffer_size;
+  const gchar *filled; /* the end of what's been read into @buffer */
+} KuroFormatReader;
+
+gboolean kuro_format_from_name(const gchar *name, KuroFormat *format);
+
+void kuro_format_reader_init(KuroFormatReader *reader, const gchar *data,
+                             gsize length);
+void kuro_format_reader_init_stream(KuroFormatReader *reader,
+                                    GInputStream *stream, gsize chunk_size);
+void kuro_format_reader_clear(KuroFormatReader *reader);
+gboolean kuro_format_read(KuroFormatReader *reader, KuroBoard **board,
+                          GError **error);
+gboolean kuro_format_write(GString *text, const KuroBoard *board,
+                           KuroFormat format);
+gboolean kuro_format_convert(KuroFormatReader *reader, GOutputStream *output,
+                             KuroFormat format, guint64 *n_puzzles,
+                             GError **error);
+
+G_END_DECLS
+
+#endif /* KURO_FORMAT_H */
@@ -18,109 +18,152 @@
  */
 
 #include <glib.h>
-#include <stdlib.h>
+#include <string.h>
 
-#include "main.h"
+#include "count.h"
 #include "generator.h"
+#include "profiler.h"
 #include "rules.h"
+#include "search.h"
 
-void
-kuro_generate_board (Kuro *kuro, guint new_board_size, guint seed)
+/* The largest board size which is filled in by trial and error */
+#define RANDOM_FILL_MAX_SIZE 10
+
+/* Mix a puzzle index into a base seed, so that neighbouring puzzles in a batch
+ * don't end up retrying into each other's seeds. */
+guint
+kuro_generator_derive_seed (guint seed, guint index)
 {
-	guchar i;
-	guint total, old_total;
-	KuroVector iter;
-	gboolean *accum, **horiz_accum;
+	guint32 z = seed + (index + 1) * 0x9E3779B9u;
 
-	g_return_if_fail (kuro != NULL);
-	g_return_if_fail (new_board_size > 0);
+	z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+	z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+	z ^= z >> 16;
 
-	/* Seed the random number generator */
-	if (seed == 0)
-		seed = g_get_real_time ();
+	return (z != 0) ? z : 1;
+}
 
-	if (kuro->debug)
-		g_debug ("Seed value: %u", seed);
+/* Conflicts the SAT solver gets before the search takes over */
+#define UNIQUENESS_MAX_CONFLICTS 100000
 
-	srand (seed);
+/* Decisions the search gets on an 8×8 board before giving up. Each one costs
+ * time in proportion to the board's area, so bigger boards get fewer. */
+#define UNIQUENESS_MAX_NODES 1000000
 
-	/* Deallocate any previous board */
-	kuro_free_board (kuro);
+/* Check whether a board has exactly one solution. Boards narrow enough are
+ * counted exactly, a row at a time, which takes the same time whatever the
+ * numbers are; wider ones are handed to the SAT solver, which looks for a
+ * second solution after the first. The odd board which the solver finds too
+ * hard is searched on every processor, up to a budget of decisions, and left
+ * unknown if that runs out. Board generation doesn't check boards itself. */
+KuroUniqueness
+kuro_generator_check_uniqueness (const KuroBoard *board)
+{
+	guint64 n_solutions, max_nodes;
 
-	kuro->board_size = new_board_size;
+	max_nodes = MAX (UNIQUENESS_MAX_NODES * 64 / (board->size * board->size), 1);
 
-	accum = g_new0 (gboolean, kuro->board_size + 2); /* Stores which numbers have been used in the current column */
-	horiz_accum = g_new (gboolean*, kuro->board_size); /* Stores which numbers have been used in each row */
-	for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-		horiz_accum[iter.x] = g_slice_alloc0 (sizeof (gboolean) * (kuro->board_size + 2));
+	if (kuro_count_solutions (board, 2, &n_solutions) == FALSE &&
+	    kuro_count_solutions_sat (board, 2, UNIQUENESS_MAX_CONFLICTS, &n_solutions) == FALSE &&
+	    kuro_search_count_solutions (board, 2, max_nodes, 0, &n_solutions) == FALSE)
+		return KURO_UNIQUENESS_UNKNOWN;
 
-	/* Allocate the board */
-	kuro->board = g_new (KuroCell*, kuro->board_size);
-	for (i = 0; i < kuro->board_size; i++)
-		kuro->board[i] = g_slice_alloc0 (sizeof (KuroCell) * kuro->board_size);
+	if (n_solutions == 0)
+		return KURO_UNIQUENESS_NONE;
+	else if (n_solutions == 1)
+		return KURO_UNIQUENESS_UNIQUE;
+	else
+		return KURO_UNIQUENESS_MULTIPLE;
+}
 
-	/* Generate some randomly-placed painted cells */
-	total = rand () % 5 + 13; /* Total number of painted cells (between 14 and 18 inclusive) */
-	/* For the moment, I'm hardcoding the range in the number of painted
-	 * cells, and only specifying it for 8x8 grids. This will change in the
-	 * future. */
-	for (i = 0; i < total; i++) {
-		/* Generate pairs of coordinates until we find one which lies between unpainted cells (or at the edge of the board) */
-		do {
-			iter.x = rand () % kuro->board_size;
-			iter.y = rand () % kuro->board_size;
+static void
+shuffle (guint *values, guint n_values, GRand *rand)
+{
+	guint i;
 
-			if ((iter.y < 1 || (kuro->board[iter.x][iter.y-1].status & CELL_PAINTED) == FALSE) &&
-			    (iter.y + 1 >= kuro->board_size || (kuro->board[iter.x][iter.y+1].status & CELL_PAINTED) == FALSE) &&
-			    (iter.x < 1 || (kuro->board[iter.x-1][iter.y].status & CELL_PAINTED) == FALSE) &&
-			    (iter.x + 1 >= kuro->board_size || (kuro->board[iter.x+1][iter.y].status & CELL_PAINTED) == FALSE))
-				break;
-		} while (TRUE);
+	for (i = n_values; i > 1; i--) {
+		guint j = g_rand_int_range (rand, 0, i);
+		guint tmp = values[i - 1];
 
-		kuro->board[iter.x][iter.y].status |= (CELL_PAINTED | CELL_SHOULD_BE_PAINTED);
+		values[i - 1] = values[j];
+		values[j] = tmp;
 	}
+}
 
-	/* Check that the painted squares don't mess everything up */
-	if (kuro_check_rule2 (kuro) == FALSE ||
-	    kuro_check_rule3 (kuro) == FALSE) {
-	    	g_free (accum);
-		for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-			g_slice_free1 (sizeof (gboolean) * (kuro->board_size + 2), horiz_accum[iter.x]);
-		g_free (horiz_accum);
-
-		kuro_generate_board (kuro, kuro->board_size, seed + 1);
-		return;
+static gboolean
+is_unpainted (KuroBoard *board, gint x, gint y)
+{
+	return (x >= 0 && y >= 0 && x < (gint) board->size && y < (gint) board->size &&
+	        (board->cells[x][y].status & CELL_PAINTED) == FALSE);
+}
+
+/* Whether painting the given cell would leave one of its unpainted
+ * neighbours with no unpainted neighbours of its own. That's by far the most
+ * common way of breaking rule 3, and on big boards it's all but certain to
+ * happen somewhere unless it's avoided as the cells are painted. Small boards
+ * don't check it, so that their seeds still give the boards they always
+ * have. */
+static gboolean
+would_isolate_neighbour (KuroBoard *board, KuroVector pos)
+{
+	static const gint offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+	guint i, j;
+
+	for (i = 0; i < G_N_ELEMENTS (offsets); i++) {
+		gint x = pos.x + offsets[i][0];
+		gint y = pos.y + offsets[i][1];
+		gboolean isolated = TRUE;
+
+		if (is_unpainted (board, x, y) == FALSE)
+			continue;
+
+		for (j = 0; j < G_N_ELEMENTS (offsets) && isolated == TRUE; j++) {
+			gint nx = x + offsets[j][0];
+			gint ny = y + offsets[j][1];
+
+			if ((nx != pos.x || ny != pos.y) && is_unpainted (board, nx, ny))
+				isolated = FALSE;
+		}
+
+		if (isolated == TRUE)
+			return TRUE;
 	}
 
-	/* Fill in the squares, leaving the painted ones blank,
-	 * and making sure not to repeat any previous numbers. */
-	for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
+	return FALSE;
+}
+
+/* Fill the unpainted cells with random numbers, retrying each cell until it
+ * doesn't clash with its row or column. This gets stuck more and more often
+ * as the board grows, so it's only used for the smaller boards. */
+static gboolean
+fill_random (KuroBoard *board, GRand *rand, gboolean *accum, gboolean **horiz_accum)
+{
+	guint i, total, old_total;
+	KuroVector iter;
+
+	for (iter.y = 0; iter.y < board->size; iter.y++)
+		memset (horiz_accum[iter.y], 0, sizeof (gboolean) * (board->size + 2));
+
+	for (iter.x = 0; iter.x < board->size; iter.x++) {
 		/* Reset the vertical accumulator */
-		for (iter.y = 1; iter.y < kuro->board_size + 2; iter.y++)
+		for (iter.y = 1; iter.y < board->size + 2; iter.y++)
 			accum[iter.y] = FALSE;
 
 		i = 0;
 		accum[0] = TRUE;
-		total = kuro->board_size + 1;
+		total = board->size + 1;
 		old_total = total;
 
-		for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-			if ((kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
+		for (iter.y = 0; iter.y < board->size; iter.y++) {
+			if ((board->cells[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
 				while (accum[i] == TRUE || horiz_accum[iter.y][i] == TRUE) {
 					if (horiz_accum[iter.y][i] == TRUE && accum[i] == FALSE)
 						total--;
 
-					if (total < 1) {
-						g_free (accum);
-						for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-							g_slice_free1 (sizeof (gboolean) * (kuro->board_size + 2), horiz_accum[iter.x]);
-						g_free (horiz_accum);
-
-						kuro_generate_board (kuro, kuro->board_size, seed + 1); /* We're buggered */
-						return;
-					}
+					if (total < 1)
+						return FALSE;
 
-					i = rand () % (kuro->board_size + 1) + 1;
+					i = g_rand_int_range (rand, 0, board->size + 1) + 1;
 				}
 
 				accum[i] = TRUE;
@@ -128,35 +171,369 @@ kuro_generate_board (Kuro *kuro, guint new_board_size, guint seed)
 				total = old_total;
 				total--;
 
-				kuro->board[iter.x][iter.y].num = i;
+				board->cells[iter.x][iter.y].num = i;
 			}
 		}
 	}
 
-	g_free (accum);
-	for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-		g_slice_free1 (sizeof (gboolean) * (kuro->board_size + 2), horiz_accum[iter.x]);
-	g_free (horiz_accum);
+	return TRUE;
+}
+
+/* Fill the unpainted cells from a shuffled Latin square, which can never
+ * clash, so big boards don't need any retries. */
+static void
+fill_latin_square (KuroBoard *board, GRand *rand)
+{
+	guint *numbers, *rows, *columns;
+	guint i;
+	KuroVector iter;
+
+	numbers = g_new (guint, board->size + 1);
+	rows = g_new (guint, board->size);
+	columns = g_new (guint, board->size);
+
+	for (i = 0; i < board->size + 1; i++)
+		numbers[i] = i + 1;
+	for (i = 0; i < board->size; i++)
+		rows[i] = columns[i] = i;
+
+	shuffle (numbers, board->size + 1, rand);
+	shuffle (rows, board->size, rand);
+	shuffle (columns, board->size, rand);
+
+	for (iter.x = 0; iter.x < board->size; iter.x++) {
+		for (iter.y = 0; iter.y < board->size; iter.y++) {
+			if ((board->cells[iter.x][iter.y].status & CELL_PAINTED) == FALSE)
+				board->cells[iter.x][iter.y].num = numbers[(rows[iter.y] + columns[iter.x]) % board->size];
+		}
+	}
+
+	g_free (numbers);
+	g_free (rows);
+	g_free (columns);
+}
+
+/* Make a single attempt at generating a board. Returns FALSE if the attempt
+ * painted itself into a corner and a new seed should be tried. */
+static gboolean
+generate_attempt (KuroBoard *board, GRand *rand, gboolean *accum, gboolean **horiz_accum)
+{
+	guint i, total;
+	KuroVector iter;
+	gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+	/* Generate some randomly-placed painted cells */
+	total = g_rand_int_range (rand, 0, 5) + 13; /* Total number of painted cells (between 14 and 18 inclusive) */
+	/* For the moment, I'm hardcoding the range in the number of painted
+	 * cells, and only specifying it for 8x8 grids. This will change in the
+	 * future. Bigger boards keep roughly the same density. */
+	if (board->size > RANDOM_FILL_MAX_SIZE)
+		total = total * board->size * board->size / 64;
+
+	for (i = 0; i < total; i++) {
+		/* Generate pairs of coordinates until we find one which lies between unpainted cells (or at the edge of the board) */
+		do {
+			iter.x = g_rand_int_range (rand, 0, board->size);
+			iter.y = g_rand_int_range (rand, 0, board->size);
+
+			if ((iter.y < 1 || (board->cells[iter.x][iter.y-1].status & CELL_PAINTED) == FALSE) &&
+			    (iter.y + 1u >= board->size || (board->cells[iter.x][iter.y+1].status & CELL_PAINTED) == FALSE) &&
+			    (iter.x < 1 || (board->cells[iter.x-1][iter.y].status & CELL_PAINTED) == FALSE) &&
+			    (iter.x + 1u >= board->size || (board->cells[iter.x+1][iter.y].status & CELL_PAINTED) == FALSE) &&
+			    (board->size <= RANDOM_FILL_MAX_SIZE ||
+			     would_isolate_neighbour (board, iter) == FALSE))
+				break;
+		} while (TRUE);
+
+		board->cells[iter.x][iter.y].status |= (CELL_PAINTED | CELL_SHOULD_BE_PAINTED);
+	}
+
+	KURO_PROFILER_ADD_MARK (begin, "Paint cells", NULL);
+
+	/* Check that the painted squares don't mess everything up */
+	if (kuro_check_rule2 (board) == FALSE ||
+	    kuro_check_rule3 (board) == FALSE)
+		return FALSE;
+
+	/* Fill in the squares, leaving the painted ones blank,
+	 * and making sure not to repeat any previous numbers. */
+	begin = KURO_PROFILER_CURRENT_TIME;
+	if (board->size > RANDOM_FILL_MAX_SIZE) {
+		fill_latin_square (board, rand);
+	} else if (fill_random (board, rand, accum, horiz_accum) == FALSE) {
+		KURO_PROFILER_ADD_MARK (begin, "Fill numbers", "Failed");
+		return FALSE; /* We're buggered */
+	}
+	KURO_PROFILER_ADD_MARK (begin, "Fill numbers", NULL);
 
 	/* Fill in the painted squares, making sure they duplicate a number
 	 * already in the column/row. */
-	for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
-		for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-			if (kuro->board[iter.x][iter.y].status & CELL_PAINTED) {
+	begin = KURO_PROFILER_CURRENT_TIME;
+	for (iter.x = 0; iter.x < board->size; iter.x++) {
+		for (iter.y = 0; iter.y < board->size; iter.y++) {
+			if (board->cells[iter.x][iter.y].status & CELL_PAINTED) {
 				do {
-					i = rand () % kuro->board_size;
+					i = g_rand_int_range (rand, 0, board->size);
 					if (iter.x > iter.y)
-						total = kuro->board[iter.x][i].num; /* Take a number from the row */
+						total = board->cells[iter.x][i].num; /* Take a number from the row */
 					else
-						total = kuro->board[i][iter.y].num; /* Take a number from the column */
+						total = board->cells[i][iter.y].num; /* Take a number from the column */
 				} while (total == 0);
 
-				kuro->board[iter.x][iter.y].num = total;
-				kuro->board[iter.x][iter.y].status &= (~CELL_PAINTED & ~CELL_ERROR);
+				board->cells[iter.x][iter.y].num = total;
+				board->cells[iter.x][iter.y].status &= (~CELL_PAINTED & ~CELL_ERROR);
 			}
 		}
 	}
+	KURO_PROFILER_ADD_MARK (begin, "Fill painted cells", NULL);
+
+	return TRUE;
+}
+
+/* How many attempts are made on the calling thread before others are asked to
+ * help, as most boards come out within the first few */
+#define SPECULATION_DELAY 4
+
+/* What one thread needs to make attempts at a board */
+typedef struct {
+	KuroBoard *board;
+	GRand *rand;
+	gboolean *accum;
+	gboolean **horiz_accum;
+} Generation;
+
+/* Attempts shared out between threads. Attempt n uses the seed after n failed
+ * ones, and the board kept is the lowest attempt which worked, so it's the
+ * same board whichever thread got there first. */
+typedef struct {
+	GMutex lock;
+	guint board_size;
+	guint seed;
+	gboolean debug;
+	guint next; /* the next attempt to be handed out */
+	guint found; /* the lowest attempt which worked so far, or G_MAXUINT */
+	guint attempts;
+	KuroBoard *board; /* the board from attempt @found */
+} Speculation;
+
+typedef struct {
+	GThread *thread;
+	Speculation *speculation;
+	Generation generation;
+} Helper;
+
+static void
+generation_init (Generation *generation, guint board_size)
+{
+	guint i;
+
+	generation->board = NULL;
+	generation->rand = g_rand_new ();
+	generation->accum = g_new0 (gboolean, board_size + 2); /* Stores which numbers have been used in the current column */
+	generation->horiz_accum = g_new (gboolean*, board_size); /* Stores which numbers have been used in each row */
+	for (i = 0; i < board_size; i++)
+		generation->horiz_accum[i] = g_slice_alloc0 (sizeof (gboolean) * (board_size + 2));
+}
+
+static void
+generation_clear (Generation *generation, guint board_size)
+{
+	guint i;
+
+	if (generation->board != NULL)
+		kuro_board_free (generation->board);
+	g_free (generation->accum);
+	for (i = 0; i < board_size; i++)
+		g_slice_free1 (sizeof (gboolean) * (board_size + 2), generation->horiz_accum[i]);
+	g_free (generation->horiz_accum);
+	g_rand_free (generation->rand);
+}
+
+/* Keep making attempts until one before @last, or before one which has
+ * already worked, is no longer left to try */
+static void
+speculate (Speculation *speculation, Generation *generation, guint last)
+{
+	for (;;) {
+		KuroBoard *board;
+		guint index;
+
+		g_mutex_lock (&speculation->lock);
+		if (speculation->next >= last || speculation->next >= speculation->found) {
+			g_mutex_unlock (&speculation->lock);
+			break;
+		}
+		index = speculation->next++;
+		speculation->attempts++;
+		g_mutex_unlock (&speculation->lock);
+
+		if (generation->board == NULL) {
+			generation->board = kuro_board_new (speculation->board_size);
+			generation->board->debug = speculation->debug;
+		}
+
+		g_rand_set_seed (generation->rand, speculation->seed + index);
+		kuro_board_clear (generation->board);
+
+		if (generate_attempt (generation->board, generation->rand,
+		                      generation->accum, generation->horiz_accum) == FALSE)
+			continue;
+
+		/* Swap it for any later board which worked */
+		g_mutex_lock (&speculation->lock);
+		if (index < speculation->found) {
+			speculation->found = index;
+			board = speculation->board;
+			speculation->board = generation->board;
+			generation->board = board;
+		}
+		g_mutex_unlock (&speculation->lock);
+	}
+}
+
+static gpointer
+helper_thread (gpointer user_data)
+{
+	Helper *helper = user_data;
+
+	speculate (helper->speculation, &helper->generation, G_MAXUINT);
+
+	return NULL;
+}
+
+/* Generate a new board without touching any UI state. This only uses its own
+ * random number generator, so it's safe to call from several threads at once. */
+KuroBoard *
+kuro_generator_new_board (guint board_size, guint seed, gboolean debug)
+{
+	return kuro_generator_new_board_speculative (board_size, seed, 1, debug);
+}
+
+/* Generate a new board as kuro_generator_new_board() does, but once the first
+ * few attempts have failed, make the next ones on @n_threads threads at once
+ * (or one per processor if it's 0). The board is the same as the one
+ * kuro_generator_new_board() gives for @seed. */
+KuroBoard *
+kuro_generator_new_board_speculative (guint board_size, guint seed, guint n_threads, gboolean debug)
+{
+	Speculation speculation;
+	Generation generation;
+	Helper *helpers = NULL;
+	KuroBoard *board;
+	guint i;
+	gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+	g_return_val_if_fail (board_size > 0, NULL);
+
+	/* Seed the random number generator */
+	if (seed == 0)
+		seed = g_get_real_time ();
+
+	if (debug)
+		g_debug ("Seed value: %u", seed);
+
+	if (n_threads == 0)
+		n_threads = g_get_num_processors ();
+
+	g_mutex_init (&speculation.lock);
+	speculation.board_size = board_size;
+	speculation.seed = seed;
+	speculation.debug = debug;
+	speculation.next = 0;
+	speculation.found = G_MAXUINT;
+	speculation.attempts = 0;
+	speculation.board = NULL;
+
+	generation_init (&generation, board_size);
+
+	/* Keep trying successive seeds until one of them works out, with help
+	 * if it's slow going */
+	speculate (&speculation, &generation, SPECULATION_DELAY);
+	if (speculation.board == NULL && n_threads > 1) {
+		helpers = g_new (Helper, n_threads - 1);
+		for (i = 0; i < n_threads - 1; i++) {
+			helpers[i].speculation = &speculation;
+			generation_init (&helpers[i].generation, board_size);
+			helpers[i].thread = g_thread_new ("kuro-generator", helper_thread, &helpers[i]);
+		}
+	}
+	speculate (&speculation, &generation, G_MAXUINT);
+
+	if (helpers != NULL) {
+		for (i = 0; i < n_threads - 1; i++) {
+			g_thread_join (helpers[i].thread);
+			generation_clear (&helpers[i].generation, board_size);
+		}
+		g_free (helpers);
+	}
+	generation_clear (&generation, board_size);
+	g_mutex_clear (&speculation.lock);
+
+	board = speculation.board;
+	board->seed = seed + speculation.found;
+	kuro_board_rehash (board);
+
+	KURO_PROFILER_SET_COUNTER (KURO_PROFILER_COUNTER_GENERATION_ATTEMPTS, speculation.found + 1);
+	KURO_PROFILER_ADD_MARK_PRINTF (begin, "Generate board", "%u×%u, %u attempts, %u made", board_size, board_size,
+	                               speculation.found + 1, speculation.attempts);
+
+	return board;
+}
+
+struct _KuroGeneratorJob {
+	GThread *thread;
+	guint board_size;
+	guint seed;
+	gboolean debug;
+	KuroBoard *board;
+	gint64 generation_time;
+};
+
+static gpointer
+generate_board_thread (gpointer user_data)
+{
+	KuroGeneratorJob *job = user_data;
+	gint64 start = g_get_monotonic_time ();
+
+	job->board = kuro_generator_new_board_speculative (job->board_size, job->seed, 0, job->debug);
+	job->generation_time = g_get_monotonic_time () - start;
+
+	return NULL;
+}
+
+/* Start generating a board on another thread, so that the caller can get on
+ * with something else in the meantime. The board must be collected with
+ * kuro_generator_end_board(). */
+KuroGeneratorJob *
+kuro_generator_begin_board (guint board_size, guint seed, gboolean debug)
+{
+	KuroGeneratorJob *job;
+
+	g_return_val_if_fail (board_size > 0, NULL);
+
+	job = g_new0 (KuroGeneratorJob, 1);
+	job->board_size = board_size;
+	job->seed = seed;
+	job->debug = debug;
+	job->thread = g_thread_new ("kuro-generator", generate_board_thread, job);
+
+	return job;
+}
+
+/* Wait for the board to be finished, and free @job. The time spent
+ * generating it, in µs, is returned in @generation_time. */
+KuroBoard *
+kuro_generator_end_board (KuroGeneratorJob *job, gint64 *generation_time)
+{
+	KuroBoard *board;
+
+	g_return_val_if_fail (job != NULL, NULL);
+
+	g_thread_join (job->thread);
+	board = job->board;
+	if (generation_time != NULL)
+		*generation_time = job->generation_time;
+	g_free (job);
 
-	/* Update things */
-	kuro_enable_events (kuro);
+	return board;
 }
@@ -19,13 +19,37 @@
 
 #include <glib.h>
 
+#include "board.h"
+
 #ifndef KURO_GENERATOR_H
 #define KURO_GENERATOR_H
 
 G_BEGIN_DECLS
-typedef struct _KuroApplication Kuro;
 
-void kuro_generate_board(Kuro *kuro, guint new_board_size, guint seed);
+/* How many solutions a candidate board has, as far as can be told */
+typedef enum {
+  KURO_UNIQUENESS_UNKNOWN,
+  KURO_UNIQUENESS_NONE,
+  KURO_UNIQUENESS_UNIQUE,
+  KURO_UNIQUENESS_MULTIPLE
+} KuroUniqueness;
+
+guint kuro_generator_derive_seed(guint seed, guint index);
+KuroUniqueness kuro_generator_check_uniqueness(const KuroBoard *board);
+KuroBoard *kuro_generator_new_board(guint board_size, guint seed,
+                                    gboolean debug) G_GNUC_WARN_UNUSED_RESULT;
+KuroBoard *kuro_generator_new_board_speculative(guint board_size, guint seed,
+                                                guint n_threads, gboolean debug)
+    G_GNUC_WARN_UNUSED_RESULT;
+
+typedef struct _KuroGeneratorJob KuroGeneratorJob;
+
+KuroGeneratorJob *kuro_generator_begin_board(guint board_size, guint seed,
+                                             gboolean debug)
+    G_GNUC_WARN_UNUSED_RESULT;
+KuroBoard *kuro_generator_end_board(KuroGeneratorJob *job,
+                                    gint64 *generation_time)
+    G_GNUC_WARN_UNUSED_RESULT;
 
 G_END_DECLS
 
@@ -0,0 +1,199 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "hint-worker.h"
+
+typedef struct {
+  GSource source;
+  KuroHintWorker *worker;
+} WorkerSource;
+
+struct _KuroHintWorker {
+  KuroHintWorkerFunc func;
+  gpointer user_data;
+
+  GThread *thread;
+  GMutex lock; /* for everything below */
+  GCond cond;
+  gboolean quit;
+
+  /* The worker's copy of the board, which only it touches while busy */
+  KuroBoard *board;
+  guint64 key;
+  gboolean pending; /* copied in, and waiting to be worked out */
+  gboolean busy;
+  GCancellable *cancellable; /* reset each time the worker isn't busy */
+
+  /* The board being played, to copy again once the worker's done, if it's
+   * changed while the worker was busy */
+  const KuroBoard *latest;
+  gboolean stale;
+
+  /* Wakes the main context once a hint's been worked out */
+  GSource *source;
+  gboolean done;
+  guint64 done_key;
+  KuroHint hint;
+  gboolean found;
+};
+
+static gpointer worker_thread(gpointer user_data) {
+  KuroHintWorker *worker = user_data;
+
+  g_mutex_lock(&worker->lock);
+
+  while (TRUE) {
+    KuroHint hint;
+    gboolean found;
+
+    while (!worker->pending && !worker->quit)
+      g_cond_wait(&worker->cond, &worker->lock);
+    if (worker->quit)
+      break;
+
+    worker->pending = FALSE;
+    worker->busy = TRUE;
+    g_mutex_unlock(&worker->lock);
+
+    found = kuro_hint_find_cancellable(worker->board, &hint,
+                                       worker->cancellable);
+
+    g_mutex_lock(&worker->lock);
+    worker->busy = FALSE;
+    if (!g_cancellable_is_cancelled(worker->cancellable)) {
+      worker->done = TRUE;
+      worker->done_key = worker->key;
+      worker->hint = hint;
+      worker->found = found;
+    }
+
+    /* Either way, the main context decides what's next */
+    g_source_set_ready_time(worker->source, 0);
+  }
+
+  g_mutex_unlock(&worker->lock);
+
+  return NULL;
+}
+
+/* Hand @board to the worker, if it's free. Called with the lock held. */
+static void start(KuroHintWorker *worker, const KuroBoard *board) {
+  if (worker->busy) {
+    g_cancellable_cancel(worker->cancellable);
+    worker->stale = TRUE;
+    return;
+  }
+
+  /* The board's only reallocated when a game of another size starts */
+  if (worker->board == NULL || worker->board->size != board->size) {
+    kuro_board_free(worker->board);
+    worker->board = kuro_board_new(board->size);
+  }
+
+  kuro_board_copy_into(worker->board, board);
+  worker->key = kuro_board_hash(board);
+  worker->pending = TRUE;
+  worker->stale = FALSE;
+  worker->done = FALSE;
+  g_cancellable_reset(worker->cancellable);
+  g_cond_signal(&worker->cond);
+}
+
+static gboolean source_dispatch(GSource *source, GSourceFunc callback,
+                                gpointer user_data) {
+  KuroHintWorker *worker = ((WorkerSource *)source)->worker;
+  gboolean done;
+  guint64 key;
+  KuroHint hint;
+  gboolean found;
+
+  g_source_set_ready_time(source, -1);
+
+  g_mutex_lock(&worker->lock);
+  if (worker->stale)
+    start(worker, worker->latest);
+  done = worker->done;
+  worker->done = FALSE;
+  key = worker->done_key;
+  hint = worker->hint;
+  found = worker->found;
+  g_mutex_unlock(&worker->lock);
+
+  if (done)
+    worker->func(key, &hint, found, worker->user_data);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs source_funcs = {NULL, NULL, source_dispatch, NULL,
+                                    NULL, NULL};
+
+/* @func is called in the thread-default main context of the caller */
+KuroHintWorker *kuro_hint_worker_new(KuroHintWorkerFunc func,
+                                     gpointer user_data) {
+  KuroHintWorker *worker = g_new0(KuroHintWorker, 1);
+
+  worker->func = func;
+  worker->user_data = user_data;
+  g_mutex_init(&worker->lock);
+  g_cond_init(&worker->cond);
+  worker->cancellable = g_cancellable_new();
+
+  worker->source = g_source_new(&source_funcs, sizeof(WorkerSource));
+  ((WorkerSource *)worker->source)->worker = worker;
+  g_source_set_name(worker->source, "Kuro hint worker");
+  g_source_attach(worker->source, g_main_context_get_thread_default());
+
+  worker->thread = g_thread_new("hint", worker_thread, worker);
+
+  return worker;
+}
+
+void kuro_hint_worker_free(KuroHintWorker *worker) {
+  if (worker == NULL)
+    return;
+
+  g_mutex_lock(&worker->lock);
+  worker->quit = TRUE;
+  g_cancellable_cancel(worker->cancellable);
+  g_cond_signal(&worker->cond);
+  g_mutex_unlock(&worker->lock);
+  g_thread_join(worker->thread);
+
+  g_source_destroy(worker->source);
+  g_source_unref(worker->source);
+  g_object_unref(worker->cancellable);
+  kuro_board_free(worker->board);
+  g_mutex_clear(&worker->lock);
+  g_cond_clear(&worker->cond);
+  g_free(worker);
+}
+
+/* Start working out the hint for @board, which has just changed, giving up
+ * on any hint still being worked out for it as it was. @board has to stay
+ * around until it's next queued, or the worker's freed. */
+void kuro_hint_worker_queue(KuroHintWorker *worker, const KuroBoard *board) {
+  g_mutex_lock(&worker->lock);
+  worker->latest = board;
+  start(worker, board);
+  g_mutex_unlock(&worker->lock);
+}
@@ -0,0 +1,48 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_HINT_WORKER_H
+#define KURO_HINT_WORKER_H
+
+#include <glib.h>
+
+#include "board.h"
+#include "hint.h"
+
+G_BEGIN_DECLS
+
+/* Works out the next hint for the board being played in a thread of its
+ * own, so that asking for one is just a lookup. It keeps its own copy of the
+ * board and one thread for the whole game, so a move doesn't allocate. */
+typedef struct _KuroHintWorker KuroHintWorker;
+
+/* Called in the main context with the hint for the position with
+ * kuro_board_hash() @key */
+typedef void (*KuroHintWorkerFunc)(guint64 key, const KuroHint *hint,
+                                   gboolean found, gpointer user_data);
+
+KuroHintWorker *kuro_hint_worker_new(KuroHintWorkerFunc func,
+                                     gpointer user_data)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_hint_worker_free(KuroHintWorker *worker);
+void kuro_hint_worker_queue(KuroHintWorker *worker, const KuroBoard *board);
+
+G_END_DECLS
+
+#endif /* KURO_HINT_WORKER_H */
@@ -0,0 +1,517 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "count.h"
+#include "hint.h"
+#include "profiler.h"
+
+/* Hints are worked out the way a player would, from the painted cells and
+ * the rules, by deciding which other cells have to be painted (black) or left
+ * unpainted (white). Only black cells are ever hinted, as there's no way to
+ * mark a cell as white; white cells just feed the deductions. */
+
+/* How many cells a hint can look at, over every technique, before it stops
+ * deducing and falls back to the solution. Connectivity floods the board once
+ * per cell, and contradiction follows the basic rules from every cell, so on
+ * big boards they'd take minutes otherwise. */
+#define HINT_MAX_WORK 10000000
+
+/* How long the solver can look for a solution which keeps the painted cells
+ * painted, when nothing can be deduced from them */
+#define HINT_MAX_CONFLICTS 10000
+
+typedef enum { STATE_UNKNOWN, STATE_WHITE, STATE_BLACK } CellState;
+
+typedef struct {
+  const KuroBoard *board;
+  guint size;
+  guchar *state;     /* CellState of each cell, indexed as [x * size + y] */
+  guchar *technique; /* the KuroHintTechnique which decided each cell */
+  guint *stack;      /* flood fill frontier */
+  gboolean *reached;
+  gboolean contradiction;
+  gint64 budget; /* cells left to look at, out of HINT_MAX_WORK */
+  GCancellable *cancellable; /* or NULL */
+} Deduction;
+
+typedef gboolean (*TechniqueFunc)(Deduction *deduction);
+
+static guint cell_number(const Deduction *d, guint cell) {
+  return d->board->cells[cell / d->size][cell % d->size].num;
+}
+
+static void deduction_init(Deduction *d, const KuroBoard *board) {
+  guint n_cells = board->size * board->size;
+
+  d->board = board;
+  d->size = board->size;
+  d->state = g_new(guchar, n_cells);
+  d->technique = g_new(guchar, n_cells);
+  d->stack = g_new(guint, n_cells);
+  d->reached = g_new(gboolean, n_cells);
+  d->contradiction = FALSE;
+  d->budget = HINT_MAX_WORK;
+  d->cancellable = NULL;
+}
+
+static void deduction_copy(Deduction *dest, const Deduction *src) {
+  guint n_cells = src->size * src->size;
+
+  memcpy(dest->state, src->state, n_cells);
+  memcpy(dest->technique, src->technique, n_cells);
+  dest->contradiction = src->contradiction;
+  dest->budget = src->budget;
+}
+
+/* Whether to stop deducing, having run out of work or been cancelled */
+static gboolean should_stop(const Deduction *d) {
+  return d->budget <= 0 || g_cancellable_is_cancelled(d->cancellable);
+}
+
+static void deduction_clear(Deduction *d) {
+  g_free(d->state);
+  g_free(d->technique);
+  g_free(d->stack);
+  g_free(d->reached);
+}
+
+/* Decide @cell, noting a contradiction if it's already been decided the
+ * other way. Returns whether anything changed. */
+static gboolean decide(Deduction *d, guint cell, CellState state,
+                       KuroHintTechnique technique) {
+  if (d->state[cell] == state)
+    return FALSE;
+
+  if (d->state[cell] != STATE_UNKNOWN) {
+    d->contradiction = TRUE;
+    return FALSE;
+  }
+
+  d->state[cell] = state;
+  d->technique[cell] = technique;
+  return TRUE;
+}
+
+/* Whether the cells which aren't black are all joined together (rule 3) */
+static gboolean is_connected(Deduction *d) {
+  guint n_cells = d->size * d->size, n_stack = 0, n_reached = 0, n_open = 0;
+  guint cell;
+
+  d->budget -= n_cells;
+  memset(d->reached, 0, sizeof(gboolean) * n_cells);
+
+  for (cell = 0; cell < n_cells; cell++) {
+    if (d->state[cell] == STATE_BLACK)
+      continue;
+    if (n_open++ == 0) {
+      d->reached[cell] = TRUE;
+      d->stack[n_stack++] = cell;
+    }
+  }
+
+  while (n_stack > 0) {
+    guint neighbours[4], n_neighbours = 0, i;
+
+    cell = d->stack[--n_stack];
+    n_reached++;
+
+    if (cell >= d->size)
+      neighbours[n_neighbours++] = cell - d->size;
+    if (cell + d->size < n_cells)
+      neighbours[n_neighbours++] = cell + d->size;
+    if (cell % d->size > 0)
+      neighbours[n_neighbours++] = cell - 1;
+    if (cell % d->size < d->size - 1)
+      neighbours[n_neighbours++] = cell + 1;
+
+    for (i = 0; i < n_neighbours; i++) {
+      if (!d->reached[neighbours[i]] &&
+          d->state[neighbours[i]] != STATE_BLACK) {
+        d->reached[neighbours[i]] = TRUE;
+        d->stack[n_stack++] = neighbours[i];
+      }
+    }
+  }
+
+  return n_reached == n_open;
+}
+
+/* Rules 1 and 2 directly: cells next to black cells are white, cells
+ * repeating a white cell's number in its row or column are black, and cells
+ * whose number isn't repeated at all are white (painting one could never be
+ * needed). Runs until nothing more follows. */
+static gboolean apply_basic(Deduction *d) {
+  guint size = d->size, x, y, i;
+  gboolean changed, any_changed = FALSE;
+
+  do {
+    changed = FALSE;
+
+    if (should_stop(d))
+      break;
+    d->budget -= (gint64)size * size * 2 * size;
+
+    for (x = 0; x < size; x++) {
+      for (y = 0; y < size; y++) {
+        guint cell = x * size + y, num = cell_number(d, cell);
+        KuroHintTechnique technique =
+            MAX(KURO_HINT_REPEATED, d->technique[cell]);
+        gboolean repeated = FALSE;
+
+        for (i = 0; i < size; i++) {
+          guint other_cells[2] = {i * size + y, x * size + i};
+          guint j;
+
+          for (j = 0; j < 2; j++) {
+            guint other = other_cells[j];
+
+            if (other == cell || cell_number(d, other) != num)
+              continue;
+            repeated = TRUE;
+
+            if (d->state[cell] == STATE_WHITE)
+              changed |= decide(d, other, STATE_BLACK, technique);
+          }
+        }
+
+        if (d->state[cell] == STATE_BLACK) {
+          if (x > 0)
+            changed |= decide(d, cell - size, STATE_WHITE, technique);
+          if (x < size - 1)
+            changed |= decide(d, cell + size, STATE_WHITE, technique);
+          if (y > 0)
+            changed |= decide(d, cell - 1, STATE_WHITE, technique);
+          if (y < size - 1)
+            changed |= decide(d, cell + 1, STATE_WHITE, technique);
+        } else if (!repeated) {
+          changed |= decide(d, cell, STATE_WHITE, KURO_HINT_REPEATED);
+        }
+
+        if (d->contradiction)
+          return any_changed;
+      }
+    }
+
+    any_changed |= changed;
+  } while (changed);
+
+  return any_changed;
+}
+
+/* Look along every row and column for three cells starting at @first,
+ * @step apart. In "a b a" the middle cell is white, as painting it would
+ * leave both a's white. In "a a a" the middle one is white for the same
+ * reason, so the outer ones are black. */
+static gboolean apply_sandwich(Deduction *d) {
+  guint size = d->size, line, i, dir;
+  gboolean changed = FALSE;
+
+  d->budget -= (gint64)size * size * 2;
+
+  for (dir = 0; dir < 2; dir++) {
+    for (line = 0; line < size; line++) {
+      for (i = 0; i + 2 < size; i++) {
+        guint a = (dir == 0) ? i * size + line : line * size + i;
+        guint step = (dir == 0) ? size : 1;
+        guint b = a + step, c = b + step;
+
+        if (cell_number(d, a) != cell_number(d, c))
+          continue;
+
+        changed |= decide(d, b, STATE_WHITE, KURO_HINT_SANDWICH);
+        if (cell_number(d, a) == cell_number(d, b)) {
+          changed |= decide(d, a, STATE_BLACK, KURO_HINT_SANDWICH);
+          changed |= decide(d, c, STATE_BLACK, KURO_HINT_SANDWICH);
+        }
+      }
+    }
+  }
+
+  return changed;
+}
+
+/* Two adjacent cells with the same number can't both be painted, so one of
+ * them is white and every other copy of the number in their line is black */
+static gboolean apply_pair(Deduction *d) {
+  guint size = d->size, line, i, j, dir;
+  gboolean changed = FALSE;
+
+  d->budget -= (gint64)size * size * 2;
+
+  for (dir = 0; dir < 2; dir++) {
+    for (line = 0; line < size; line++) {
+      guint step = (dir == 0) ? size : 1;
+      guint start = (dir == 0) ? line : line * size;
+
+      for (i = 0; i + 1 < size; i++) {
+        guint a = start + i * step, num = cell_number(d, a);
+
+        if (cell_number(d, a + step) != num)
+          continue;
+
+        for (j = 0; j < size; j++) {
+          guint other = start + j * step;
+
+          if (j != i && j != i + 1 && cell_number(d, other) == num)
+            changed |= decide(d, other, STATE_BLACK, KURO_HINT_PAIR);
+        }
+      }
+    }
+  }
+
+  return changed;
+}
+
+/* Rule 3: a cell which would cut the board in two if it were painted is
+ * white */
+static gboolean apply_connectivity(Deduction *d) {
+  guint n_cells = d->size * d->size, cell;
+  gboolean changed = FALSE;
+
+  for (cell = 0; cell < n_cells && !should_stop(d); cell++) {
+    if (d->state[cell] != STATE_UNKNOWN)
+      continue;
+
+    d->state[cell] = STATE_BLACK;
+    if (!is_connected(d)) {
+      d->state[cell] = STATE_UNKNOWN;
+      changed |= decide(d, cell, STATE_WHITE, KURO_HINT_CONNECTIVITY);
+    } else {
+      d->state[cell] = STATE_UNKNOWN;
+    }
+  }
+
+  return changed;
+}
+
+/* Try each undecided cell both ways, following the basic rules from it. If
+ * one way breaks a rule, the cell must be the other way. */
+static gboolean apply_contradiction(Deduction *d) {
+  Deduction trial;
+  guint n_cells = d->size * d->size, cell;
+  gboolean changed = FALSE;
+
+  deduction_init(&trial, d->board);
+  trial.cancellable = d->cancellable;
+
+  for (cell = 0; cell < n_cells && !d->contradiction && !should_stop(d);
+       cell++) {
+    static const CellState guesses[] = {STATE_WHITE, STATE_BLACK};
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(guesses); i++) {
+      gboolean broken;
+
+      if (d->state[cell] != STATE_UNKNOWN)
+        break;
+
+      deduction_copy(&trial, d);
+      trial.state[cell] = guesses[i];
+      apply_basic(&trial);
+      broken = trial.contradiction || !is_connected(&trial);
+
+      /* The trial's work counts towards the hint's, along with copying */
+      d->budget = trial.budget - (gint64)n_cells * 2;
+
+      if (broken) {
+        changed |= decide(d, cell,
+                          (guesses[i] == STATE_WHITE) ? STATE_BLACK
+                                                      : STATE_WHITE,
+                          KURO_HINT_CONTRADICTION);
+        apply_basic(d);
+      }
+    }
+  }
+
+  deduction_clear(&trial);
+
+  return changed;
+}
+
+/* Cheapest first */
+static const TechniqueFunc techniques[] = {
+    apply_basic, apply_sandwich, apply_pair, apply_connectivity,
+    apply_contradiction,
+};
+
+/* The cheapest black cell which has been deduced but not painted yet */
+static gboolean find_deduced_cell(const Deduction *d, KuroHint *hint) {
+  guint n_cells = d->size * d->size, cell;
+  gboolean found = FALSE;
+
+  for (cell = 0; cell < n_cells; cell++) {
+    guint x = cell / d->size, y = cell % d->size;
+
+    if (d->state[cell] != STATE_BLACK ||
+        d->board->cells[x][y].status & CELL_PAINTED)
+      continue;
+
+    if (!found || d->technique[cell] < hint->technique) {
+      hint->cell.x = (guint16)x;
+      hint->cell.y = (guint16)y;
+      hint->technique = d->technique[cell];
+      found = TRUE;
+    }
+  }
+
+  return found;
+}
+
+/* Fall back to the solution marked on @board: point out a wrongly painted
+ * cell for KURO_HINT_MISTAKE, or reveal a missing one for
+ * KURO_HINT_SOLUTION */
+static gboolean find_solution_cell(const KuroBoard *board, KuroHint *hint,
+                                   KuroHintTechnique technique) {
+  guchar wanted =
+      (technique == KURO_HINT_MISTAKE) ? CELL_PAINTED : CELL_SHOULD_BE_PAINTED;
+  KuroVector iter;
+
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      guchar status = board->cells[iter.x][iter.y].status &
+                      (CELL_PAINTED | CELL_SHOULD_BE_PAINTED);
+
+      if (status == wanted) {
+        hint->cell = iter;
+        hint->technique = technique;
+        return TRUE;
+      }
+    }
+  }
+
+  return FALSE;
+}
+
+/* Nothing more can be deduced, but the painted cells needn't be wrong: boards
+ * usually have more than one solution, and the player may be on another one
+ * than the board came with. Reveal a cell of a solution which keeps them
+ * painted, and only call one a mistake if there isn't any. */
+static gboolean find_solved_cell(const KuroBoard *board, KuroHint *hint) {
+  KuroBoard *solved;
+  guint64 n_solutions;
+  gboolean found;
+
+  if (!find_solution_cell(board, hint, KURO_HINT_MISTAKE))
+    return find_solution_cell(board, hint, KURO_HINT_SOLUTION);
+
+  solved = kuro_board_copy(board);
+  if (!kuro_count_solve(solved, 1, HINT_MAX_CONFLICTS, &n_solutions))
+    found = find_solution_cell(board, hint, KURO_HINT_SOLUTION);
+  else if (n_solutions > 0)
+    found = find_solution_cell(solved, hint, KURO_HINT_SOLUTION);
+  else
+    found = find_solution_cell(board, hint, KURO_HINT_MISTAKE);
+
+  kuro_board_free(solved);
+
+  return found;
+}
+
+/* Find the next cell the player should paint, and how it follows from the
+ * cells they've painted so far. Returns FALSE if there's nothing left to
+ * paint. */
+gboolean kuro_hint_find(const KuroBoard *board, KuroHint *hint) {
+  return kuro_hint_find_cancellable(board, hint, NULL);
+}
+
+/* As kuro_hint_find(), but giving up early once @cancellable is cancelled, in
+ * which case @hint is meaningless */
+gboolean kuro_hint_find_cancellable(const KuroBoard *board, KuroHint *hint,
+                                    GCancellable *cancellable) {
+  Deduction d;
+  KuroVector iter;
+  gboolean found = FALSE, broken = FALSE;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  deduction_init(&d, board);
+  d.cancellable = cancellable;
+
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      guint cell = iter.x * board->size + iter.y;
+
+      d.state[cell] = (board->cells[iter.x][iter.y].status & CELL_PAINTED)
+                          ? STATE_BLACK
+                          : STATE_UNKNOWN;
+      d.technique[cell] = KURO_HINT_NONE;
+    }
+  }
+
+  /* Retry from the cheapest technique after every deduction, until a new
+   * black cell turns up or nothing more can be deduced */
+  while (!found) {
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(techniques); i++)
+      if (techniques[i](&d) || d.contradiction)
+        break;
+
+    if (d.contradiction || !is_connected(&d)) {
+      /* The painted cells break the rules somewhere down the line */
+      found = find_solution_cell(board, hint, KURO_HINT_MISTAKE);
+      broken = TRUE;
+      break;
+    }
+
+    found = find_deduced_cell(&d, hint);
+    if (i == G_N_ELEMENTS(techniques) || should_stop(&d))
+      break;
+  }
+
+  if (!found && !broken && !g_cancellable_is_cancelled(cancellable))
+    found = find_solved_cell(board, hint);
+  if (!found)
+    found = find_solution_cell(board, hint, KURO_HINT_SOLUTION);
+
+  deduction_clear(&d);
+
+  KURO_PROFILER_ADD_MARK(begin, "Hint",
+                         found ? kuro_hint_technique_name(hint->technique)
+                               : "None");
+
+  return found;
+}
+
+/* A short, untranslated name for @technique, for debugging and benchmarks */
+const gchar *kuro_hint_technique_name(KuroHintTechnique technique) {
+  switch (technique) {
+  case KURO_HINT_NONE:
+    return "none";
+  case KURO_HINT_REPEATED:
+    return "repeated";
+  case KURO_HINT_SANDWICH:
+    return "sandwich";
+  case KURO_HINT_PAIR:
+    return "pair";
+  case KURO_HINT_CONNECTIVITY:
+    return "connectivity";
+  case KURO_HINT_CONTRADICTION:
+    return "contradiction";
+  case KURO_HINT_SOLUTION:
+    return "solution";
+  case KURO_HINT_MISTAKE:
+    return "mistake";
+  default:
+    g_assert_not_reached();
+    return NULL;
+  }
+}
@@ -0,0 +1,55 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_HINT_H
+#define KURO_HINT_H
+
+#include <gio/gio.h>
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+/* How a hinted cell was worked out, cheapest first. A deduction which builds
+ * on others is named after the most expensive technique it needed. */
+typedef enum {
+  KURO_HINT_NONE,
+  KURO_HINT_REPEATED,      /* repeats a number which has to stay unpainted */
+  KURO_HINT_SANDWICH,      /* from a number between or beside its twins */
+  KURO_HINT_PAIR,          /* repeats the number of an adjacent pair */
+  KURO_HINT_CONNECTIVITY,  /* from cells which would cut the board in two */
+  KURO_HINT_CONTRADICTION, /* leaving it unpainted leads to a contradiction */
+  KURO_HINT_SOLUTION,      /* nothing could be deduced, so it's revealed */
+  KURO_HINT_MISTAKE        /* painted, but it can't be */
+} KuroHintTechnique;
+
+typedef struct {
+  KuroVector cell;
+  KuroHintTechnique technique;
+} KuroHint;
+
+gboolean kuro_hint_find(const KuroBoard *board, KuroHint *hint);
+gboolean kuro_hint_find_cancellable(const KuroBoard *board, KuroHint *hint,
+                                    GCancellable *cancellable);
+const gchar *kuro_hint_technique_name(KuroHintTechnique technique);
+
+G_END_DECLS
+
+#endif /* KURO_HINT_H */
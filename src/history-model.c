@@ -0,0 +1,164 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib-object.h>
+
+#include "history-model.h"
+
+struct _KuroHistoryItem {
+  GObject parent;
+  KuroHistoryRecord record;
+};
+
+enum {
+  PROP_FINISHED = 1,
+  PROP_BOARD_SIZE,
+  PROP_TIME_MS,
+  PROP_MOVES,
+  PROP_HINTS,
+  N_ITEM_PROPS
+};
+
+static GParamSpec *item_props[N_ITEM_PROPS] = {NULL};
+
+G_DEFINE_FINAL_TYPE(KuroHistoryItem, kuro_history_item, G_TYPE_OBJECT)
+
+static void kuro_history_item_get_property(GObject *object, guint property_id,
+                                           GValue *value, GParamSpec *pspec) {
+  KuroHistoryItem *self = KURO_HISTORY_ITEM(object);
+
+  switch (property_id) {
+  case PROP_FINISHED:
+    g_value_set_int64(value, self->record.finished);
+    break;
+  case PROP_BOARD_SIZE:
+    g_value_set_uint(value, self->record.board_size);
+    break;
+  case PROP_TIME_MS:
+    g_value_set_uint(value, self->record.time_ms);
+    break;
+  case PROP_MOVES:
+    g_value_set_uint(value, self->record.moves);
+    break;
+  case PROP_HINTS:
+    g_value_set_uint(value, self->record.hints);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+    break;
+  }
+}
+
+static void kuro_history_item_class_init(KuroHistoryItemClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+  gobject_class->get_property = kuro_history_item_get_property;
+
+  /* Read-only, so that they can be used in sorter expressions */
+  item_props[PROP_FINISHED] = g_param_spec_int64(
+      "finished", NULL, NULL, G_MININT64, G_MAXINT64, 0,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_BOARD_SIZE] =
+      g_param_spec_uint("board-size", NULL, NULL, 0, G_MAXUINT8, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_TIME_MS] =
+      g_param_spec_uint("time-ms", NULL, NULL, 0, G_MAXUINT32, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_MOVES] =
+      g_param_spec_uint("moves", NULL, NULL, 0, G_MAXUINT32, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_HINTS] =
+      g_param_spec_uint("hints", NULL, NULL, 0, G_MAXUINT16, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties(gobject_class, N_ITEM_PROPS, item_props);
+}
+
+static void kuro_history_item_init(KuroHistoryItem *self) {}
+
+const KuroHistoryRecord *kuro_history_item_get_record(KuroHistoryItem *item) {
+  g_return_val_if_fail(KURO_IS_HISTORY_ITEM(item), NULL);
+
+  return &item->record;
+}
+
+struct _KuroHistoryModel {
+  GObject parent;
+  GBytes *records;
+  guint n_records;
+};
+
+static GType kuro_history_model_get_item_type(GListModel *list) {
+  return KURO_TYPE_HISTORY_ITEM;
+}
+
+static guint kuro_history_model_get_n_items(GListModel *list) {
+  return KURO_HISTORY_MODEL(list)->n_records;
+}
+
+static gpointer kuro_history_model_get_item(GListModel *list, guint position) {
+  KuroHistoryModel *self = KURO_HISTORY_MODEL(list);
+  KuroHistoryItem *item;
+
+  if (position >= self->n_records)
+    return NULL;
+
+  item = g_object_new(KURO_TYPE_HISTORY_ITEM, NULL);
+  kuro_history_get_record(self->records, position, &item->record);
+
+  return item;
+}
+
+static void kuro_history_model_list_model_init(GListModelInterface *iface) {
+  iface->get_item_type = kuro_history_model_get_item_type;
+  iface->get_n_items = kuro_history_model_get_n_items;
+  iface->get_item = kuro_history_model_get_item;
+}
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(
+    KuroHistoryModel, kuro_history_model, G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL,
+                          kuro_history_model_list_model_init))
+
+static void kuro_history_model_finalize(GObject *object) {
+  KuroHistoryModel *self = KURO_HISTORY_MODEL(object);
+
+  g_bytes_unref(self->records);
+
+  G_OBJECT_CLASS(kuro_history_model_parent_class)->finalize(object);
+}
+
+static void kuro_history_model_class_init(KuroHistoryModelClass *klass) {
+  G_OBJECT_CLASS(klass)->finalize = kuro_history_model_finalize;
+}
+
+static void kuro_history_model_init(KuroHistoryModel *self) {}
+
+KuroHistoryModel *kuro_history_model_new(GBytes *records) {
+  KuroHistoryModel *self;
+
+  g_return_val_if_fail(records != NULL, NULL);
+
+  self = g_object_new(KURO_TYPE_HISTORY_MODEL, NULL);
+  self->records = g_bytes_ref(records);
+  self->n_records = g_bytes_get_size(records) / sizeof(KuroHistoryRecord);
+
+  return self;
+}
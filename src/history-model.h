@@ -0,0 +1,47 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_HISTORY_MODEL_H
+#define KURO_HISTORY_MODEL_H
+
+#include <gio/gio.h>
+#include <glib-object.h>
+
+#include "history.h"
+
+G_BEGIN_DECLS
+
+#define KURO_TYPE_HISTORY_ITEM (kuro_history_item_get_type())
+G_DECLARE_FINAL_TYPE(KuroHistoryItem, kuro_history_item, KURO, HISTORY_ITEM,
+                     GObject)
+
+const KuroHistoryRecord *kuro_history_item_get_record(KuroHistoryItem *item);
+
+/* A list model over a mapped history log. Items are created as they're asked
+ * for, so only the rows on screen exist at any one time. */
+#define KURO_TYPE_HISTORY_MODEL (kuro_history_model_get_type())
+G_DECLARE_FINAL_TYPE(KuroHistoryModel, kuro_history_model, KURO, HISTORY_MODEL,
+                     GObject)
+
+KuroHistoryModel *kuro_history_model_new(GBytes *records)
+    G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* KURO_HISTORY_MODEL_H */
@@ -0,0 +1,504 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "history.h"
+
+#define HISTORY_MAGIC "KUROHIST"
+#define HISTORY_VERSION 1
+#define STATS_MAGIC "KUROSTAT"
+#define STATS_VERSION 1
+
+typedef struct {
+  gchar magic[8];
+  guint32 version;
+  guint32 record_size;
+} HistoryHeader;
+
+/* The statistics checkpoint is only a cache, so it's kept in host byte order
+ * and simply rebuilt from the log if it doesn't match. */
+typedef struct {
+  gchar magic[8];
+  guint32 version;
+  guint32 stats_size;
+  guint64 n_records; /* records already folded into the statistics */
+} StatsHeader;
+
+G_STATIC_ASSERT(sizeof(HistoryHeader) == 16);
+G_STATIC_ASSERT(sizeof(KuroHistoryRecord) == 24);
+
+struct _KuroHistory {
+  gchar *log_path;
+  gchar *stats_path;
+  GFileIOStream *stream;
+  guint64 n_records;
+
+  /* Index 0 covers every board size */
+  KuroHistoryStats stats[MAX_BOARD_SIZE + 1];
+};
+
+static void quantile_sketch_init(KuroQuantileSketch *sketch, gdouble p) {
+  memset(sketch, 0, sizeof(KuroQuantileSketch));
+  sketch->p = p;
+}
+
+static gint compare_doubles(gconstpointer a, gconstpointer b) {
+  gdouble value_a = *(const gdouble *)a;
+  gdouble value_b = *(const gdouble *)b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void quantile_sketch_add(KuroQuantileSketch *sketch, gdouble value) {
+  gdouble *q = sketch->heights, *n = sketch->positions;
+  guint i, k;
+
+  /* The first five samples simply become the initial markers */
+  if (sketch->count < 5) {
+    q[sketch->count++] = value;
+
+    if (sketch->count == 5) {
+      gdouble p = sketch->p;
+
+      qsort(q, 5, sizeof(gdouble), compare_doubles);
+      for (i = 0; i < 5; i++)
+        n[i] = i + 1;
+
+      sketch->desired[0] = 1.0;
+      sketch->desired[1] = 1.0 + 2.0 * p;
+      sketch->desired[2] = 1.0 + 4.0 * p;
+      sketch->desired[3] = 3.0 + 2.0 * p;
+      sketch->desired[4] = 5.0;
+
+      sketch->increments[0] = 0.0;
+      sketch->increments[1] = p / 2.0;
+      sketch->increments[2] = p;
+      sketch->increments[3] = (1.0 + p) / 2.0;
+      sketch->increments[4] = 1.0;
+    }
+
+    return;
+  }
+
+  /* Find the cell the sample falls in, stretching the extremes if needed */
+  if (value < q[0]) {
+    q[0] = value;
+    k = 0;
+  } else if (value >= q[4]) {
+    q[4] = value;
+    k = 3;
+  } else {
+    for (k = 0; k < 3 && value >= q[k + 1]; k++)
+      ;
+  }
+
+  for (i = k + 1; i < 5; i++)
+    n[i] += 1.0;
+  for (i = 0; i < 5; i++)
+    sketch->desired[i] += sketch->increments[i];
+
+  /* Nudge the middle markers towards their desired positions */
+  for (i = 1; i < 4; i++) {
+    gdouble d = sketch->desired[i] - n[i];
+
+    if ((d >= 1.0 && n[i + 1] - n[i] > 1.0) ||
+        (d <= -1.0 && n[i - 1] - n[i] < -1.0)) {
+      gdouble s = (d >= 0.0) ? 1.0 : -1.0;
+      gdouble parabolic;
+
+      parabolic =
+          q[i] + s / (n[i + 1] - n[i - 1]) *
+                     ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) /
+                          (n[i + 1] - n[i]) +
+                      (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) /
+                          (n[i] - n[i - 1]));
+
+      if (q[i - 1] < parabolic && parabolic < q[i + 1]) {
+        q[i] = parabolic;
+      } else {
+        guint j = (s > 0.0) ? i + 1 : i - 1;
+        q[i] += s * (q[j] - q[i]) / (n[j] - n[i]);
+      }
+
+      n[i] += s;
+    }
+  }
+
+  sketch->count++;
+}
+
+gdouble kuro_quantile_sketch_get(const KuroQuantileSketch *sketch) {
+  gdouble sorted[5];
+
+  if (sketch->count == 0)
+    return 0.0;
+  if (sketch->count >= 5)
+    return sketch->heights[2];
+
+  /* Too few samples for the markers; just look at them directly */
+  memcpy(sorted, sketch->heights, sizeof(gdouble) * sketch->count);
+  qsort(sorted, sketch->count, sizeof(gdouble), compare_doubles);
+
+  return sorted[(guint)(sketch->p * (sketch->count - 1) + 0.5)];
+}
+
+gdouble kuro_history_stats_get_mean(const KuroHistoryStats *stats) {
+  if (stats->count == 0)
+    return 0.0;
+
+  return stats->total_time_ms / stats->count;
+}
+
+static void reset_stats(KuroHistory *history) {
+  guint i;
+
+  memset(history->stats, 0, sizeof(history->stats));
+  for (i = 0; i <= MAX_BOARD_SIZE; i++) {
+    quantile_sketch_init(&history->stats[i].median, 0.5);
+    quantile_sketch_init(&history->stats[i].p90, 0.9);
+  }
+}
+
+static void stats_add(KuroHistoryStats *stats,
+                      const KuroHistoryRecord *record) {
+  if (stats->count == 0 || record->time_ms < stats->best_time_ms)
+    stats->best_time_ms = record->time_ms;
+
+  stats->count++;
+  stats->total_time_ms += record->time_ms;
+  quantile_sketch_add(&stats->median, record->time_ms);
+  quantile_sketch_add(&stats->p90, record->time_ms);
+
+  if (record->hints == 0) {
+    stats->streak++;
+    stats->best_streak = MAX(stats->best_streak, stats->streak);
+  } else {
+    stats->streak = 0;
+  }
+}
+
+/* Fold a record (in host byte order) into the running statistics */
+static void add_to_stats(KuroHistory *history,
+                         const KuroHistoryRecord *record) {
+  stats_add(&history->stats[0], record);
+  if (record->board_size > 0)
+    stats_add(&history->stats[record->board_size], record);
+}
+
+static void record_from_le(KuroHistoryRecord *record,
+                           const KuroHistoryRecord *stored) {
+  record->finished = GINT64_FROM_LE(stored->finished);
+  record->seed = GUINT32_FROM_LE(stored->seed);
+  record->time_ms = GUINT32_FROM_LE(stored->time_ms);
+  record->moves = GUINT32_FROM_LE(stored->moves);
+  record->hints = GUINT16_FROM_LE(stored->hints);
+  record->board_size = stored->board_size;
+  record->reserved = stored->reserved;
+}
+
+static void record_to_le(KuroHistoryRecord *stored,
+                         const KuroHistoryRecord *record) {
+  stored->finished = GINT64_TO_LE(record->finished);
+  stored->seed = GUINT32_TO_LE(record->seed);
+  stored->time_ms = GUINT32_TO_LE(record->time_ms);
+  stored->moves = GUINT32_TO_LE(record->moves);
+  stored->hints = GUINT16_TO_LE(record->hints);
+  stored->board_size = record->board_size;
+  stored->reserved = 0;
+}
+
+/* Pick up the statistics from the last checkpoint. Returns the number of
+ * records they cover, or 0 if there's no usable checkpoint. */
+static guint64 load_checkpoint(KuroHistory *history, guint64 n_records) {
+  gchar *contents;
+  gsize length;
+  StatsHeader header;
+
+  if (!g_file_get_contents(history->stats_path, &contents, &length, NULL))
+    return 0;
+
+  if (length != sizeof(StatsHeader) + sizeof(history->stats)) {
+    g_free(contents);
+    return 0;
+  }
+
+  memcpy(&header, contents, sizeof(StatsHeader));
+  if (memcmp(header.magic, STATS_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != STATS_VERSION ||
+      header.stats_size != sizeof(KuroHistoryStats) ||
+      header.n_records > n_records) {
+    g_free(contents);
+    return 0;
+  }
+
+  memcpy(history->stats, contents + sizeof(StatsHeader),
+         sizeof(history->stats));
+  g_free(contents);
+
+  return header.n_records;
+}
+
+static void save_checkpoint(KuroHistory *history) {
+  StatsHeader header;
+  gchar *contents;
+  gsize length = sizeof(StatsHeader) + sizeof(history->stats);
+  GError *error = NULL;
+
+  memcpy(header.magic, STATS_MAGIC, sizeof(header.magic));
+  header.version = STATS_VERSION;
+  header.stats_size = sizeof(KuroHistoryStats);
+  header.n_records = history->n_records;
+
+  contents = g_malloc(length);
+  memcpy(contents, &header, sizeof(StatsHeader));
+  memcpy(contents + sizeof(StatsHeader), history->stats,
+         sizeof(history->stats));
+
+  if (!g_file_set_contents(history->stats_path, contents, length, &error)) {
+    g_warning("Couldn’t save game statistics: %s", error->message);
+    g_error_free(error);
+  }
+
+  g_free(contents);
+}
+
+static gboolean write_header(GFileIOStream *stream, GError **error) {
+  HistoryHeader header;
+
+  memcpy(header.magic, HISTORY_MAGIC, sizeof(header.magic));
+  header.version = GUINT32_TO_LE(HISTORY_VERSION);
+  header.record_size = GUINT32_TO_LE(sizeof(KuroHistoryRecord));
+
+  return g_output_stream_write_all(
+      g_io_stream_get_output_stream(G_IO_STREAM(stream)), &header,
+      sizeof(header), NULL, NULL, error);
+}
+
+/* Give a log too short to hold a header one. It's either just been created,
+ * or the app stopped before its header was written, and there are no records
+ * to lose either way. */
+static gboolean ensure_header(GFileIOStream *stream, GError **error) {
+  GSeekable *seekable = G_SEEKABLE(stream);
+
+  if (!g_seekable_seek(seekable, 0, G_SEEK_END, NULL, error))
+    return FALSE;
+  if (g_seekable_tell(seekable) >= (goffset)sizeof(HistoryHeader))
+    return TRUE;
+
+  return g_seekable_seek(seekable, 0, G_SEEK_SET, NULL, error) &&
+         g_seekable_truncate(seekable, 0, NULL, error) &&
+         write_header(stream, error);
+}
+
+/* Map the log, check its header and bring the statistics up to date with
+ * any records written since the last checkpoint. */
+static gboolean catch_up(KuroHistory *history, const gchar *log_path,
+                         GError **error) {
+  GMappedFile *mapped;
+  const gchar *contents;
+  gsize length;
+  HistoryHeader header;
+  guint64 i, first;
+
+  mapped = g_mapped_file_new(log_path, FALSE, error);
+  if (mapped == NULL)
+    return FALSE;
+
+  contents = g_mapped_file_get_contents(mapped);
+  length = g_mapped_file_get_length(mapped);
+  memset(&header, 0, sizeof(HistoryHeader));
+
+  if (length >= sizeof(HistoryHeader))
+    memcpy(&header, contents, sizeof(HistoryHeader));
+
+  if (length < sizeof(HistoryHeader) ||
+      memcmp(header.magic, HISTORY_MAGIC, sizeof(header.magic)) != 0 ||
+      GUINT32_FROM_LE(header.version) != HISTORY_VERSION ||
+      GUINT32_FROM_LE(header.record_size) != sizeof(KuroHistoryRecord)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                "Game history file ‘%s’ isn’t in a supported format",
+                log_path);
+    g_mapped_file_unref(mapped);
+    return FALSE;
+  }
+
+  /* Ignore a partly written record left by a crash; it's truncated away
+   * before anything else is appended */
+  history->n_records =
+      (length - sizeof(HistoryHeader)) / sizeof(KuroHistoryRecord);
+
+  reset_stats(history);
+  first = load_checkpoint(history, history->n_records);
+  if (first == 0)
+    reset_stats(history);
+
+  for (i = first; i < history->n_records; i++) {
+    KuroHistoryRecord record;
+
+    record_from_le(&record,
+                   (const KuroHistoryRecord *)(contents +
+                                               sizeof(HistoryHeader)) +
+                       i);
+    add_to_stats(history, &record);
+  }
+
+  g_mapped_file_unref(mapped);
+
+  return TRUE;
+}
+
+/* Open the game history in @directory, creating it if needed */
+KuroHistory *kuro_history_open(const gchar *directory, GError **error) {
+  KuroHistory *history;
+  GFile *file;
+  GError *child_error = NULL;
+  goffset end;
+
+  if (g_mkdir_with_parents(directory, 0700) != 0) {
+    int errsv = errno;
+    g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errsv),
+                "Couldn’t create ‘%s’: %s", directory, g_strerror(errsv));
+    return NULL;
+  }
+
+  history = g_new0(KuroHistory, 1);
+  history->stats_path = g_build_filename(directory, "history-stats", NULL);
+  history->log_path = g_build_filename(directory, "history", NULL);
+  file = g_file_new_for_path(history->log_path);
+
+  history->stream = g_file_open_readwrite(file, NULL, &child_error);
+  if (history->stream == NULL &&
+      g_error_matches(child_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
+    g_clear_error(&child_error);
+    history->stream = g_file_create_readwrite(file, G_FILE_CREATE_PRIVATE,
+                                              NULL, &child_error);
+  }
+
+  g_object_unref(file);
+
+  if (history->stream != NULL && !ensure_header(history->stream, &child_error))
+    g_clear_object(&history->stream);
+
+  if (history->stream == NULL ||
+      !catch_up(history, history->log_path, &child_error)) {
+    g_propagate_error(error, child_error);
+    g_clear_object(&history->stream); /* don't checkpoint anything */
+    kuro_history_close(history);
+    return NULL;
+  }
+
+  /* Appends go straight after the last whole record */
+  end = sizeof(HistoryHeader) + history->n_records * sizeof(KuroHistoryRecord);
+  if (!g_seekable_seek(G_SEEKABLE(history->stream), end, G_SEEK_SET, NULL,
+                       error) ||
+      !g_seekable_truncate(G_SEEKABLE(history->stream), end, NULL, error)) {
+    kuro_history_close(history);
+    return NULL;
+  }
+
+  return history;
+}
+
+void kuro_history_close(KuroHistory *history) {
+  if (history == NULL)
+    return;
+
+  if (history->stream != NULL) {
+    save_checkpoint(history);
+    g_io_stream_close(G_IO_STREAM(history->stream), NULL, NULL);
+    g_object_unref(history->stream);
+  }
+
+  g_free(history->log_path);
+  g_free(history->stats_path);
+  g_free(history);
+}
+
+gboolean kuro_history_append(KuroHistory *history,
+                             const KuroHistoryRecord *record, GError **error) {
+  GOutputStream *output;
+  KuroHistoryRecord stored;
+
+  g_return_val_if_fail(history != NULL, FALSE);
+  g_return_val_if_fail(record->board_size <= MAX_BOARD_SIZE, FALSE);
+
+  record_to_le(&stored, record);
+  output = g_io_stream_get_output_stream(G_IO_STREAM(history->stream));
+
+  if (!g_output_stream_write_all(output, &stored, sizeof(stored), NULL, NULL,
+                                 error) ||
+      !g_output_stream_flush(output, NULL, error))
+    return FALSE;
+
+  history->n_records++;
+  add_to_stats(history, record);
+
+  return TRUE;
+}
+
+guint64 kuro_history_get_n_records(KuroHistory *history) {
+  return history->n_records;
+}
+
+/* Map the records written so far, without copying them. Records appended
+ * later aren't included. */
+GBytes *kuro_history_map_records(KuroHistory *history, GError **error) {
+  GMappedFile *mapped;
+  GBytes *bytes, *records;
+
+  mapped = g_mapped_file_new(history->log_path, FALSE, error);
+  if (mapped == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes(mapped);
+  g_mapped_file_unref(mapped);
+
+  records = g_bytes_new_from_bytes(
+      bytes, sizeof(HistoryHeader),
+      history->n_records * sizeof(KuroHistoryRecord));
+  g_bytes_unref(bytes);
+
+  return records;
+}
+
+void kuro_history_get_record(GBytes *records, guint index,
+                             KuroHistoryRecord *record) {
+  const KuroHistoryRecord *stored;
+  gsize size;
+
+  stored = g_bytes_get_data(records, &size);
+  g_return_if_fail((index + 1) * sizeof(KuroHistoryRecord) <= size);
+
+  record_from_le(record, stored + index);
+}
+
+/* Statistics for one board size, or for every size if @board_size is 0 */
+const KuroHistoryStats *kuro_history_get_stats(KuroHistory *history,
+                                               guint board_size) {
+  g_return_val_if_fail(board_size <= MAX_BOARD_SIZE, NULL);
+
+  return &history->stats[board_size];
+}
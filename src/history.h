@@ -0,0 +1,81 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_HISTORY_H
+#define KURO_HISTORY_H
+
+#include <gio/gio.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* One finished game, exactly as it's stored in the log (little-endian). The
+ * log is a 16-byte header followed by these back to back, so it can be mapped
+ * and indexed directly. */
+typedef struct {
+  gint64 finished; /* µs since the epoch */
+  guint32 seed;
+  guint32 time_ms;
+  guint32 moves;
+  guint16 hints;
+  guint8 board_size;
+  guint8 reserved;
+} KuroHistoryRecord;
+
+/* Streaming quantile estimate using the P² algorithm, which keeps five
+ * markers rather than every sample */
+typedef struct {
+  gdouble p;
+  guint count;
+  gdouble heights[5];
+  gdouble positions[5];
+  gdouble desired[5];
+  gdouble increments[5];
+} KuroQuantileSketch;
+
+typedef struct {
+  guint64 count;
+  gdouble total_time_ms;
+  guint32 best_time_ms;
+  KuroQuantileSketch median;
+  KuroQuantileSketch p90;
+  guint32 streak; /* consecutive games finished without a hint */
+  guint32 best_streak;
+} KuroHistoryStats;
+
+typedef struct _KuroHistory KuroHistory;
+
+KuroHistory *kuro_history_open(const gchar *directory, GError **error);
+void kuro_history_close(KuroHistory *history);
+gboolean kuro_history_append(KuroHistory *history,
+                             const KuroHistoryRecord *record, GError **error);
+guint64 kuro_history_get_n_records(KuroHistory *history);
+GBytes *kuro_history_map_records(KuroHistory *history,
+                                 GError **error) G_GNUC_WARN_UNUSED_RESULT;
+void kuro_history_get_record(GBytes *records, guint index,
+                             KuroHistoryRecord *record);
+const KuroHistoryStats *kuro_history_get_stats(KuroHistory *history,
+                                               guint board_size);
+
+gdouble kuro_history_stats_get_mean(const KuroHistoryStats *stats);
+gdouble kuro_quantile_sketch_get(const KuroQuantileSketch *sketch);
+
+G_END_DECLS
+
+#endif /* KURO_HISTORY_H */
@@ -22,11 +22,15 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <math.h>
+#include <string.h>
 
+#include "book.h"
 #include "config.h"
+#include "hint.h"
+#include "history-model.h"
 #include "interface.h"
 #include "main.h"
-#include "rules.h"
+#include "profiler.h"
 
 #define NORMAL_FONT_SCALE 0.9
 #define PAINTED_FONT_SCALE 0.6
@@ -36,10 +40,19 @@
 #define HINT_DISABLED 0
 #define HINT_INTERVAL 500
 #define CURSOR_MARGIN 3
+#define MIN_CELL_SIZE 32.0 /* smallest cell a big board is zoomed out to */
+#define MAX_CELL_SIZE 160.0
+#define MIN_TEXT_CELL_SIZE 6.0 /* don't bother drawing numbers below this */
+#define ZOOM_STEP 1.2
+#define SCROLL_STEP 40.0
+#define PERF_OVERLAY_MARGIN 6.0
+#define PERF_OVERLAY_PADDING 6.0
 
 static void kuro_cancel_hinting(Kuro *kuro);
 static void board_theme_change_cb(GSettings *settings, const gchar *key,
                                   gpointer user_data);
+static void assist_change_cb(GSettings *settings, const gchar *key,
+                             gpointer user_data);
 
 static const KuroTheme theme_kuro = {
     {0.141, 0.122, 0.192, 1.0}, /* unpainted_bg: #241f31 */
@@ -64,11 +77,29 @@ static const KuroTheme theme_classic = {
 /* Declarations for GtkBuilder */
 void kuro_draw_cb(GtkDrawingArea *drawing_area, cairo_t *cr, int width,
                   int height, gpointer user_data);
-static void kuro_click_released_cb(GtkGestureClick *gesture, int n_press,
-                                   double x, double y, gpointer user_data);
+static void kuro_paint_begin_cb(GtkGestureDrag *gesture, double x, double y,
+                                gpointer user_data);
+static void kuro_paint_update_cb(GtkGestureDrag *gesture, double x, double y,
+                                 gpointer user_data);
+static void kuro_paint_end_cb(GtkGestureDrag *gesture, double x, double y,
+                              gpointer user_data);
 static gboolean kuro_key_pressed_cb(GtkEventControllerKey *controller,
                                     guint keyval, guint keycode,
                                     GdkModifierType state, gpointer user_data);
+static void kuro_motion_cb(GtkEventControllerMotion *controller, double x,
+                           double y, gpointer user_data);
+static void kuro_leave_cb(GtkEventControllerMotion *controller,
+                          gpointer user_data);
+static gboolean kuro_scroll_cb(GtkEventControllerScroll *controller, double dx,
+                               double dy, gpointer user_data);
+static void kuro_zoom_begin_cb(GtkGesture *gesture,
+                               GdkEventSequence *sequence, gpointer user_data);
+static void kuro_zoom_scale_changed_cb(GtkGestureZoom *gesture, double scale,
+                                       gpointer user_data);
+static void kuro_drag_begin_cb(GtkGestureDrag *gesture, double x, double y,
+                               gpointer user_data);
+static void kuro_drag_update_cb(GtkGestureDrag *gesture, double x, double y,
+                                gpointer user_data);
 gboolean kuro_close_request_cb(GtkWindow *window, Kuro *kuro);
 static void new_game_cb(GSimpleAction *action, GVariant *parameter,
                         gpointer user_data);
@@ -88,6 +119,14 @@ static void pause_cb(GSimpleAction *action, GVariant *parameter,
                      gpointer user_data);
 static void show_help_overlay_cb(GSimpleAction *action, GVariant *parameter,
                                  gpointer user_data);
+static void zoom_in_cb(GSimpleAction *action, GVariant *parameter,
+                       gpointer user_data);
+static void zoom_out_cb(GSimpleAction *action, GVariant *parameter,
+                        gpointer user_data);
+static void zoom_reset_cb(GSimpleAction *action, GVariant *parameter,
+                          gpointer user_data);
+static void perf_overlay_cb(GSimpleAction *action, GVariant *parameter,
+                            gpointer user_data);
 static void board_size_cb(GSimpleAction *action, GVariant *parameter,
                           gpointer user_data);
 static void board_theme_cb(GSimpleAction *action, GVariant *parameter,
@@ -100,10 +139,13 @@ static void style_manager_dark_changed_cb(AdwStyleManager *style_manager,
 
 static void high_scores_cb(GSimpleAction *action, GVariant *parameter,
                            gpointer user_data);
+static void print_book_cb(GSimpleAction *action, GVariant *parameter,
+                          gpointer user_data);
 
 static GActionEntry app_entries[] = {
     {"new-game", new_game_cb, NULL, NULL, NULL},
     {"high-scores", high_scores_cb, NULL, NULL, NULL},
+    {"print-book", print_book_cb, NULL, NULL, NULL},
     {"about", about_cb, NULL, NULL, NULL},
     {"help", help_cb, NULL, NULL, NULL},
     {"quit", quit_cb, NULL, NULL, NULL},
@@ -117,8 +159,24 @@ static GActionEntry win_entries[] = {
     {"redo", redo_cb, NULL, NULL, NULL},
     {"pause", pause_cb, NULL, "false", NULL},
     {"show-help-overlay", show_help_overlay_cb, NULL, NULL, NULL},
+    {"zoom-in", zoom_in_cb, NULL, NULL, NULL},
+    {"zoom-out", zoom_out_cb, NULL, NULL, NULL},
+    {"zoom-reset", zoom_reset_cb, NULL, NULL, NULL},
+    {"perf-overlay", perf_overlay_cb, NULL, "false", NULL},
 };
 
+/* Times under an hour show tenths, to tell apart scores within a second */
+static gchar *format_time_ms(guint time_ms) {
+  guint time = time_ms / 1000;
+
+  if (time < 3600)
+    return g_strdup_printf("%02u:%02u.%u", time / 60, time % 60,
+                           (time_ms % 1000) / 100);
+
+  return g_strdup_printf("%u:%02u:%02u", time / 3600, (time % 3600) / 60,
+                         time % 60);
+}
+
 static void on_new_high_score_done(GtkWidget *button, gpointer user_data) {
   AdwDialog *dialog = ADW_DIALOG(user_data);
   Kuro *kuro = g_object_get_data(G_OBJECT(dialog), "kuro");
@@ -126,7 +184,8 @@ static void on_new_high_score_done(GtkWidget *button, gpointer user_data) {
   const char *name = gtk_editable_get_text(GTK_EDITABLE(entry));
 
   if (name && *name) {
-    kuro_score_add(kuro, kuro->board_size, name, kuro->timer_value);
+    kuro_score_add(kuro->scores, kuro->board->size, name,
+                   kuro_get_timer_ms(kuro));
   }
 
   adw_dialog_close(dialog);
@@ -141,16 +200,17 @@ static void win_dialog_response_cb(AdwAlertDialog *dialog, const char *response,
   if (g_strcmp0(response, "quit") == 0) {
     kuro_quit(kuro);
   } else if (g_strcmp0(response, "play-again") == 0) {
-    kuro_new_game(kuro, kuro->board_size);
+    kuro_new_game(kuro, kuro->board->size);
   }
 }
 
 void kuro_show_win_dialog(Kuro *kuro) {
   AdwAlertDialog *dialog;
   gchar *message;
+  guint time = kuro_get_timer_ms(kuro) / 1000;
 
   message = g_strdup_printf(_("You’ve won in a time of %02u:%02u!"),
-                            kuro->timer_value / 60, kuro->timer_value % 60);
+                            time / 60, time % 60);
   dialog = ADW_ALERT_DIALOG(adw_alert_dialog_new(_("You Won!"), message));
   g_free(message);
 
@@ -182,8 +242,8 @@ void kuro_show_new_high_score_dialog(Kuro *kuro) {
   header_bar = adw_header_bar_new();
   adw_header_bar_set_show_end_title_buttons(ADW_HEADER_BAR(header_bar), FALSE);
 
-  char *size_str = g_strdup_printf(_("Grid Size: %d × %d"), kuro->board_size,
-                                   kuro->board_size);
+  char *size_str = g_strdup_printf(_("Grid Size: %d × %d"), kuro->board->size,
+                                   kuro->board->size);
   GtkWidget *title_widget =
       adw_window_title_new(_("Congratulations!"), size_str);
   g_free(size_str);
@@ -213,7 +273,7 @@ void kuro_show_new_high_score_dialog(Kuro *kuro) {
   gtk_box_append(GTK_BOX(box), separator);
 
   /* List of scores + New Score */
-  GList *scores = kuro_score_get_top_scores(kuro, kuro->board_size);
+  const GPtrArray *scores = kuro_score_get_top_scores(kuro->scores, kuro->board->size);
   /* ... logic ... */
 
   GtkWidget *list_box = gtk_list_box_new();
@@ -246,62 +306,42 @@ void kuro_show_new_high_score_dialog(Kuro *kuro) {
   gtk_box_append(GTK_BOX(box), header_row);
   gtk_box_append(GTK_BOX(box), list_box);
 
-  /* Merge logic */
-  KuroScore *new_s = g_new0(KuroScore, 1);
-  new_s->board_size = kuro->board_size;
-  new_s->time = kuro->timer_value;
-  new_s->name = NULL;
-
-  GList *l;
-  gboolean inserted = FALSE;
-  GList *display_list = NULL;
-
-  for (l = scores; l != NULL; l = l->next) {
-    KuroScore *s = (KuroScore *)l->data;
-    if (!inserted && new_s->time < s->time) {
-      display_list = g_list_append(display_list, new_s);
-      inserted = TRUE;
-    }
-    display_list = g_list_append(display_list, s);
-  }
-  if (!inserted && g_list_length(display_list) < 10) {
-    display_list = g_list_append(display_list, new_s);
-  }
-
-  while (g_list_length(display_list) > 10) {
-    GList *last = g_list_last(display_list);
-    display_list = g_list_delete_link(display_list, last);
-  }
+  /* The new score goes where kuro_score_add() will put it, pushing the rest
+   * down, and anything pushed past the last place drops off */
+  KuroScore new_s = {kuro->board->size, NULL, kuro_get_timer_ms(kuro)};
+  guint n_scores = (scores != NULL) ? scores->len : 0;
+  guint position = kuro_score_find_position(scores, new_s.time_ms);
+  guint i;
 
   /* Render */
-  int rank = 1;
   entry = NULL;
 
-  for (l = display_list; l != NULL; l = l->next) {
-    KuroScore *s = (KuroScore *)l->data;
+  for (i = 0; i <= n_scores && i < MAX_HIGH_SCORES; i++) {
+    const KuroScore *s;
+
+    if (i == position)
+      s = &new_s;
+    else
+      s = g_ptr_array_index(scores, (i < position) ? i : i - 1);
+
     GtkWidget *row_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
     gtk_widget_set_margin_top(row_box, 12);
     gtk_widget_set_margin_bottom(row_box, 12);
 
-    char *rank_str = g_strdup_printf("%d", rank++);
+    char *rank_str = g_strdup_printf("%u", i + 1);
     GtkWidget *r_lbl = gtk_label_new(rank_str);
     g_free(rank_str);
     gtk_widget_set_size_request(r_lbl, 40, -1);
     gtk_box_append(GTK_BOX(row_box), r_lbl);
 
-    char *time_str;
-    if (s->time < 3600)
-      time_str = g_strdup_printf("%02u:%02u", s->time / 60, s->time % 60);
-    else
-      time_str = g_strdup_printf("%u:%02u:%02u", s->time / 3600,
-                                 (s->time % 3600) / 60, s->time % 60);
+    char *time_str = format_time_ms(s->time_ms);
 
     GtkWidget *t_lbl = gtk_label_new(time_str);
     g_free(time_str);
     gtk_widget_set_size_request(t_lbl, 60, -1);
     gtk_box_append(GTK_BOX(row_box), t_lbl);
 
-    if (s == new_s) {
+    if (s == &new_s) {
       /* Input field */
       entry = gtk_entry_new();
       gtk_widget_set_hexpand(entry, TRUE);
@@ -319,10 +359,6 @@ void kuro_show_new_high_score_dialog(Kuro *kuro) {
     gtk_list_box_append(GTK_LIST_BOX(list_box), row_box);
   }
 
-  g_list_free(display_list);
-  g_list_free_full(scores, (GDestroyNotify)kuro_score_free);
-  g_free(new_s);
-
   adw_toolbar_view_set_content(ADW_TOOLBAR_VIEW(toolbar_view), box);
   adw_dialog_set_child(dialog, toolbar_view);
 
@@ -333,100 +369,439 @@ void kuro_show_new_high_score_dialog(Kuro *kuro) {
   adw_dialog_present(dialog, GTK_WIDGET(kuro->window));
 }
 
-void kuro_show_high_scores_dialog(Kuro *kuro) {
-  AdwDialog *dialog;
-  GtkWidget *toolbar_view;
-  GtkWidget *header_bar;
-  GtkWidget *box;
+typedef enum {
+  SCORES_COLUMN_RANK,
+  SCORES_COLUMN_SIZE,
+  SCORES_COLUMN_NAME,
+  SCORES_COLUMN_TIME,
+  SCORES_COLUMN_DATE,
+  SCORES_COLUMN_MOVES,
+  SCORES_COLUMN_HINTS
+} ScoresColumn;
+
+/* What the high scores dialog is currently showing */
+typedef struct {
+  Kuro *kuro;
+  GArray *sizes; /* board size for each entry in the size drop-down; 0 = all */
+  guint board_size;
+  gint64 since; /* earliest game shown, in µs since the epoch */
+  GtkFilter *score_filter;
+  GtkFilter *history_filter;
+  GtkLabel *stats_label;
+} ScoresView;
+
+static void scores_view_free(ScoresView *view) {
+  g_array_unref(view->sizes);
+  g_free(view);
+}
 
-  dialog = adw_dialog_new();
+static void setup_label_cb(GtkSignalListItemFactory *factory,
+                           GtkListItem *list_item, gpointer user_data) {
+  GtkWidget *label = gtk_label_new(NULL);
 
-  toolbar_view = adw_toolbar_view_new();
-  header_bar = adw_header_bar_new();
+  gtk_label_set_xalign(GTK_LABEL(label), 0.0);
+  gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+  gtk_list_item_set_child(list_item, label);
+}
 
-  char *size_str = g_strdup_printf(_("Grid Size: %d × %d"), kuro->board_size,
-                                   kuro->board_size);
-  GtkWidget *title_widget = adw_window_title_new(_("High Scores"), size_str);
-  g_free(size_str);
+static void bind_score_cb(GtkSignalListItemFactory *factory,
+                          GtkListItem *list_item, gpointer user_data) {
+  KuroScoreItem *item = gtk_list_item_get_item(list_item);
+  const KuroScore *score = kuro_score_item_get_score(item);
+  GtkLabel *label = GTK_LABEL(gtk_list_item_get_child(list_item));
+  gchar *text = NULL;
 
-  adw_header_bar_set_title_widget(ADW_HEADER_BAR(header_bar), title_widget);
+  switch ((ScoresColumn)GPOINTER_TO_INT(user_data)) {
+  case SCORES_COLUMN_RANK:
+    text = g_strdup_printf("%u", kuro_score_item_get_rank(item));
+    break;
+  case SCORES_COLUMN_SIZE:
+    text = g_strdup_printf(_("%u × %u"), score->board_size, score->board_size);
+    break;
+  case SCORES_COLUMN_NAME:
+    text = g_strdup(score->name);
+    break;
+  case SCORES_COLUMN_TIME:
+    text = format_time_ms(score->time_ms);
+    break;
+  case SCORES_COLUMN_DATE:
+  case SCORES_COLUMN_MOVES:
+  case SCORES_COLUMN_HINTS:
+  default:
+    g_assert_not_reached();
+    break;
+  }
 
-  adw_toolbar_view_add_top_bar(ADW_TOOLBAR_VIEW(toolbar_view), header_bar);
+  gtk_label_set_text(label, text);
+  g_free(text);
+}
 
-  gtk_widget_set_size_request(toolbar_view, 400, 520);
+static void bind_history_cb(GtkSignalListItemFactory *factory,
+                            GtkListItem *list_item, gpointer user_data) {
+  const KuroHistoryRecord *record =
+      kuro_history_item_get_record(gtk_list_item_get_item(list_item));
+  GtkLabel *label = GTK_LABEL(gtk_list_item_get_child(list_item));
+  GDateTime *date;
+  gchar *text = NULL;
+
+  switch ((ScoresColumn)GPOINTER_TO_INT(user_data)) {
+  case SCORES_COLUMN_DATE:
+    date = g_date_time_new_from_unix_local(record->finished / G_USEC_PER_SEC);
+    text = g_date_time_format(date, "%x %R");
+    g_date_time_unref(date);
+    break;
+  case SCORES_COLUMN_SIZE:
+    text = g_strdup_printf(_("%u × %u"), record->board_size,
+                           record->board_size);
+    break;
+  case SCORES_COLUMN_TIME:
+    text = format_time_ms(record->time_ms);
+    break;
+  case SCORES_COLUMN_MOVES:
+    text = g_strdup_printf("%u", record->moves);
+    break;
+  case SCORES_COLUMN_HINTS:
+    text = g_strdup_printf("%u", record->hints);
+    break;
+  case SCORES_COLUMN_RANK:
+  case SCORES_COLUMN_NAME:
+  default:
+    g_assert_not_reached();
+    break;
+  }
 
-  box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+  gtk_label_set_text(label, text);
+  g_free(text);
+}
 
-  GtkWidget *separator = gtk_separator_new(GTK_ORIENTATION_HORIZONTAL);
-  gtk_box_append(GTK_BOX(box), separator);
+static GtkColumnViewColumn *add_scores_column(GtkColumnView *view,
+                                              const gchar *title,
+                                              GCallback bind_cb,
+                                              ScoresColumn column,
+                                              GtkSorter *sorter) {
+  GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
+  GtkColumnViewColumn *view_column;
 
-  GtkWidget *list_box = gtk_list_box_new();
-  gtk_list_box_set_selection_mode(GTK_LIST_BOX(list_box), GTK_SELECTION_NONE);
-  gtk_widget_add_css_class(list_box, "boxed-list");
-  gtk_widget_set_margin_start(list_box, 24);
-  gtk_widget_set_margin_end(list_box, 24);
-  gtk_widget_set_margin_bottom(list_box, 24);
+  g_signal_connect(factory, "setup", G_CALLBACK(setup_label_cb), NULL);
+  g_signal_connect(factory, "bind", bind_cb, GINT_TO_POINTER(column));
 
-  /* Header Row */
-  GtkWidget *header_row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
-  gtk_widget_set_margin_top(header_row, 12);
-  gtk_widget_set_margin_bottom(header_row, 6);
-  gtk_widget_set_margin_start(header_row, 36);
+  view_column = gtk_column_view_column_new(title, factory);
+  gtk_column_view_column_set_sorter(view_column, sorter);
+  gtk_column_view_column_set_expand(view_column, column == SCORES_COLUMN_NAME ||
+                                                     column == SCORES_COLUMN_DATE);
+  gtk_column_view_append_column(view, view_column);
+  g_object_unref(view_column);
 
-  GtkWidget *lbl_rank = gtk_label_new(_("Rank"));
-  gtk_widget_set_size_request(lbl_rank, 40, -1);
-  gtk_box_append(GTK_BOX(header_row), lbl_rank);
+  if (sorter != NULL)
+    g_object_unref(sorter);
 
-  GtkWidget *lbl_score = gtk_label_new(_("Score"));
-  gtk_widget_set_size_request(lbl_score, 60, -1);
-  gtk_box_append(GTK_BOX(header_row), lbl_score);
+  return view_column;
+}
 
-  GtkWidget *lbl_player = gtk_label_new(_("Player"));
-  gtk_widget_set_hexpand(lbl_player, TRUE);
-  gtk_widget_set_halign(lbl_player, GTK_ALIGN_START);
-  gtk_box_append(GTK_BOX(header_row), lbl_player);
+static GtkSorter *numeric_sorter(GType type, const gchar *property) {
+  return GTK_SORTER(
+      gtk_numeric_sorter_new(gtk_property_expression_new(type, NULL, property)));
+}
 
-  gtk_box_append(GTK_BOX(box), header_row);
-  gtk_box_append(GTK_BOX(box), list_box);
+/* Filter, then sort, @model into @view. Only the visible rows get widgets,
+ * and those are recycled as the view scrolls. */
+static GtkWidget *set_scores_model(GtkColumnView *view, GListModel *model,
+                                   GtkFilter *filter) {
+  GtkFilterListModel *filter_model;
+  GtkSortListModel *sort_model;
+  GtkNoSelection *selection;
+  GtkWidget *scrolled_window;
+
+  filter_model = gtk_filter_list_model_new(model, g_object_ref(filter));
+  gtk_filter_list_model_set_incremental(filter_model, TRUE);
+  sort_model = gtk_sort_list_model_new(
+      G_LIST_MODEL(filter_model),
+      g_object_ref(gtk_column_view_get_sorter(view)));
+  gtk_sort_list_model_set_incremental(sort_model, TRUE);
+  selection = gtk_no_selection_new(G_LIST_MODEL(sort_model));
+  gtk_column_view_set_model(view, GTK_SELECTION_MODEL(selection));
+  g_object_unref(selection);
+
+  scrolled_window = gtk_scrolled_window_new();
+  gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window),
+                                 GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled_window),
+                                GTK_WIDGET(view));
+  gtk_widget_set_vexpand(scrolled_window, TRUE);
+
+  return scrolled_window;
+}
 
-  GList *scores = kuro_score_get_top_scores(kuro, kuro->board_size);
-  int rank = 1;
-  GList *l;
+static gboolean score_filter_func(gpointer item, gpointer user_data) {
+  ScoresView *view = user_data;
+  const KuroScore *score = kuro_score_item_get_score(item);
 
-  for (l = scores; l != NULL; l = l->next) {
-    KuroScore *s = (KuroScore *)l->data;
-    GtkWidget *row_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
-    gtk_widget_set_margin_top(row_box, 12);
-    gtk_widget_set_margin_bottom(row_box, 12);
+  return view->board_size == 0 || score->board_size == view->board_size;
+}
 
-    char *rank_str = g_strdup_printf("%d", rank++);
-    GtkWidget *r_lbl = gtk_label_new(rank_str);
-    g_free(rank_str);
-    gtk_widget_set_size_request(r_lbl, 40, -1);
-    gtk_box_append(GTK_BOX(row_box), r_lbl);
+static gboolean history_filter_func(gpointer item, gpointer user_data) {
+  ScoresView *view = user_data;
+  const KuroHistoryRecord *record = kuro_history_item_get_record(item);
 
-    char *time_str;
-    if (s->time < 3600)
-      time_str = g_strdup_printf("%02u:%02u", s->time / 60, s->time % 60);
-    else
-      time_str = g_strdup_printf("%u:%02u:%02u", s->time / 3600,
-                                 (s->time % 3600) / 60, s->time % 60);
+  return (view->board_size == 0 || record->board_size == view->board_size) &&
+         record->finished >= view->since;
+}
 
-    GtkWidget *t_lbl = gtk_label_new(time_str);
-    g_free(time_str);
-    gtk_widget_set_size_request(t_lbl, 60, -1);
-    gtk_box_append(GTK_BOX(row_box), t_lbl);
+static void update_stats_label(ScoresView *view) {
+  const KuroHistoryStats *stats;
+  gchar *mean, *median, *p90, *text;
 
-    GtkWidget *n_lbl = gtk_label_new(s->name);
-    gtk_widget_set_hexpand(n_lbl, TRUE);
-    gtk_widget_set_halign(n_lbl, GTK_ALIGN_START);
-    gtk_box_append(GTK_BOX(row_box), n_lbl);
+  if (view->kuro->history == NULL) {
+    gtk_label_set_text(view->stats_label, _("Game history is unavailable."));
+    return;
+  }
 
-    gtk_list_box_append(GTK_LIST_BOX(list_box), row_box);
+  stats = kuro_history_get_stats(view->kuro->history, view->board_size);
+  if (stats->count == 0) {
+    gtk_label_set_text(view->stats_label, _("No games finished yet."));
+    return;
   }
-  g_list_free_full(scores, (GDestroyNotify)kuro_score_free);
 
-  adw_toolbar_view_set_content(ADW_TOOLBAR_VIEW(toolbar_view), box);
+  /* The statistics cover every game of this size, whatever the date filter */
+  mean = format_time_ms((guint)kuro_history_stats_get_mean(stats));
+  median = format_time_ms((guint)kuro_quantile_sketch_get(&stats->median));
+  p90 = format_time_ms((guint)kuro_quantile_sketch_get(&stats->p90));
+  text = g_strdup_printf(_("%u games, averaging %s. Median %s, 90%% within "
+                           "%s. Best hint-free streak: %u."),
+                         (guint)MIN(stats->count, G_MAXUINT), mean, median,
+                         p90, stats->best_streak);
+
+  gtk_label_set_text(view->stats_label, text);
+
+  g_free(text);
+  g_free(p90);
+  g_free(median);
+  g_free(mean);
+}
+
+static void size_selected_cb(GtkDropDown *drop_down, GParamSpec *pspec,
+                             gpointer user_data) {
+  ScoresView *view = user_data;
+  guint selected = gtk_drop_down_get_selected(drop_down);
+
+  if (selected >= view->sizes->len)
+    return;
+
+  view->board_size = g_array_index(view->sizes, guint, selected);
+  gtk_filter_changed(view->score_filter, GTK_FILTER_CHANGE_DIFFERENT);
+  gtk_filter_changed(view->history_filter, GTK_FILTER_CHANGE_DIFFERENT);
+  update_stats_label(view);
+}
+
+static void date_selected_cb(GtkDropDown *drop_down, GParamSpec *pspec,
+                             gpointer user_data) {
+  ScoresView *view = user_data;
+  GDateTime *now = g_date_time_new_now_local();
+  GDateTime *since;
+
+  switch (gtk_drop_down_get_selected(drop_down)) {
+  case 1: /* today */
+    since = g_date_time_new_local(g_date_time_get_year(now),
+                                  g_date_time_get_month(now),
+                                  g_date_time_get_day_of_month(now), 0, 0, 0);
+    break;
+  case 2: /* past week */
+    since = g_date_time_add_days(now, -7);
+    break;
+  case 3: /* past month */
+    since = g_date_time_add_days(now, -30);
+    break;
+  default:
+    since = NULL;
+    break;
+  }
+
+  view->since = (since != NULL) ? g_date_time_to_unix(since) * G_USEC_PER_SEC
+                                : G_MININT64;
+
+  g_clear_pointer(&since, g_date_time_unref);
+  g_date_time_unref(now);
+
+  gtk_filter_changed(view->history_filter, GTK_FILTER_CHANGE_DIFFERENT);
+}
+
+static GtkWidget *create_size_drop_down(ScoresView *view) {
+  GtkStringList *strings = gtk_string_list_new(NULL);
+  GtkWidget *drop_down;
+  guint size, all = 0, selected = 0;
+
+  gtk_string_list_append(strings, _("All Sizes"));
+  g_array_append_val(view->sizes, all);
+
+  /* Offer every size with a score or a finished game, plus the current one */
+  for (size = 1; size <= MAX_BOARD_SIZE; size++) {
+    gchar *label;
+
+    if (size != view->kuro->board->size &&
+        kuro_score_get_top_scores(view->kuro->scores, size) == NULL &&
+        (view->kuro->history == NULL ||
+         kuro_history_get_stats(view->kuro->history, size)->count == 0))
+      continue;
+
+    if (size == view->kuro->board->size)
+      selected = view->sizes->len;
+
+    label = g_strdup_printf(_("%u × %u"), size, size);
+    gtk_string_list_append(strings, label);
+    g_free(label);
+    g_array_append_val(view->sizes, size);
+  }
+
+  drop_down = gtk_drop_down_new(G_LIST_MODEL(strings), NULL);
+  gtk_drop_down_set_selected(GTK_DROP_DOWN(drop_down), selected);
+  view->board_size = g_array_index(view->sizes, guint, selected);
+
+  g_signal_connect(drop_down, "notify::selected", G_CALLBACK(size_selected_cb),
+                   view);
+
+  return drop_down;
+}
+
+static GtkWidget *create_date_drop_down(ScoresView *view) {
+  const gchar *const dates[] = {_("All Time"), _("Today"), _("Past Week"),
+                                _("Past Month"), NULL};
+  GtkWidget *drop_down = gtk_drop_down_new_from_strings(dates);
+
+  view->since = G_MININT64;
+  g_signal_connect(drop_down, "notify::selected", G_CALLBACK(date_selected_cb),
+                   view);
+
+  return drop_down;
+}
+
+void kuro_show_high_scores_dialog(Kuro *kuro) {
+  AdwDialog *dialog;
+  ScoresView *view;
+  GtkWidget *toolbar_view, *header_bar, *switcher, *filter_bar, *stack;
+  GtkWidget *box;
+  GtkColumnView *scores_view, *history_view;
+  GtkColumnViewColumn *date_column;
+  GListModel *history_model = NULL;
+
+  dialog = adw_dialog_new();
+  adw_dialog_set_title(dialog, _("High Scores"));
+  adw_dialog_set_content_width(dialog, 560);
+  adw_dialog_set_content_height(dialog, 560);
+
+  view = g_new0(ScoresView, 1);
+  view->kuro = kuro;
+  view->sizes = g_array_new(FALSE, FALSE, sizeof(guint));
+  g_object_set_data_full(G_OBJECT(dialog), "scores-view", view,
+                         (GDestroyNotify)scores_view_free);
+
+  toolbar_view = adw_toolbar_view_new();
+  stack = adw_view_stack_new();
+
+  header_bar = adw_header_bar_new();
+  switcher = adw_view_switcher_new();
+  adw_view_switcher_set_policy(ADW_VIEW_SWITCHER(switcher),
+                               ADW_VIEW_SWITCHER_POLICY_WIDE);
+  adw_view_switcher_set_stack(ADW_VIEW_SWITCHER(switcher),
+                              ADW_VIEW_STACK(stack));
+  adw_header_bar_set_title_widget(ADW_HEADER_BAR(header_bar), switcher);
+  adw_toolbar_view_add_top_bar(ADW_TOOLBAR_VIEW(toolbar_view), header_bar);
+
+  /* Filters shared by both pages */
+  filter_bar = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+  gtk_widget_set_halign(filter_bar, GTK_ALIGN_CENTER);
+  gtk_widget_set_margin_top(filter_bar, 6);
+  gtk_widget_set_margin_bottom(filter_bar, 6);
+  gtk_box_append(GTK_BOX(filter_bar), create_size_drop_down(view));
+  gtk_box_append(GTK_BOX(filter_bar), create_date_drop_down(view));
+  adw_toolbar_view_add_top_bar(ADW_TOOLBAR_VIEW(toolbar_view), filter_bar);
+
+  view->score_filter =
+      GTK_FILTER(gtk_custom_filter_new(score_filter_func, view, NULL));
+  view->history_filter =
+      GTK_FILTER(gtk_custom_filter_new(history_filter_func, view, NULL));
+
+  /* Best times */
+  scores_view = GTK_COLUMN_VIEW(gtk_column_view_new(NULL));
+  add_scores_column(scores_view, _("Rank"), G_CALLBACK(bind_score_cb),
+                    SCORES_COLUMN_RANK,
+                    numeric_sorter(KURO_TYPE_SCORE_ITEM, "rank"));
+  add_scores_column(scores_view, _("Size"), G_CALLBACK(bind_score_cb),
+                    SCORES_COLUMN_SIZE,
+                    numeric_sorter(KURO_TYPE_SCORE_ITEM, "board-size"));
+  add_scores_column(scores_view, _("Player"), G_CALLBACK(bind_score_cb),
+                    SCORES_COLUMN_NAME,
+                    GTK_SORTER(gtk_string_sorter_new(gtk_property_expression_new(
+                        KURO_TYPE_SCORE_ITEM, NULL, "name"))));
+  add_scores_column(scores_view, _("Time"), G_CALLBACK(bind_score_cb),
+                    SCORES_COLUMN_TIME,
+                    numeric_sorter(KURO_TYPE_SCORE_ITEM, "time-ms"));
+
+  adw_view_stack_add_titled_with_icon(
+      ADW_VIEW_STACK(stack),
+      set_scores_model(scores_view, kuro_score_store_list(kuro->scores),
+                       view->score_filter),
+      "best-times", _("Best Times"), "starred-symbolic");
+
+  /* Every finished game */
+  history_view = GTK_COLUMN_VIEW(gtk_column_view_new(NULL));
+  date_column = add_scores_column(
+      history_view, _("Date"), G_CALLBACK(bind_history_cb), SCORES_COLUMN_DATE,
+      numeric_sorter(KURO_TYPE_HISTORY_ITEM, "finished"));
+  add_scores_column(history_view, _("Size"), G_CALLBACK(bind_history_cb),
+                    SCORES_COLUMN_SIZE,
+                    numeric_sorter(KURO_TYPE_HISTORY_ITEM, "board-size"));
+  add_scores_column(history_view, _("Time"), G_CALLBACK(bind_history_cb),
+                    SCORES_COLUMN_TIME,
+                    numeric_sorter(KURO_TYPE_HISTORY_ITEM, "time-ms"));
+  add_scores_column(history_view, _("Moves"), G_CALLBACK(bind_history_cb),
+                    SCORES_COLUMN_MOVES,
+                    numeric_sorter(KURO_TYPE_HISTORY_ITEM, "moves"));
+  add_scores_column(history_view, _("Hints"), G_CALLBACK(bind_history_cb),
+                    SCORES_COLUMN_HINTS,
+                    numeric_sorter(KURO_TYPE_HISTORY_ITEM, "hints"));
+
+  if (kuro->history != NULL) {
+    GError *error = NULL;
+    GBytes *records = kuro_history_map_records(kuro->history, &error);
+
+    if (records != NULL) {
+      history_model = G_LIST_MODEL(kuro_history_model_new(records));
+      g_bytes_unref(records);
+    } else {
+      g_warning("Couldn’t read the game history: %s", error->message);
+      g_error_free(error);
+    }
+  }
+  if (history_model == NULL)
+    history_model = G_LIST_MODEL(g_list_store_new(KURO_TYPE_HISTORY_ITEM));
+
+  box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+  gtk_box_append(GTK_BOX(box), set_scores_model(history_view, history_model,
+                                                view->history_filter));
+
+  view->stats_label = GTK_LABEL(gtk_label_new(NULL));
+  gtk_label_set_wrap(view->stats_label, TRUE);
+  gtk_widget_add_css_class(GTK_WIDGET(view->stats_label), "dim-label");
+  gtk_widget_set_margin_top(GTK_WIDGET(view->stats_label), 12);
+  gtk_widget_set_margin_bottom(GTK_WIDGET(view->stats_label), 12);
+  gtk_widget_set_margin_start(GTK_WIDGET(view->stats_label), 12);
+  gtk_widget_set_margin_end(GTK_WIDGET(view->stats_label), 12);
+  gtk_box_append(GTK_BOX(box), GTK_WIDGET(view->stats_label));
+  update_stats_label(view);
+
+  adw_view_stack_add_titled_with_icon(ADW_VIEW_STACK(stack), box, "history",
+                                      _("History"),
+                                      "document-open-recent-symbolic");
+
+  /* Newest games first */
+  gtk_column_view_sort_by_column(history_view, date_column,
+                                 GTK_SORT_DESCENDING);
+
+  /* The models hold their own references to the filters */
+  g_object_unref(view->score_filter);
+  g_object_unref(view->history_filter);
+
+  adw_toolbar_view_set_content(ADW_TOOLBAR_VIEW(toolbar_view), stack);
   adw_dialog_set_child(dialog, toolbar_view);
   adw_dialog_present(dialog, GTK_WIDGET(kuro->window));
 }
@@ -437,6 +812,201 @@ static void high_scores_cb(GSimpleAction *action, GVariant *parameter,
   kuro_show_high_scores_dialog(kuro);
 }
 
+static void book_written_cb(GObject *source, GAsyncResult *result,
+                            gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  GError *error = NULL;
+
+  if (!kuro_book_write_finish(result, &error)) {
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      AdwDialog *dialog = adw_alert_dialog_new(
+          _("Could Not Save Puzzle Book"), error->message);
+      adw_alert_dialog_add_response(ADW_ALERT_DIALOG(dialog), "close",
+                                    _("_Close"));
+      adw_dialog_present(dialog, GTK_WIDGET(kuro->window));
+    }
+
+    g_error_free(error);
+    return;
+  }
+
+  adw_toast_overlay_add_toast(ADW_TOAST_OVERLAY(kuro->toast_overlay),
+                              adw_toast_new(_("Puzzle book saved")));
+}
+
+static void book_file_chosen_cb(GObject *source, GAsyncResult *result,
+                                gpointer user_data) {
+  KuroBookOptions *options = user_data;
+  Kuro *kuro = g_object_get_data(source, "kuro");
+  GFile *file;
+
+  file = gtk_file_dialog_save_finish(GTK_FILE_DIALOG(source), result, NULL);
+  if (file != NULL) {
+    kuro_book_write_async(file, options, NULL, book_written_cb, kuro);
+    g_object_unref(file);
+  }
+
+  g_free(options);
+}
+
+static void print_book_response_cb(AdwAlertDialog *dialog,
+                                   const char *response, gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  KuroBookOptions *options;
+  GtkFileDialog *file_dialog;
+  GtkFileFilter *filter;
+  GListStore *filters;
+
+  if (g_strcmp0(response, "save") != 0)
+    return;
+
+  options = g_new0(KuroBookOptions, 1);
+  options->n_puzzles = adw_spin_row_get_value(
+      ADW_SPIN_ROW(g_object_get_data(G_OBJECT(dialog), "count")));
+  options->min_size = adw_spin_row_get_value(
+      ADW_SPIN_ROW(g_object_get_data(G_OBJECT(dialog), "min-size")));
+  options->max_size = adw_spin_row_get_value(
+      ADW_SPIN_ROW(g_object_get_data(G_OBJECT(dialog), "max-size")));
+  options->per_page = adw_spin_row_get_value(
+      ADW_SPIN_ROW(g_object_get_data(G_OBJECT(dialog), "per-page")));
+  options->solutions = adw_switch_row_get_active(
+      ADW_SWITCH_ROW(g_object_get_data(G_OBJECT(dialog), "solutions")));
+
+  if (options->max_size < options->min_size)
+    options->max_size = options->min_size;
+
+  filter = gtk_file_filter_new();
+  gtk_file_filter_set_name(filter, _("PDF Documents"));
+  gtk_file_filter_add_mime_type(filter, "application/pdf");
+  filters = g_list_store_new(GTK_TYPE_FILE_FILTER);
+  g_list_store_append(filters, filter);
+  g_object_unref(filter);
+
+  file_dialog = gtk_file_dialog_new();
+  gtk_file_dialog_set_title(file_dialog, _("Save Puzzle Book"));
+  /* Translators: Default file name for a printable book of puzzles */
+  gtk_file_dialog_set_initial_name(file_dialog, _("Kuro Puzzles.pdf"));
+  gtk_file_dialog_set_filters(file_dialog, G_LIST_MODEL(filters));
+  g_object_unref(filters);
+  g_object_set_data(G_OBJECT(file_dialog), "kuro", kuro);
+
+  gtk_file_dialog_save(file_dialog, GTK_WINDOW(kuro->window), NULL,
+                       book_file_chosen_cb, options);
+  g_object_unref(file_dialog);
+}
+
+void kuro_show_print_book_dialog(Kuro *kuro) {
+  AdwDialog *dialog;
+  GtkWidget *group, *row;
+
+  dialog = adw_alert_dialog_new(_("Print Puzzle Book"),
+                                _("Generate a PDF of puzzles to print out."));
+
+  group = adw_preferences_group_new();
+
+  row = adw_spin_row_new_with_range(1, 1000, 1);
+  adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), _("_Puzzles"));
+  adw_preferences_row_set_use_underline(ADW_PREFERENCES_ROW(row), TRUE);
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), 24);
+  adw_preferences_group_add(ADW_PREFERENCES_GROUP(group), row);
+  g_object_set_data(G_OBJECT(dialog), "count", row);
+
+  row = adw_spin_row_new_with_range(DEFAULT_BOARD_SIZE, MAX_BOARD_SIZE, 1);
+  adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), _("_Smallest Size"));
+  adw_preferences_row_set_use_underline(ADW_PREFERENCES_ROW(row), TRUE);
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), kuro->board->size);
+  adw_preferences_group_add(ADW_PREFERENCES_GROUP(group), row);
+  g_object_set_data(G_OBJECT(dialog), "min-size", row);
+
+  row = adw_spin_row_new_with_range(DEFAULT_BOARD_SIZE, MAX_BOARD_SIZE, 1);
+  adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), _("_Largest Size"));
+  adw_preferences_row_set_use_underline(ADW_PREFERENCES_ROW(row), TRUE);
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), kuro->board->size);
+  adw_preferences_group_add(ADW_PREFERENCES_GROUP(group), row);
+  g_object_set_data(G_OBJECT(dialog), "max-size", row);
+
+  row = adw_spin_row_new_with_range(1, 9, 1);
+  adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row),
+                                _("Puzzles per P_age"));
+  adw_preferences_row_set_use_underline(ADW_PREFERENCES_ROW(row), TRUE);
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), 4);
+  adw_preferences_group_add(ADW_PREFERENCES_GROUP(group), row);
+  g_object_set_data(G_OBJECT(dialog), "per-page", row);
+
+  row = adw_switch_row_new();
+  adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row),
+                                _("Include S_olutions"));
+  adw_preferences_row_set_use_underline(ADW_PREFERENCES_ROW(row), TRUE);
+  adw_switch_row_set_active(ADW_SWITCH_ROW(row), TRUE);
+  adw_preferences_group_add(ADW_PREFERENCES_GROUP(group), row);
+  g_object_set_data(G_OBJECT(dialog), "solutions", row);
+
+  adw_alert_dialog_set_extra_child(ADW_ALERT_DIALOG(dialog), group);
+
+  adw_alert_dialog_add_responses(ADW_ALERT_DIALOG(dialog), "cancel",
+                                 _("_Cancel"), "save", _("_Save…"), NULL);
+  adw_alert_dialog_set_response_appearance(ADW_ALERT_DIALOG(dialog), "save",
+                                           ADW_RESPONSE_SUGGESTED);
+  adw_alert_dialog_set_default_response(ADW_ALERT_DIALOG(dialog), "save");
+  adw_alert_dialog_set_close_response(ADW_ALERT_DIALOG(dialog), "cancel");
+
+  g_signal_connect(dialog, "response", G_CALLBACK(print_book_response_cb),
+                   kuro);
+
+  adw_dialog_present(dialog, GTK_WIDGET(kuro->window));
+}
+
+static void print_book_cb(GSimpleAction *action, GVariant *parameter,
+                          gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  kuro_show_print_book_dialog(kuro);
+}
+
+/* Tell the scheduler whether the board can be seen at all. A minimized or
+ * (where the compositor says so) fully covered window counts as hidden. */
+static void update_window_visibility(Kuro *kuro) {
+  GdkSurface *surface;
+  gboolean visible = gtk_widget_get_mapped(kuro->window);
+
+  surface = gtk_native_get_surface(GTK_NATIVE(kuro->window));
+  if (visible && surface != NULL && GDK_IS_TOPLEVEL(surface)) {
+    GdkToplevelState state = gdk_toplevel_get_state(GDK_TOPLEVEL(surface));
+
+    if (state & GDK_TOPLEVEL_STATE_MINIMIZED)
+      visible = FALSE;
+#if GTK_CHECK_VERSION(4, 12, 0)
+    if (state & GDK_TOPLEVEL_STATE_SUSPENDED)
+      visible = FALSE;
+#endif
+  }
+
+  kuro_scheduler_set_visible(kuro->scheduler, visible);
+}
+
+static void kuro_surface_state_cb(GdkSurface *surface, GParamSpec *pspec,
+                                  gpointer user_data) {
+  update_window_visibility(KURO_APPLICATION(user_data));
+}
+
+static void kuro_window_realize_cb(GtkWidget *window, gpointer user_data) {
+  kuro_startup_trace(KURO_APPLICATION(user_data), "Window realized");
+  g_signal_connect_object(gtk_native_get_surface(GTK_NATIVE(window)),
+                          "notify::state", G_CALLBACK(kuro_surface_state_cb),
+                          user_data, 0);
+}
+
+static void kuro_window_map_cb(GtkWidget *window, gpointer user_data) {
+  kuro_startup_trace(KURO_APPLICATION(user_data), "Window mapped");
+  update_window_visibility(KURO_APPLICATION(user_data));
+}
+
+static void kuro_window_active_cb(GtkWindow *window, GParamSpec *pspec,
+                                  gpointer user_data) {
+  KuroApplication *kuro = KURO_APPLICATION(user_data);
+
+  kuro_scheduler_set_focused(kuro->scheduler, gtk_window_is_active(window));
+}
+
 static void kuro_window_unmap_cb(GtkWidget *window, gpointer user_data) {
   gboolean window_maximized;
   GdkRectangle geometry;
@@ -444,6 +1014,9 @@ static void kuro_window_unmap_cb(GtkWidget *window, gpointer user_data) {
 
   kuro = KURO_APPLICATION(user_data);
 
+  /* Nothing runs in the background while the window's gone */
+  kuro_scheduler_set_visible(kuro->scheduler, FALSE);
+
   window_maximized = gtk_window_is_maximized(GTK_WINDOW(window));
   g_settings_set_boolean(kuro->settings, "window-maximized", window_maximized);
 
@@ -483,9 +1056,16 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
       GTK_WIDGET(gtk_builder_get_object(builder, "pause_overlay"));
   kuro->pause_button =
       GTK_WIDGET(gtk_builder_get_object(builder, "pause_button"));
+  kuro->toast_overlay =
+      GTK_WIDGET(gtk_builder_get_object(builder, "toast_overlay"));
 
   g_signal_connect(kuro->window, "unmap", G_CALLBACK(kuro_window_unmap_cb),
                    kuro);
+  g_signal_connect(kuro->window, "map", G_CALLBACK(kuro_window_map_cb), kuro);
+  g_signal_connect(kuro->window, "realize", G_CALLBACK(kuro_window_realize_cb),
+                   kuro);
+  g_signal_connect(kuro->window, "notify::is-active",
+                   G_CALLBACK(kuro_window_active_cb), kuro);
 
   g_object_unref(builder);
 
@@ -495,10 +1075,16 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
   g_action_map_add_action_entries(G_ACTION_MAP(kuro->window), win_entries,
                                   G_N_ELEMENTS(win_entries), kuro);
 
+  action = g_settings_create_action(kuro->settings, "assist");
+  g_action_map_add_action(G_ACTION_MAP(kuro), action);
+  g_object_unref(action);
+
   g_signal_connect(kuro->settings, "changed::board-size",
                    G_CALLBACK(board_size_change_cb), kuro);
   g_signal_connect(kuro->settings, "changed::board-theme",
                    G_CALLBACK(board_theme_change_cb), kuro);
+  g_signal_connect(kuro->settings, "changed::assist",
+                   G_CALLBACK(assist_change_cb), kuro);
 
   /* Listen for system color scheme changes for auto theme */
   AdwStyleManager *style_manager = adw_style_manager_get_default();
@@ -519,6 +1105,7 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
 
   /* Initial callback trigger */
   board_theme_change_cb(kuro->settings, "board-theme", kuro);
+  assist_change_cb(kuro->settings, "assist", kuro);
 
   kuro->undo_action = G_SIMPLE_ACTION(
       g_action_map_lookup_action(G_ACTION_MAP(kuro->window), "undo"));
@@ -536,6 +1123,12 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
   const gchar *vaccels_shortcuts[] = {"<Primary>question", NULL};
   const gchar *vaccels_about[] = {"<Primary><Shift>a", NULL};
   const gchar *vaccels_pause[] = {"<Primary>p", NULL};
+  const gchar *vaccels_zoom_in[] = {"<Primary>plus", "<Primary>equal",
+                                    "<Primary>KP_Add", NULL};
+  const gchar *vaccels_zoom_out[] = {"<Primary>minus", "<Primary>KP_Subtract",
+                                     NULL};
+  const gchar *vaccels_zoom_reset[] = {"<Primary>0", "<Primary>KP_0", NULL};
+  const gchar *vaccels_perf_overlay[] = {"F12", NULL};
 
   gtk_application_set_accels_for_action(GTK_APPLICATION(kuro), "app.help",
                                         vaccels_help);
@@ -555,6 +1148,14 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
                                         vaccels_about);
   gtk_application_set_accels_for_action(GTK_APPLICATION(kuro), "win.pause",
                                         vaccels_pause);
+  gtk_application_set_accels_for_action(GTK_APPLICATION(kuro), "win.zoom-in",
+                                        vaccels_zoom_in);
+  gtk_application_set_accels_for_action(GTK_APPLICATION(kuro), "win.zoom-out",
+                                        vaccels_zoom_out);
+  gtk_application_set_accels_for_action(GTK_APPLICATION(kuro),
+                                        "win.zoom-reset", vaccels_zoom_reset);
+  gtk_application_set_accels_for_action(
+      GTK_APPLICATION(kuro), "win.perf-overlay", vaccels_perf_overlay);
 
   /* Set up font descriptions for the drawing area */
   /* Note: In GTK4, we create default font descriptions instead of querying
@@ -584,14 +1185,19 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
   gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(kuro->drawing_area),
                                  kuro_draw_cb, kuro, NULL);
 
-  /* Set up mouse input */
-  GtkGesture *click_gesture = gtk_gesture_click_new();
-  gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(click_gesture),
+  /* Set up mouse input. Clicking changes one cell, and dragging changes every
+   * cell swept over. */
+  GtkGesture *paint_gesture = gtk_gesture_drag_new();
+  gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(paint_gesture),
                                 GDK_BUTTON_PRIMARY);
-  g_signal_connect(click_gesture, "released",
-                   G_CALLBACK(kuro_click_released_cb), kuro);
+  g_signal_connect(paint_gesture, "drag-begin",
+                   G_CALLBACK(kuro_paint_begin_cb), kuro);
+  g_signal_connect(paint_gesture, "drag-update",
+                   G_CALLBACK(kuro_paint_update_cb), kuro);
+  g_signal_connect(paint_gesture, "drag-end", G_CALLBACK(kuro_paint_end_cb),
+                   kuro);
   gtk_widget_add_controller(kuro->drawing_area,
-                            GTK_EVENT_CONTROLLER(click_gesture));
+                            GTK_EVENT_CONTROLLER(paint_gesture));
 
   /* Set up keyboard input */
   GtkEventController *key_controller = gtk_event_controller_key_new();
@@ -599,6 +1205,36 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
                    G_CALLBACK(kuro_key_pressed_cb), kuro);
   gtk_widget_add_controller(kuro->drawing_area, key_controller);
 
+  /* Set up zooming and panning, for boards too big to fit on screen */
+  GtkEventController *motion_controller = gtk_event_controller_motion_new();
+  g_signal_connect(motion_controller, "motion", G_CALLBACK(kuro_motion_cb),
+                   kuro);
+  g_signal_connect(motion_controller, "leave", G_CALLBACK(kuro_leave_cb), kuro);
+  gtk_widget_add_controller(kuro->drawing_area, motion_controller);
+
+  GtkEventController *scroll_controller = gtk_event_controller_scroll_new(
+      GTK_EVENT_CONTROLLER_SCROLL_BOTH_AXES);
+  g_signal_connect(scroll_controller, "scroll", G_CALLBACK(kuro_scroll_cb),
+                   kuro);
+  gtk_widget_add_controller(kuro->drawing_area, scroll_controller);
+
+  GtkGesture *zoom_gesture = gtk_gesture_zoom_new();
+  g_signal_connect(zoom_gesture, "begin", G_CALLBACK(kuro_zoom_begin_cb), kuro);
+  g_signal_connect(zoom_gesture, "scale-changed",
+                   G_CALLBACK(kuro_zoom_scale_changed_cb), kuro);
+  gtk_widget_add_controller(kuro->drawing_area,
+                            GTK_EVENT_CONTROLLER(zoom_gesture));
+
+  GtkGesture *drag_gesture = gtk_gesture_drag_new();
+  gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(drag_gesture),
+                                GDK_BUTTON_MIDDLE);
+  g_signal_connect(drag_gesture, "drag-begin", G_CALLBACK(kuro_drag_begin_cb),
+                   kuro);
+  g_signal_connect(drag_gesture, "drag-update",
+                   G_CALLBACK(kuro_drag_update_cb), kuro);
+  gtk_widget_add_controller(kuro->drawing_area,
+                            GTK_EVENT_CONTROLLER(drag_gesture));
+
   /* Cursor is initially not active as playing with the mouse is more common */
   kuro->cursor_active = FALSE;
 
@@ -608,11 +1244,10 @@ GtkWidget *kuro_create_interface(Kuro *kuro) {
 #define BORDER_LEFT 2.0
 
 /* Generate the text for a given cell, potentially localised to the current
- * locale. */
-static const gchar *localise_cell_digit(Kuro *kuro, const KuroVector *pos) {
-  guchar value = kuro->board[pos->x][pos->y].num;
-
-  G_STATIC_ASSERT(MAX_BOARD_SIZE < 11);
+ * locale. Numbers beyond those with translations are formatted into @buffer. */
+static const gchar *localise_cell_digit(Kuro *kuro, const KuroVector *pos,
+                                        gchar *buffer, gsize buffer_len) {
+  guint value = kuro->board->cells[pos->x][pos->y].num;
 
   switch (value) {
   /* Translators: This is a digit rendered in a cell on the game board.
@@ -642,20 +1277,65 @@ static const gchar *localise_cell_digit(Kuro *kuro, const KuroVector *pos) {
   case 11:
     return C_("Board cell", "11");
   default:
-    g_assert_not_reached();
+    g_assert(value > 0 && value <= MAX_BOARD_SIZE + 1);
+    g_snprintf(buffer, buffer_len, "%u", value);
+    return buffer;
   }
 }
 
-static void draw_cell(Kuro *kuro, cairo_t *cr, gdouble cell_size, gdouble x_pos,
-                      gdouble y_pos, KuroVector iter) {
+static void draw_cell_text(Kuro *kuro, cairo_t *cr, gdouble cell_size,
+                           gdouble x_pos, gdouble y_pos, KuroVector iter,
+                           gboolean painted) {
   const gchar *text;
-  PangoLayout *layout;
+  gchar digit[8];
+  PangoLayout *layout = kuro->cell_layout;
   gint text_width, text_height;
-  gboolean painted = FALSE;
   PangoFontDescription *font_desc;
+  GdkRGBA colour;
+
+  text = localise_cell_digit(kuro, &iter, digit, sizeof(digit));
+  kuro->perf.frame_layouts++;
+
+  pango_layout_set_text(layout, text, -1);
+
+  font_desc =
+      (painted == TRUE) ? kuro->painted_font_desc : kuro->normal_font_desc;
+
+  if (kuro->board->cells[iter.x][iter.y].status & CELL_ERROR) {
+    colour = kuro->theme->error_text;
+    gdk_cairo_set_source_rgba(cr, &colour);
+    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_BOLD);
+  } else if (painted) {
+    colour = kuro->theme->painted_text;
+    gdk_cairo_set_source_rgba(cr, &colour);
+    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_NORMAL);
+  } else {
+    g_assert(!painted);
+    colour = kuro->theme->unpainted_text;
+    gdk_cairo_set_source_rgba(cr, &colour);
+    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_NORMAL);
+  }
+
+  pango_layout_set_font_description(layout, font_desc);
+
+  pango_layout_get_pixel_size(layout, &text_width, &text_height);
+  cairo_move_to(cr, x_pos + (cell_size - text_width) / 2,
+                y_pos + (cell_size - text_height) / 2);
+
+  /* Only draw text if not paused */
+  if (!kuro->is_paused) {
+    pango_cairo_show_layout(cr, layout);
+  }
+}
+
+static void draw_cell(Kuro *kuro, cairo_t *cr, gdouble cell_size, gdouble x_pos,
+                      gdouble y_pos, KuroVector iter) {
+  gboolean painted = FALSE;
   GdkRGBA colour = {0.0, 0.0, 0.0, 1.0};
 
-  if (kuro->board[iter.x][iter.y].status & CELL_PAINTED) {
+  kuro->perf.frame_cells++;
+
+  if (kuro->board->cells[iter.x][iter.y].status & CELL_PAINTED) {
     painted = TRUE;
   }
 
@@ -671,7 +1351,7 @@ static void draw_cell(Kuro *kuro, cairo_t *cr, gdouble cell_size, gdouble x_pos,
   cairo_fill(cr);
 
   /* If the cell is tagged, draw the tag dots */
-  if (kuro->board[iter.x][iter.y].status & CELL_TAG1) {
+  if (kuro->board->cells[iter.x][iter.y].status & CELL_TAG1) {
     colour = (GdkRGBA){0.447, 0.624, 0.812, painted ? 0.7 : 1.0}; /* #729fcf */
     gdk_cairo_set_source_rgba(cr, &colour);
 
@@ -683,7 +1363,7 @@ static void draw_cell(Kuro *kuro, cairo_t *cr, gdouble cell_size, gdouble x_pos,
     cairo_fill(cr);
   }
 
-  if (kuro->board[iter.x][iter.y].status & CELL_TAG2) {
+  if (kuro->board->cells[iter.x][iter.y].status & CELL_TAG2) {
     colour = (GdkRGBA){0.541, 0.886, 0.204, painted ? 0.7 : 1.0}; /* #8ae234 */
     gdk_cairo_set_source_rgba(cr, &colour);
 
@@ -706,87 +1386,183 @@ static void draw_cell(Kuro *kuro, cairo_t *cr, gdouble cell_size, gdouble x_pos,
   cairo_rectangle(cr, x_pos, y_pos, cell_size, cell_size);
   cairo_stroke(cr);
 
-  /* Draw the text */
-  text = localise_cell_digit(kuro, &iter);
-  layout = pango_cairo_create_layout(cr);
+  /* Draw the text, unless the board is zoomed out so far that it wouldn't be
+   * legible anyway */
+  if (cell_size >= MIN_TEXT_CELL_SIZE)
+    draw_cell_text(kuro, cr, cell_size, x_pos, y_pos, iter, painted);
+
+  if (kuro->cursor_active && kuro->cursor_position.x == iter.x &&
+      kuro->cursor_position.y == iter.y &&
+      gtk_widget_is_focus(kuro->drawing_area)) {
+    /* Draw the cursor */
+    colour = (GdkRGBA){0.208, 0.518, 0.894, 1.0}; /* #3584e4 */
+    gdk_cairo_set_source_rgba(cr, &colour);
+    cairo_set_line_width(cr, BORDER_LEFT);
+    cairo_rectangle(cr, x_pos + CURSOR_MARGIN, y_pos + CURSOR_MARGIN,
+                    cell_size - (2 * CURSOR_MARGIN),
+                    cell_size - (2 * CURSOR_MARGIN));
+    cairo_stroke(cr);
+  }
+}
+
+/* Draw the performance figures in the top-left corner. This isn't counted in
+ * the frame's own figures. */
+static void draw_perf_overlay(Kuro *kuro, cairo_t *cr) {
+  PangoLayout *layout;
+  PangoFontDescription *font_desc;
+  gchar *text;
+  gint text_width, text_height;
 
+  text = kuro_perf_format(&kuro->perf);
+  layout = pango_cairo_create_layout(cr);
   pango_layout_set_text(layout, text, -1);
+  g_free(text);
 
-  font_desc =
-      (painted == TRUE) ? kuro->painted_font_desc : kuro->normal_font_desc;
+  font_desc = pango_font_description_from_string("Monospace 9");
+  pango_layout_set_font_description(layout, font_desc);
+  pango_font_description_free(font_desc);
 
-  if (kuro->board[iter.x][iter.y].status & CELL_ERROR) {
-    colour = kuro->theme->error_text;
-    gdk_cairo_set_source_rgba(cr, &colour);
-    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_BOLD);
-  } else if (painted) {
-    colour = kuro->theme->painted_text;
-    gdk_cairo_set_source_rgba(cr, &colour);
-    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_NORMAL);
+  pango_layout_get_pixel_size(layout, &text_width, &text_height);
+
+  cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.7);
+  cairo_rectangle(cr, PERF_OVERLAY_MARGIN, PERF_OVERLAY_MARGIN,
+                  text_width + 2 * PERF_OVERLAY_PADDING,
+                  text_height + 2 * PERF_OVERLAY_PADDING);
+  cairo_fill(cr);
+
+  cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0);
+  cairo_move_to(cr, PERF_OVERLAY_MARGIN + PERF_OVERLAY_PADDING,
+                PERF_OVERLAY_MARGIN + PERF_OVERLAY_PADDING);
+  pango_cairo_show_layout(cr, layout);
+
+  g_object_unref(layout);
+}
+
+/* Work out the cell size and where the board sits in the drawing area for the
+ * current zoom level and scroll position. The board is centred along any axis
+ * it fits along, and the scroll position is clamped to the board's edges
+ * along any axis it doesn't. */
+static void update_viewport(Kuro *kuro, gint width, gint height) {
+  gdouble fit_size, max_zoom, board_extent;
+
+  fit_size = MAX(1.0, (MIN(width, height) - BORDER_LEFT) /
+                          (gdouble)kuro->board->size);
+  max_zoom = MAX(1.0, MAX_CELL_SIZE / fit_size);
+
+  /* Big boards start off zoomed in far enough to be playable */
+  if (kuro->zoom <= 0.0)
+    kuro->zoom = MAX(1.0, MIN_CELL_SIZE / fit_size);
+
+  kuro->zoom = CLAMP(kuro->zoom, 1.0, max_zoom);
+  kuro->cell_size = fit_size * kuro->zoom;
+  board_extent = kuro->cell_size * kuro->board->size + BORDER_LEFT;
+
+  if (board_extent <= width) {
+    kuro->view_x = 0.0;
+    kuro->drawing_area_x_offset = (width - board_extent + BORDER_LEFT) / 2.0;
   } else {
-    g_assert(!painted);
-    colour = kuro->theme->unpainted_text;
-    gdk_cairo_set_source_rgba(cr, &colour);
-    pango_font_description_set_weight(font_desc, PANGO_WEIGHT_NORMAL);
+    kuro->view_x = CLAMP(kuro->view_x, 0.0, board_extent - width);
+    kuro->drawing_area_x_offset = BORDER_LEFT / 2.0 - kuro->view_x;
+  }
+
+  if (board_extent <= height) {
+    kuro->view_y = 0.0;
+    kuro->drawing_area_y_offset = (height - board_extent + BORDER_LEFT) / 2.0;
+  } else {
+    kuro->view_y = CLAMP(kuro->view_y, 0.0, board_extent - height);
+    kuro->drawing_area_y_offset = BORDER_LEFT / 2.0 - kuro->view_y;
   }
+}
+
+static void update_viewport_for_widget(Kuro *kuro) {
+  update_viewport(kuro, gtk_widget_get_width(kuro->drawing_area),
+                  gtk_widget_get_height(kuro->drawing_area));
+}
+
+/* Zoom to the given level, keeping the board position under (@x, @y) in the
+ * same place on screen. */
+static void zoom_viewport(Kuro *kuro, gdouble zoom, gdouble x, gdouble y) {
+  gdouble board_x, board_y;
+
+  update_viewport_for_widget(kuro);
+  board_x = (x - kuro->drawing_area_x_offset) / kuro->cell_size;
+  board_y = (y - kuro->drawing_area_y_offset) / kuro->cell_size;
+
+  kuro->zoom = zoom;
+  update_viewport_for_widget(kuro);
+
+  kuro->view_x = board_x * kuro->cell_size + BORDER_LEFT / 2.0 - x;
+  kuro->view_y = board_y * kuro->cell_size + BORDER_LEFT / 2.0 - y;
+  update_viewport_for_widget(kuro);
+
+  gtk_widget_queue_draw(kuro->drawing_area);
+}
 
-  pango_layout_set_font_description(layout, font_desc);
+static void pan_viewport(Kuro *kuro, gdouble dx, gdouble dy) {
+  kuro->view_x += dx;
+  kuro->view_y += dy;
+  update_viewport_for_widget(kuro);
 
-  pango_layout_get_pixel_size(layout, &text_width, &text_height);
-  cairo_move_to(cr, x_pos + (cell_size - text_width) / 2,
-                y_pos + (cell_size - text_height) / 2);
+  gtk_widget_queue_draw(kuro->drawing_area);
+}
 
-  /* Only draw text if not paused */
-  if (!kuro->is_paused) {
-    pango_cairo_show_layout(cr, layout);
-  }
+/* Scroll just far enough to bring the given cell into view */
+static void scroll_to_cell(Kuro *kuro, KuroVector pos) {
+  gint width = gtk_widget_get_width(kuro->drawing_area);
+  gint height = gtk_widget_get_height(kuro->drawing_area);
+  gdouble left, top;
 
-  g_object_unref(layout);
+  update_viewport(kuro, width, height);
+  left = kuro->drawing_area_x_offset + pos.x * kuro->cell_size;
+  top = kuro->drawing_area_y_offset + pos.y * kuro->cell_size;
 
-  if (kuro->cursor_active && kuro->cursor_position.x == iter.x &&
-      kuro->cursor_position.y == iter.y &&
-      gtk_widget_is_focus(kuro->drawing_area)) {
-    /* Draw the cursor */
-    colour = (GdkRGBA){0.208, 0.518, 0.894, 1.0}; /* #3584e4 */
-    gdk_cairo_set_source_rgba(cr, &colour);
-    cairo_set_line_width(cr, BORDER_LEFT);
-    cairo_rectangle(cr, x_pos + CURSOR_MARGIN, y_pos + CURSOR_MARGIN,
-                    cell_size - (2 * CURSOR_MARGIN),
-                    cell_size - (2 * CURSOR_MARGIN));
-    cairo_stroke(cr);
-  }
+  if (left < 0.0)
+    kuro->view_x += left;
+  else if (left + kuro->cell_size > width)
+    kuro->view_x += left + kuro->cell_size - width;
+
+  if (top < 0.0)
+    kuro->view_y += top;
+  else if (top + kuro->cell_size > height)
+    kuro->view_y += top + kuro->cell_size - height;
+
+  update_viewport(kuro, width, height);
+}
+
+/* Find the cell under the given point in the drawing area, if any */
+static gboolean cell_at_position(Kuro *kuro, gdouble x, gdouble y,
+                                 KuroVector *pos) {
+  gdouble cell_x, cell_y;
+
+  update_viewport_for_widget(kuro);
+  cell_x = floor((x - kuro->drawing_area_x_offset) / kuro->cell_size);
+  cell_y = floor((y - kuro->drawing_area_y_offset) / kuro->cell_size);
+
+  if (cell_x < 0 || cell_y < 0 || cell_x >= kuro->board->size ||
+      cell_y >= kuro->board->size)
+    return FALSE;
+
+  pos->x = (guint16)cell_x;
+  pos->y = (guint16)cell_y;
+
+  return TRUE;
 }
 
 void kuro_draw_cb(GtkDrawingArea *drawing_area, cairo_t *cr, int width,
                   int height, gpointer user_data) {
   Kuro *kuro = (Kuro *)user_data;
-
-  if (kuro->is_paused) {
-    /* When paused, we still draw the board but hide the numbers */
-    /* Continue drawing... */
-  }
-
-  gint area_width = width;
-  gint area_height = height;
-  KuroVector iter;
-  guint board_width, board_height;
+  KuroVector iter, first, last;
   gdouble cell_size;
   gdouble x_pos, y_pos;
+  gint64 start = g_get_monotonic_time();
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
 
-  /* Clamp the width/height to the minimum */
-  if (area_height < area_width) {
-    board_width = area_height;
-    board_height = area_height;
-  } else {
-    board_width = area_width;
-    board_height = area_width;
-  }
-
-  board_width -= BORDER_LEFT;
-  board_height -= BORDER_LEFT;
+  kuro->perf.frame_cells = 0;
+  kuro->perf.frame_layouts = 0;
 
   /* Work out the cell size and scale all text accordingly */
-  cell_size = (gdouble)board_width / (gdouble)kuro->board_size;
+  update_viewport(kuro, width, height);
+  cell_size = kuro->cell_size;
   pango_font_description_set_absolute_size(kuro->normal_font_desc,
                                            cell_size * NORMAL_FONT_SCALE * 0.8 *
                                                PANGO_SCALE);
@@ -794,17 +1570,31 @@ void kuro_draw_cb(GtkDrawingArea *drawing_area, cairo_t *cr, int width,
                                            cell_size * PAINTED_FONT_SCALE *
                                                0.8 * PANGO_SCALE);
 
-  /* Centre the board */
-  kuro->drawing_area_x_offset = (area_width - board_width) / 2.0;
-  kuro->drawing_area_y_offset = (area_height - board_height) / 2.0;
+  /* Keep one layout for all the numbers, rather than making one per cell */
+  if (kuro->cell_layout == NULL)
+    kuro->cell_layout = pango_cairo_create_layout(cr);
+  else
+    pango_cairo_update_layout(cr, kuro->cell_layout);
+
+  cairo_save(cr);
   cairo_translate(cr, kuro->drawing_area_x_offset, kuro->drawing_area_y_offset);
 
+  /* Only visit the cells which intersect the visible part of the board, so
+   * that the cost of a frame doesn't depend on how big the board is */
+  first.x = (guint16)MAX(0.0, floor(-kuro->drawing_area_x_offset / cell_size));
+  first.y = (guint16)MAX(0.0, floor(-kuro->drawing_area_y_offset / cell_size));
+  last.x = (guint16)MIN(kuro->board->size - 1.0,
+                        floor((width - kuro->drawing_area_x_offset) / cell_size));
+  last.y = (guint16)MIN(
+      kuro->board->size - 1.0,
+      floor((height - kuro->drawing_area_y_offset) / cell_size));
+
   /* Draw the unpainted cells first. */
-  for (iter.x = 0, x_pos = 0; iter.x < kuro->board_size;
+  for (iter.x = first.x, x_pos = first.x * cell_size; iter.x <= last.x;
        iter.x++, x_pos += cell_size) { /* columns (X) */
-    for (iter.y = 0, y_pos = 0; iter.y < kuro->board_size;
+    for (iter.y = first.y, y_pos = first.y * cell_size; iter.y <= last.y;
          iter.y++, y_pos += cell_size) { /* rows (Y) */
-      if (!(kuro->board[iter.x][iter.y].status & CELL_PAINTED)) {
+      if (!(kuro->board->cells[iter.x][iter.y].status & CELL_PAINTED)) {
         draw_cell(kuro, cr, cell_size, x_pos, y_pos, iter);
       }
     }
@@ -812,11 +1602,11 @@ void kuro_draw_cb(GtkDrawingArea *drawing_area, cairo_t *cr, int width,
 
   /* Next draw the painted cells (so that their borders are painted over those
    * of the unpainted cells).. */
-  for (iter.x = 0, x_pos = 0; iter.x < kuro->board_size;
+  for (iter.x = first.x, x_pos = first.x * cell_size; iter.x <= last.x;
        iter.x++, x_pos += cell_size) { /* columns (X) */
-    for (iter.y = 0, y_pos = 0; iter.y < kuro->board_size;
+    for (iter.y = first.y, y_pos = first.y * cell_size; iter.y <= last.y;
          iter.y++, y_pos += cell_size) { /* rows (Y) */
-      if (kuro->board[iter.x][iter.y].status & CELL_PAINTED) {
+      if (kuro->board->cells[iter.x][iter.y].status & CELL_PAINTED) {
         draw_cell(kuro, cr, cell_size, x_pos, y_pos, iter);
       }
     }
@@ -833,92 +1623,267 @@ void kuro_draw_cb(GtkDrawingArea *drawing_area, cairo_t *cr, int width,
                     cell_size - line_width, cell_size - line_width);
     cairo_stroke(cr);
   }
+
+  cairo_restore(cr);
+
+  kuro_perf_ring_add(&kuro->perf.draw_time, g_get_monotonic_time() - start);
+  kuro_perf_ring_add(&kuro->perf.cells_drawn, kuro->perf.frame_cells);
+  kuro_perf_ring_add(&kuro->perf.layouts, kuro->perf.frame_layouts);
+
+  KURO_PROFILER_SET_COUNTER(KURO_PROFILER_COUNTER_CELLS_DRAWN,
+                            kuro->perf.frame_cells);
+  KURO_PROFILER_SET_COUNTER(KURO_PROFILER_COUNTER_LAYOUTS,
+                            kuro->perf.frame_layouts);
+  KURO_PROFILER_ADD_MARK(begin, "Draw", NULL);
+
+  if (kuro->show_perf_overlay)
+    draw_perf_overlay(kuro, cr);
+
+  if (kuro->startup_time != 0) {
+    kuro_startup_trace(kuro, "First frame");
+    kuro->startup_time = 0;
+  }
 }
 
-static void kuro_update_cell_state(Kuro *kuro, KuroVector pos, gboolean tag1,
-                                   gboolean tag2) {
-  KuroUndo *undo;
-  gboolean recheck = FALSE;
+static const gchar *describe_dead_end(KuroDeadEnd dead_end) {
+  switch (dead_end) {
+  case KURO_DEAD_END_CONFLICT:
+    return _("This board can’t be solved any more: a cell would have to be "
+             "both painted and unpainted");
+  case KURO_DEAD_END_DUPLICATE:
+    return _("This board can’t be solved any more: a number would have to "
+             "stay unpainted twice in the same row or column");
+  case KURO_DEAD_END_DISCONNECTED:
+    return _("This board can’t be solved any more: the painted cells would "
+             "cut the unpainted ones in two");
+  case KURO_DEAD_END_NONE:
+  default:
+    g_assert_not_reached();
+    return NULL;
+  }
+}
+
+/* Let the player know when they've painted themselves into a corner, once
+ * each time it happens, and move the cursor to where it shows up */
+static void warn_dead_end(Kuro *kuro) {
+  KuroVector cell;
+  KuroDeadEnd dead_end =
+      kuro_propagator_get_dead_end(kuro->propagator, &cell);
+
+  if (dead_end != KURO_DEAD_END_NONE && kuro->dead_end == KURO_DEAD_END_NONE) {
+    kuro->cursor_position = cell;
+    adw_toast_overlay_add_toast(ADW_TOAST_OVERLAY(kuro->toast_overlay),
+                                adw_toast_new(describe_dead_end(dead_end)));
+  }
+
+  kuro->dead_end = dead_end;
+}
+
+/* Validate and redraw once per frame, however many moves and cursor movements
+ * have been made since the last one */
+static gboolean flush_input_cb(GtkWidget *widget, GdkFrameClock *frame_clock,
+                               gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  kuro->input_tick_id = 0;
+
+  /* Check to see if the player's won, or can't any more */
+  if (kuro->input_recheck && kuro->processing_events) {
+    gint64 start = g_get_monotonic_time();
+
+    kuro_check_win(kuro);
+    kuro_perf_ring_add(&kuro->perf.validation,
+                       g_get_monotonic_time() - start);
+
+    if (kuro->processing_events)
+      warn_dead_end(kuro);
+  }
+  kuro->input_recheck = FALSE;
+
+  /* Redraw */
+  gtk_widget_queue_draw(kuro->drawing_area);
+
+  return G_SOURCE_REMOVE;
+}
 
-  /* Update the undo stack */
-  undo = g_new(KuroUndo, 1);
-  undo->cell = pos;
-  undo->undo = kuro->undo_stack;
-  undo->redo = NULL;
+static void queue_input_flush(Kuro *kuro, gboolean recheck) {
+  kuro->input_recheck |= recheck;
 
+  if (kuro->input_tick_id == 0)
+    kuro->input_tick_id = gtk_widget_add_tick_callback(
+        kuro->drawing_area, flush_input_cb, kuro, NULL);
+}
+
+static KuroUndoType move_type(gboolean tag1, gboolean tag2) {
   if (tag1 && tag2) {
     /* Update both tags' state */
-    kuro->board[pos.x][pos.y].status ^= CELL_TAG1;
-    kuro->board[pos.x][pos.y].status ^= CELL_TAG2;
-    undo->type = UNDO_TAGS;
+    return UNDO_TAGS;
   } else if (tag1) {
     /* Update tag 1's state */
-    kuro->board[pos.x][pos.y].status ^= CELL_TAG1;
-    undo->type = UNDO_TAG1;
+    return UNDO_TAG1;
   } else if (tag2) {
     /* Update tag 2's state */
-    kuro->board[pos.x][pos.y].status ^= CELL_TAG2;
-    undo->type = UNDO_TAG2;
+    return UNDO_TAG2;
   } else {
     /* Update the paint overlay */
-    kuro->board[pos.x][pos.y].status ^= CELL_PAINTED;
-    undo->type = UNDO_PAINT;
-    recheck = TRUE;
+    return UNDO_PAINT;
   }
+}
 
-  kuro->made_a_move = TRUE;
-
-  if (kuro->undo_stack != NULL) {
-    KuroUndo *i, *next = NULL;
+/* The bits of a cell's status which a move of @type changes */
+static guchar move_status_mask(KuroUndoType type) {
+  switch (type) {
+  case UNDO_PAINT:
+    return CELL_PAINTED;
+  case UNDO_TAG1:
+    return CELL_TAG1;
+  case UNDO_TAG2:
+    return CELL_TAG2;
+  case UNDO_TAGS:
+    return CELL_TAG1 | CELL_TAG2;
+  case UNDO_NEW_GAME:
+  default:
+    g_assert_not_reached();
+    return 0;
+  }
+}
 
-    /* Free the redo stack after this point. */
-    for (i = kuro->undo_stack->redo; i != NULL; i = next) {
-      next = i->redo;
-      g_free(i);
+/* How far from a painted cell the assist looks, and how big a pocket of
+ * unpainted cells it'll look for, so it costs the same on any board */
+#define ASSIST_RADIUS 2
+#define ASSIST_BUDGET 16
+
+/* Tag the cells which painting @pos has forced to stay unpainted: its
+ * neighbours, and any cells nearby which would now shut others off if they
+ * were painted. The tags are undone along with the move. */
+static void assist_move(Kuro *kuro, KuroVector pos) {
+  gboolean grouping = kuro->undo_stack->grouping;
+  gint dx, dy;
+
+  if (!grouping)
+    kuro_undo_continue_group(kuro->undo_stack);
+
+  for (dx = -ASSIST_RADIUS; dx <= ASSIST_RADIUS; dx++) {
+    for (dy = -ASSIST_RADIUS; dy <= ASSIST_RADIUS; dy++) {
+      gint x = (gint)pos.x + dx, y = (gint)pos.y + dy;
+      KuroVector cell;
+
+      if (x < 0 || y < 0 || x >= (gint)kuro->board->size ||
+          y >= (gint)kuro->board->size ||
+          kuro->board->cells[x][y].status & (CELL_PAINTED | CELL_TAG1))
+        continue;
+
+      cell.x = (guint16)x;
+      cell.y = (guint16)y;
+      if (ABS(dx) + ABS(dy) == 1 ||
+          kuro_propagator_is_cut(kuro->propagator, cell, ASSIST_BUDGET)) {
+        kuro_undo_push(kuro->undo_stack, UNDO_TAG1, cell);
+        kuro_undo_apply(kuro->undo_stack->current, kuro->board);
+      }
     }
+  }
 
-    kuro->undo_stack->redo = undo;
+  if (!grouping)
+    kuro_undo_end_group(kuro->undo_stack);
+}
+
+static void make_move(Kuro *kuro, KuroVector pos, KuroUndoType type) {
+  /* Update the undo stack, then make the move it describes */
+  kuro_undo_push(kuro->undo_stack, type, pos);
+  kuro_undo_apply(kuro->undo_stack->current, kuro->board);
+  if (type == UNDO_PAINT) {
+    kuro_propagator_update(kuro->propagator, pos);
+    if (kuro->assist && kuro->board->cells[pos.x][pos.y].status & CELL_PAINTED)
+      assist_move(kuro, pos);
   }
-  kuro->undo_stack = undo;
+
+  kuro->made_a_move = TRUE;
+  kuro->n_moves++;
+
   g_simple_action_set_enabled(kuro->undo_action, TRUE);
   g_simple_action_set_enabled(kuro->redo_action, FALSE);
 
-  /* Stop any current hints */
+  /* Stop any current hints, and get the next one ready while the player
+   * thinks */
   kuro_cancel_hinting(kuro);
+  kuro_queue_next_hint(kuro);
 
-  /* Redraw */
-  gtk_widget_queue_draw(kuro->drawing_area);
+  /* Only painting can win the game */
+  queue_input_flush(kuro, type == UNDO_PAINT);
+}
 
-  /* Check to see if the player's won */
-  if (recheck == TRUE)
-    kuro_check_win(kuro);
+static void kuro_update_cell_state(Kuro *kuro, KuroVector pos, gboolean tag1,
+                                   gboolean tag2) {
+  make_move(kuro, pos, move_type(tag1, tag2));
 }
 
-static void kuro_click_released_cb(GtkGestureClick *gesture, int n_press,
-                                   double x, double y, gpointer user_data) {
-  Kuro *kuro = (Kuro *)user_data;
-  gint width, height;
-  gdouble cell_size;
-  KuroVector pos;
-  GdkModifierType state;
+/* Change a cell swept over by a drag, if it's in the state the first cell was
+ * in. Each cell is only changed once per sweep. */
+static void sweep_cell(Kuro *kuro, KuroVector pos) {
+  guint index = pos.x * kuro->board->size + pos.y;
+  guchar mask = move_status_mask(kuro->sweep_type);
 
-  if (kuro->processing_events == FALSE)
+  if (kuro->swept[index])
+    return;
+  kuro->swept[index] = TRUE;
+
+  if ((kuro->board->cells[pos.x][pos.y].status & mask) == kuro->sweep_from)
+    make_move(kuro, pos, kuro->sweep_type);
+}
+
+/* Change the cell the drag started on, as one undo step with the rest of the
+ * sweep */
+static void start_sweep(Kuro *kuro) {
+  KuroVector first = kuro->sweep_first;
+
+  kuro->sweep_started = TRUE;
+  kuro->sweep_from = kuro->board->cells[first.x][first.y].status &
+                     move_status_mask(kuro->sweep_type);
+
+  kuro_undo_begin_group(kuro->undo_stack);
+  sweep_cell(kuro, first);
+}
+
+/* Close the sweep's undo step. Anything else which changes the board during a
+ * drag ends the sweep first, so that it doesn't get chained onto it. */
+static void end_sweep(Kuro *kuro) {
+  if (!kuro->sweeping)
     return;
 
-  width = gtk_widget_get_width(kuro->drawing_area);
-  height = gtk_widget_get_height(kuro->drawing_area);
+  if (kuro->sweep_started)
+    kuro_undo_end_group(kuro->undo_stack);
+  kuro->sweeping = FALSE;
+}
+
+/* Sweep over every cell on the line to @pos, so that fast drags which skip
+ * across cells between events don't leave gaps */
+static void sweep_to(Kuro *kuro, KuroVector pos) {
+  KuroVector last = kuro->sweep_last, cell;
+  gint dx = (gint)pos.x - (gint)last.x;
+  gint dy = (gint)pos.y - (gint)last.y;
+  gint i, steps = MAX(ABS(dx), ABS(dy));
+
+  for (i = 1; i <= steps; i++) {
+    cell.x = (guint16)floor(last.x + (gdouble)dx * i / steps + 0.5);
+    cell.y = (guint16)floor(last.y + (gdouble)dy * i / steps + 0.5);
+    sweep_cell(kuro, cell);
+  }
 
-  /* Clamp the width/height to the minimum */
-  if (height < width)
-    width = height;
+  kuro->sweep_last = pos;
+}
 
-  cell_size = (gdouble)width / (gdouble)kuro->board_size;
+static void kuro_paint_begin_cb(GtkGestureDrag *gesture, double x, double y,
+                                gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  KuroVector pos;
+  GdkModifierType state;
+  guint n_cells;
 
-  /* Determine the cell in which the button was released */
-  pos.x = (guchar)((x - kuro->drawing_area_x_offset) / cell_size);
-  pos.y = (guchar)((y - kuro->drawing_area_y_offset) / cell_size);
+  if (kuro->processing_events == FALSE)
+    return;
 
-  if (pos.x >= kuro->board_size || pos.y >= kuro->board_size)
+  /* Determine the cell in which the button was pressed */
+  if (!cell_at_position(kuro, x, y, &pos))
     return;
 
   /* Move the cursor to the clicked cell and deactivate it
@@ -933,8 +1898,140 @@ static void kuro_click_released_cb(GtkGestureClick *gesture, int n_press,
   state = gtk_event_controller_get_current_event_state(
       GTK_EVENT_CONTROLLER(gesture));
 
-  kuro_update_cell_state(kuro, pos, state & GDK_SHIFT_MASK,
-                         state & GDK_CONTROL_MASK);
+  kuro->sweeping = TRUE;
+  kuro->sweep_started = FALSE;
+  kuro->sweep_type = move_type(state & GDK_SHIFT_MASK, state & GDK_CONTROL_MASK);
+  kuro->sweep_first = kuro->sweep_last = pos;
+  kuro->sweep_x = x;
+  kuro->sweep_y = y;
+
+  n_cells = kuro->board->size * kuro->board->size;
+  if (kuro->n_swept != n_cells) {
+    g_free(kuro->swept);
+    kuro->swept = g_new(gboolean, n_cells);
+    kuro->n_swept = n_cells;
+  }
+  memset(kuro->swept, 0, sizeof(gboolean) * n_cells);
+}
+
+static void kuro_paint_update_cb(GtkGestureDrag *gesture, double x, double y,
+                                 gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  KuroVector pos;
+
+  if (!kuro->sweeping || kuro->processing_events == FALSE)
+    return;
+
+  /* Nothing happens until the pointer leaves the cell it was pressed in, so
+   * that a click still only changes the cell when it's released */
+  if (!cell_at_position(kuro, kuro->sweep_x + x, kuro->sweep_y + y, &pos) ||
+      (pos.x == kuro->sweep_last.x && pos.y == kuro->sweep_last.y))
+    return;
+
+  if (!kuro->sweep_started)
+    start_sweep(kuro);
+  sweep_to(kuro, pos);
+
+  kuro->cursor_position = pos;
+}
+
+static void kuro_paint_end_cb(GtkGestureDrag *gesture, double x, double y,
+                              gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  if (!kuro->sweeping)
+    return;
+
+  if (!kuro->sweep_started && kuro->processing_events)
+    start_sweep(kuro);
+
+  end_sweep(kuro);
+}
+
+static void kuro_motion_cb(GtkEventControllerMotion *controller, double x,
+                           double y, gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  /* Remember where the pointer is so that keyboard zooming can anchor to it */
+  kuro->pointer_x = x;
+  kuro->pointer_y = y;
+}
+
+static void kuro_leave_cb(GtkEventControllerMotion *controller,
+                          gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  kuro->pointer_x = kuro->pointer_y = -1.0;
+}
+
+static gboolean kuro_scroll_cb(GtkEventControllerScroll *controller, double dx,
+                               double dy, gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  GdkModifierType state;
+
+  state = gtk_event_controller_get_current_event_state(
+      GTK_EVENT_CONTROLLER(controller));
+
+  /* Ctrl+scroll zooms around the pointer; plain scrolling pans */
+  if (state & GDK_CONTROL_MASK) {
+    update_viewport_for_widget(kuro);
+    zoom_viewport(kuro, kuro->zoom * pow(ZOOM_STEP, -dy), kuro->pointer_x,
+                  kuro->pointer_y);
+    return TRUE;
+  }
+
+  if (kuro->zoom <= 1.0)
+    return FALSE;
+
+  if (gtk_event_controller_scroll_get_unit(controller) == GDK_SCROLL_UNIT_WHEEL)
+    pan_viewport(kuro, dx * SCROLL_STEP, dy * SCROLL_STEP);
+  else
+    pan_viewport(kuro, dx, dy);
+
+  return TRUE;
+}
+
+static void kuro_zoom_begin_cb(GtkGesture *gesture,
+                               GdkEventSequence *sequence, gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  kuro->gesture_zoom = kuro->zoom;
+  gtk_gesture_get_bounding_box_center(gesture, &kuro->gesture_x,
+                                      &kuro->gesture_y);
+}
+
+static void kuro_zoom_scale_changed_cb(GtkGestureZoom *gesture, double scale,
+                                       gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+  gdouble x, y;
+
+  if (!gtk_gesture_get_bounding_box_center(GTK_GESTURE(gesture), &x, &y))
+    return;
+
+  /* Follow the fingers as well as pinching */
+  kuro->view_x += kuro->gesture_x - x;
+  kuro->view_y += kuro->gesture_y - y;
+  kuro->gesture_x = x;
+  kuro->gesture_y = y;
+
+  zoom_viewport(kuro, kuro->gesture_zoom * scale, x, y);
+}
+
+static void kuro_drag_begin_cb(GtkGestureDrag *gesture, double x, double y,
+                               gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  /* Remember where the view started, so the drag offset can be applied to it */
+  kuro->gesture_x = kuro->view_x;
+  kuro->gesture_y = kuro->view_y;
+}
+
+static void kuro_drag_update_cb(GtkGestureDrag *gesture, double x, double y,
+                                gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  pan_viewport(kuro, kuro->gesture_x - x - kuro->view_x,
+               kuro->gesture_y - y - kuro->view_y);
 }
 
 static gboolean kuro_key_pressed_cb(GtkEventControllerKey *controller,
@@ -973,6 +2070,7 @@ static gboolean kuro_key_pressed_cb(GtkEventControllerKey *controller,
     if (!kuro->cursor_active) {
       kuro->cursor_active = TRUE;
     } else {
+      end_sweep(kuro);
       kuro_update_cell_state(kuro, kuro->cursor_position,
                              state & GDK_SHIFT_MASK, state & GDK_CONTROL_MASK);
     }
@@ -989,17 +2087,20 @@ static gboolean kuro_key_pressed_cb(GtkEventControllerKey *controller,
       gint new_x = (gint)kuro->cursor_position.x + dx;
       gint new_y = (gint)kuro->cursor_position.y + dy;
 
-      if (new_x >= 0 && new_x < kuro->board_size)
-        kuro->cursor_position.x = (guchar)new_x;
-      if (new_y >= 0 && new_y < kuro->board_size)
-        kuro->cursor_position.y = (guchar)new_y;
+      if (new_x >= 0 && new_x < kuro->board->size)
+        kuro->cursor_position.x = (guint16)new_x;
+      if (new_y >= 0 && new_y < kuro->board->size)
+        kuro->cursor_position.y = (guint16)new_y;
+
+      /* Keep the cursor on screen when zoomed in */
+      scroll_to_cell(kuro, kuro->cursor_position);
     }
   }
 
-  if (did_something) {
-    /* Redraw */
-    gtk_widget_queue_draw(kuro->drawing_area);
-  }
+  /* Auto-repeated keys can arrive faster than frames, so redraw once per
+   * frame rather than once per key */
+  if (did_something)
+    queue_input_flush(kuro, FALSE);
 
   return did_something;
 }
@@ -1017,7 +2118,7 @@ static void quit_cb(GSimpleAction *action, GVariant *parameters,
 static void new_game_cb(GSimpleAction *action, GVariant *parameters,
                         gpointer user_data) {
   KuroApplication *self = KURO_APPLICATION(user_data);
-  kuro_new_game(self, self->board_size);
+  kuro_new_game(self, self->board->size);
 }
 
 static void kuro_cancel_hinting(Kuro *kuro) {
@@ -1026,7 +2127,7 @@ static void kuro_cancel_hinting(Kuro *kuro) {
 
   kuro->hint_status = HINT_DISABLED;
   if (kuro->hint_timeout_id != 0)
-    g_source_remove(kuro->hint_timeout_id);
+    kuro_scheduler_remove(kuro->scheduler, kuro->hint_timeout_id);
   kuro->hint_timeout_id = 0;
 }
 
@@ -1053,132 +2154,131 @@ static gboolean kuro_update_hint(Kuro *kuro) {
   return TRUE;
 }
 
+/* Why a hinted cell has to be painted, for the player */
+static const gchar *describe_hint(KuroHintTechnique technique) {
+  switch (technique) {
+  case KURO_HINT_REPEATED:
+    return _("This cell repeats a number which has to stay unpainted");
+  case KURO_HINT_SANDWICH:
+    return _("A number between or beside two of its twins has to stay "
+             "unpainted, so this cell has to be painted");
+  case KURO_HINT_PAIR:
+    return _("One of a pair of matching numbers next to each other has to "
+             "stay unpainted, so this cell has to be painted");
+  case KURO_HINT_CONNECTIVITY:
+    return _("Painting some cells would cut the board in two, so this cell "
+             "has to be painted");
+  case KURO_HINT_CONTRADICTION:
+    return _("Leaving this cell unpainted leads to a contradiction");
+  case KURO_HINT_SOLUTION:
+    return _("Nothing more can be worked out, so this cell is from the "
+             "solution");
+  case KURO_HINT_MISTAKE:
+    return _("This cell shouldn’t be painted");
+  case KURO_HINT_NONE:
+  default:
+    g_assert_not_reached();
+    return NULL;
+  }
+}
+
 static void hint_cb(GSimpleAction *action, GVariant *parameter,
                     gpointer user_data) {
   KuroApplication *self = KURO_APPLICATION(user_data);
-  KuroVector iter;
+  KuroHint hint;
 
   /* Bail if we're already hinting */
   if (self->hint_status != HINT_DISABLED)
     return;
 
-  /* Find the first cell which should be painted, but isn't (or vice-versa) */
-  for (iter.x = 0; iter.x < self->board_size; iter.x++) {
-    for (iter.y = 0; iter.y < self->board_size; iter.y++) {
-      guchar status = self->board[iter.x][iter.y].status &
-                      (CELL_PAINTED | CELL_SHOULD_BE_PAINTED);
-
-      if (status <= MAX(CELL_SHOULD_BE_PAINTED, CELL_PAINTED) && status > 0) {
-        if (self->debug)
-          g_debug("Beginning hinting in cell (%u,%u).", iter.x, iter.y);
+  /* Find the next cell which can be worked out from the painted ones. This
+   * has usually been done in the background already; if it's still going on
+   * a big board, this is activated again once it's done. */
+  if (!kuro_get_next_hint(self, &hint))
+    return;
 
-        /* Set up the cell for hinting */
-        self->hint_status = HINT_FLASHES;
-        self->hint_position = iter;
-        self->hint_timeout_id =
-            g_timeout_add(HINT_INTERVAL, (GSourceFunc)kuro_update_hint, self);
-        kuro_update_hint((gpointer)self);
+  if (self->debug)
+    g_debug("Beginning hinting in cell (%u,%u) using %s.", hint.cell.x,
+            hint.cell.y, kuro_hint_technique_name(hint.technique));
+
+  /* Set up the cell for hinting */
+  self->hint_status = HINT_FLASHES;
+  self->hint_position = hint.cell;
+  self->n_hints++;
+  scroll_to_cell(self, hint.cell);
+  self->hint_timeout_id = kuro_scheduler_add_timeout(
+      self->scheduler, KURO_TASK_ANIMATION, HINT_INTERVAL,
+      (GSourceFunc)kuro_update_hint, self);
+  kuro_update_hint((gpointer)self);
+
+  adw_toast_overlay_add_toast(ADW_TOAST_OVERLAY(self->toast_overlay),
+                              adw_toast_new(describe_hint(hint.technique)));
+}
 
-        return;
-      }
-    }
+/* Catch the propagator up with the moves from @first to @last, which have
+ * just been undone or redone */
+static void propagate_moves(Kuro *kuro, const KuroUndo *first,
+                            const KuroUndo *last) {
+  const KuroUndo *move;
+
+  for (move = first; move != NULL; move = move->redo) {
+    if (move->type == UNDO_PAINT)
+      kuro_propagator_update(kuro->propagator, move->cell);
+    if (move == last)
+      break;
   }
 }
 
 static void undo_cb(GSimpleAction *action, GVariant *parameter,
                     gpointer user_data) {
   KuroApplication *self = KURO_APPLICATION(user_data);
+  const KuroUndo *undone, *last = self->undo_stack->current;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
 
-  if (self->undo_stack->undo == NULL)
+  end_sweep(self);
+  undone = kuro_undo_step_back(self->undo_stack, self->board);
+  if (undone == NULL)
     return;
 
-  switch (self->undo_stack->type) {
-  case UNDO_PAINT:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_PAINTED;
-    break;
-  case UNDO_TAG1:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG1;
-    break;
-  case UNDO_TAG2:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG2;
-    break;
-  case UNDO_TAGS:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG1;
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG2;
-    break;
-  case UNDO_NEW_GAME:
-  default:
-    /* This is just here to stop the compiler warning */
-    g_assert_not_reached();
-    break;
-  }
-
-  self->cursor_position = self->undo_stack->cell;
-  self->undo_stack = self->undo_stack->undo;
+  propagate_moves(self, undone, last);
+  self->cursor_position = undone->cell;
+  kuro_queue_next_hint(self);
 
   g_simple_action_set_enabled(self->redo_action, TRUE);
-  if (self->undo_stack->undo == NULL || self->undo_stack->type == UNDO_NEW_GAME)
+  if (self->undo_stack->current->type == UNDO_NEW_GAME)
     g_simple_action_set_enabled(self->undo_action, FALSE);
 
   /* The player can't possibly have won, but we need to update the error
    * highlighting */
-  kuro_check_win(self);
+  queue_input_flush(self, TRUE);
 
-  /* Redraw */
-  gtk_widget_queue_draw(self->drawing_area);
+  KURO_PROFILER_ADD_MARK(begin, "Undo", NULL);
 }
 
 static void redo_cb(GSimpleAction *action, GVariant *parameter,
                     gpointer user_data) {
   KuroApplication *self = KURO_APPLICATION(user_data);
+  const KuroUndo *redone, *first = self->undo_stack->current->redo;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
 
-  if (self->undo_stack->redo == NULL)
+  end_sweep(self);
+  redone = kuro_undo_step_forward(self->undo_stack, self->board);
+  if (redone == NULL)
     return;
 
-  self->undo_stack = self->undo_stack->redo;
-  self->cursor_position = self->undo_stack->cell;
-
-  switch (self->undo_stack->type) {
-  case UNDO_PAINT:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_PAINTED;
-    break;
-  case UNDO_TAG1:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG1;
-    break;
-  case UNDO_TAG2:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG2;
-    break;
-  case UNDO_TAGS:
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG1;
-    self->board[self->undo_stack->cell.x][self->undo_stack->cell.y].status ^=
-        CELL_TAG2;
-    break;
-  case UNDO_NEW_GAME:
-  default:
-    /* This is just here to stop the compiler warning */
-    g_assert_not_reached();
-    break;
-  }
+  propagate_moves(self, first, redone);
+  self->cursor_position = redone->cell;
+  kuro_queue_next_hint(self);
 
   g_simple_action_set_enabled(self->undo_action, TRUE);
-  if (self->undo_stack->redo == NULL)
+  if (redone->redo == NULL)
     g_simple_action_set_enabled(self->redo_action, FALSE);
 
   /* The player can't possibly have won, but we need to update the error
    * highlighting */
-  kuro_check_win(self);
+  queue_input_flush(self, TRUE);
 
-  /* Redraw */
-  gtk_widget_queue_draw(self->drawing_area);
+  KURO_PROFILER_ADD_MARK(begin, "Redo", NULL);
 }
 
 static void pause_cb(GSimpleAction *action, GVariant *parameter,
@@ -1394,6 +2494,61 @@ static void about_cb(GSimpleAction *action, GVariant *parameters,
   adw_dialog_present(ADW_DIALOG(about), GTK_WIDGET(self->window));
 }
 
+/* Keyboard zooming anchors to the pointer if it's over the board, and to the
+ * middle of the board otherwise */
+static void zoom_by(Kuro *kuro, gdouble factor) {
+  gdouble x = kuro->pointer_x, y = kuro->pointer_y;
+  gint width = gtk_widget_get_width(kuro->drawing_area);
+  gint height = gtk_widget_get_height(kuro->drawing_area);
+
+  if (x <= 0.0 || y <= 0.0 || x >= width || y >= height) {
+    x = width / 2.0;
+    y = height / 2.0;
+  }
+
+  update_viewport(kuro, width, height);
+  zoom_viewport(kuro, kuro->zoom * factor, x, y);
+}
+
+static void zoom_in_cb(GSimpleAction *action, GVariant *parameter,
+                       gpointer user_data) {
+  zoom_by(KURO_APPLICATION(user_data), ZOOM_STEP);
+}
+
+static void zoom_out_cb(GSimpleAction *action, GVariant *parameter,
+                        gpointer user_data) {
+  zoom_by(KURO_APPLICATION(user_data), 1.0 / ZOOM_STEP);
+}
+
+static void zoom_reset_cb(GSimpleAction *action, GVariant *parameter,
+                          gpointer user_data) {
+  KuroApplication *self = KURO_APPLICATION(user_data);
+
+  /* Back to the default for the board size */
+  self->zoom = 0.0;
+  self->view_x = self->view_y = 0.0;
+  gtk_widget_queue_draw(self->drawing_area);
+}
+
+static void perf_overlay_cb(GSimpleAction *action, GVariant *parameter,
+                            gpointer user_data) {
+  KuroApplication *self = KURO_APPLICATION(user_data);
+  GVariant *state;
+
+  state = g_action_get_state(G_ACTION(action));
+  self->show_perf_overlay = !g_variant_get_boolean(state);
+  g_variant_unref(state);
+
+  g_simple_action_set_state(action,
+                            g_variant_new_boolean(self->show_perf_overlay));
+
+  /* Start the figures afresh, so they reflect what's on screen now */
+  if (self->show_perf_overlay)
+    kuro_perf_reset(&self->perf);
+
+  gtk_widget_queue_draw(self->drawing_area);
+}
+
 static void show_help_overlay_cb(GSimpleAction *action, GVariant *parameter,
                                  gpointer user_data) {
   KuroApplication *self = KURO_APPLICATION(user_data);
@@ -1402,7 +2557,7 @@ static void show_help_overlay_cb(GSimpleAction *action, GVariant *parameter,
 
   builder = gtk_builder_new_from_resource(
       g_strconcat("/", g_strdelimit(g_strdup(APPLICATION_ID), ".", '/'),
-                  "/gtk/help-overlay.ui", NULL));
+                  "/ui/help-overlay.ui", NULL));
   overlay = gtk_builder_get_object(builder, "help_overlay");
 
   if (overlay && ADW_IS_DIALOG(overlay)) {
@@ -1479,6 +2634,13 @@ static void board_theme_change_cb(GSettings *settings, const gchar *key,
   }
 }
 
+static void assist_change_cb(GSettings *settings, const gchar *key,
+                             gpointer user_data) {
+  KuroApplication *self = KURO_APPLICATION(user_data);
+
+  self->assist = g_settings_get_boolean(self->settings, "assist");
+}
+
 static void style_manager_dark_changed_cb(AdwStyleManager *style_manager,
                                           GParamSpec *pspec,
                                           gpointer user_data) {
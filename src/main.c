@@ -19,15 +19,26 @@
 
 #include <adwaita.h>
 #include <config.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
 #include <glib/gi18n.h>
 #include <glib/gprintf.h>
 #include <gtk/gtk.h>
 #include <locale.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include "batch.h"
+#include "count.h"
+#include "format.h"
 #include "generator.h"
 #include "interface.h"
 #include "main.h"
+#include "rules.h"
+
+/* The biggest board whose hint is worked out on the spot if the background one
+ * isn't ready; bigger ones could hold up the interface */
+#define SYNC_HINT_MAX_SIZE 20
 
 static void constructed(GObject *object);
 static void get_property(GObject *object, guint property_id, GValue *value,
@@ -35,13 +46,25 @@ static void get_property(GObject *object, guint property_id, GValue *value,
 static void set_property(GObject *object, guint property_id,
                          const GValue *value, GParamSpec *pspec);
 
+static gint handle_local_options(GApplication *application,
+                                 GVariantDict *options);
 static void startup(GApplication *application);
 static void activate(GApplication *application);
+static void scheduler_changed_cb(KuroScheduler *scheduler, gpointer user_data);
 
 typedef struct {
   /* Command line parameters. */
   gboolean debug;
   guint seed;
+  gboolean startup_trace;
+  gchar *solve_path;
+  gchar *convert_path;
+  gchar *puzzle_path;
+  gchar *format;
+
+  KuroBoard *puzzle; /* loaded from puzzle_path, to play first */
+
+  gint64 start_time; /* when the application was created */
 } KuroApplicationPrivate;
 
 typedef enum { PROP_DEBUG = 1, PROP_SEED } KuroProperty;
@@ -51,16 +74,26 @@ G_DEFINE_TYPE_WITH_PRIVATE(KuroApplication, kuro_application,
 
 static void shutdown(GApplication *application) {
   KuroApplication *self = KURO_APPLICATION(application);
+  KuroApplicationPrivate *priv = kuro_application_get_instance_private(self);
+
+  g_clear_pointer(&priv->puzzle, kuro_board_free);
+
+  /* Before the board it's working on goes */
+  g_clear_pointer(&self->hint_worker, kuro_hint_worker_free);
 
   kuro_free_board(self);
-  kuro_clear_undo_stack(self);
-  g_free(self->undo_stack); /* Clear the new game element */
+  g_clear_pointer(&self->undo_stack, kuro_undo_stack_free);
 
   if (self->normal_font_desc != NULL)
     pango_font_description_free(self->normal_font_desc);
   if (self->painted_font_desc != NULL)
     pango_font_description_free(self->painted_font_desc);
+  g_clear_object(&self->cell_layout);
+  g_clear_pointer(&self->swept, g_free);
 
+  g_clear_pointer(&self->scores, kuro_score_store_free);
+  g_clear_pointer(&self->history, kuro_history_close);
+  g_clear_pointer(&self->scheduler, kuro_scheduler_free);
   if (self->settings)
     g_object_unref(self->settings);
 
@@ -76,6 +109,7 @@ static void kuro_application_class_init(KuroApplicationClass *klass) {
   gobject_class->get_property = get_property;
   gobject_class->set_property = set_property;
 
+  gapplication_class->handle_local_options = handle_local_options;
   gapplication_class->startup = startup;
   gapplication_class->shutdown = shutdown;
   gapplication_class->activate = activate;
@@ -101,6 +135,8 @@ static void kuro_application_init(KuroApplication *self) {
 
   priv->debug = FALSE;
   priv->seed = 0;
+  priv->startup_trace = FALSE;
+  priv->start_time = g_get_monotonic_time();
 }
 
 static void constructed(GObject *object) {
@@ -124,6 +160,23 @@ static void constructed(GObject *object) {
          number generation used when creating a board */
       {"seed", 0, 0, G_OPTION_ARG_INT, &(priv->seed),
        N_("Seed the board generation"), NULL},
+      {"startup-trace", 0, 0, G_OPTION_ARG_NONE, &(priv->startup_trace),
+       N_("Print how long each part of starting up takes"), NULL},
+      {"solve", 0, 0, G_OPTION_ARG_FILENAME, &(priv->solve_path),
+       N_("Solve and rate the puzzles in FILE, or standard input if it’s "
+          "‘-’, instead of playing"),
+       N_("FILE")},
+      {"convert", 0, 0, G_OPTION_ARG_FILENAME, &(priv->convert_path),
+       N_("Convert the puzzles in FILE, or standard input if it’s ‘-’, "
+          "instead of playing"),
+       N_("FILE")},
+      /* Translators: Don't translate the format names */
+      {"format", 0, 0, G_OPTION_ARG_STRING, &(priv->format),
+       N_("Write solved puzzles as csv (the default) or json, and converted "
+          "ones as plain, singles or kuro (the default)"),
+       N_("FORMAT")},
+      {"puzzle", 0, 0, G_OPTION_ARG_FILENAME, &(priv->puzzle_path),
+       N_("Play the first puzzle in FILE"), N_("FILE")},
       {NULL}};
 
   g_application_add_main_option_entries(G_APPLICATION(object), options);
@@ -189,18 +242,297 @@ static void debug_handler(const char *log_domain, GLogLevelFlags log_level,
   }
 }
 
+/* Puzzles being read from a file or standard input */
+typedef struct {
+  KuroFormatReader reader;
+  GBytes *bytes;
+  GInputStream *stream;
+} PuzzleInput;
+
+/* Start reading the puzzles in @path, or standard input if it's "-". Files
+ * are mapped rather than read, so they're parsed where they lie; standard
+ * input is read a chunk at a time, so only the puzzle being read is held. */
+static gboolean open_puzzles(PuzzleInput *input, const gchar *path,
+                             GError **error) {
+  GMappedFile *mapped;
+  const gchar *data;
+  gsize length;
+
+  input->bytes = NULL;
+  input->stream = NULL;
+
+  if (g_strcmp0(path, "-") == 0) {
+    input->stream = g_unix_input_stream_new(STDIN_FILENO, FALSE);
+    kuro_format_reader_init_stream(&input->reader, input->stream, 0);
+    return TRUE;
+  }
+
+  mapped = g_mapped_file_new(path, FALSE, error);
+  if (mapped == NULL)
+    return FALSE;
+
+  input->bytes = g_mapped_file_get_bytes(mapped);
+  g_mapped_file_unref(mapped);
+
+  data = g_bytes_get_data(input->bytes, &length);
+  kuro_format_reader_init(&input->reader, data, length);
+  return TRUE;
+}
+
+static void close_puzzles(PuzzleInput *input) {
+  kuro_format_reader_clear(&input->reader);
+  g_clear_object(&input->stream);
+  g_clear_pointer(&input->bytes, g_bytes_unref);
+}
+
+/* Solve the puzzles in @path, writing a line for each to standard output and
+ * how it went to standard error. Returns the exit status. */
+static gint solve_puzzles(const gchar *path, const gchar *format) {
+  KuroBatchOptions options = {KURO_BATCH_CSV, 0, 0};
+  KuroBatchStats stats;
+  PuzzleInput input;
+  GOutputStream *stdout_stream, *output;
+  GError *error = NULL;
+  gboolean success;
+
+  if (g_strcmp0(format, "json") == 0) {
+    options.format = KURO_BATCH_JSON;
+  } else if (format != NULL && g_strcmp0(format, "csv") != 0) {
+    g_printerr(_("Unknown output format ‘%s’\n"), format);
+    return EXIT_FAILURE;
+  }
+
+  if (!open_puzzles(&input, path, &error)) {
+    g_printerr("%s\n", error->message);
+    g_error_free(error);
+    return EXIT_FAILURE;
+  }
+
+  stdout_stream = g_unix_output_stream_new(STDOUT_FILENO, FALSE);
+  output = g_buffered_output_stream_new(stdout_stream);
+
+  success = kuro_batch_run(&input.reader, output, &options, &stats, &error) &&
+            g_output_stream_flush(output, NULL, &error);
+
+  g_object_unref(output);
+  g_object_unref(stdout_stream);
+  close_puzzles(&input);
+
+  if (!success) {
+    g_printerr("%s\n", error->message);
+    g_error_free(error);
+  }
+
+  g_printerr("%" G_GUINT64_FORMAT " puzzles in %.2f s, %.0f per second: %"
+             G_GUINT64_FORMAT " unique, %" G_GUINT64_FORMAT
+             " with several solutions, %" G_GUINT64_FORMAT
+             " unsolvable; %.0f µs solving each\n",
+             stats.n_puzzles, (gdouble)stats.elapsed / G_USEC_PER_SEC,
+             (stats.elapsed > 0) ? (gdouble)stats.n_puzzles * G_USEC_PER_SEC /
+                                       stats.elapsed
+                                 : 0.0,
+             stats.n_unique, stats.n_multiple, stats.n_unsolvable,
+             (stats.n_puzzles > 0)
+                 ? (gdouble)stats.solve_time / stats.n_puzzles
+                 : 0.0);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Write the puzzles in @path to standard output in the format called
+ * @format_name. Returns the exit status. */
+static gint convert_puzzles(const gchar *path, const gchar *format_name) {
+  KuroFormat format = KURO_FORMAT_KURO;
+  PuzzleInput input;
+  GOutputStream *stdout_stream, *output;
+  GError *error = NULL;
+  guint64 n_puzzles;
+  gboolean success;
+
+  if (format_name != NULL && !kuro_format_from_name(format_name, &format)) {
+    g_printerr(_("Unknown puzzle format ‘%s’\n"), format_name);
+    return EXIT_FAILURE;
+  }
+
+  if (!open_puzzles(&input, path, &error)) {
+    g_printerr("%s\n", error->message);
+    g_error_free(error);
+    return EXIT_FAILURE;
+  }
+
+  stdout_stream = g_unix_output_stream_new(STDOUT_FILENO, FALSE);
+  output = g_buffered_output_stream_new(stdout_stream);
+
+  success = kuro_format_convert(&input.reader, output, format, &n_puzzles,
+                                &error) &&
+            g_output_stream_flush(output, NULL, &error);
+
+  g_object_unref(output);
+  g_object_unref(stdout_stream);
+  close_puzzles(&input);
+
+  if (!success) {
+    g_printerr("%s\n", error->message);
+    g_error_free(error);
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Whether painting the cells marked CELL_SHOULD_BE_PAINTED solves @board */
+static gboolean check_solution(const KuroBoard *board) {
+  KuroBoard *solved = kuro_board_copy(board);
+  KuroVector iter;
+  gboolean solves;
+
+  for (iter.x = 0; iter.x < solved->size; iter.x++) {
+    for (iter.y = 0; iter.y < solved->size; iter.y++) {
+      if (solved->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED)
+        kuro_board_toggle(solved, iter, CELL_PAINTED);
+    }
+  }
+
+  solves = kuro_check_board(solved);
+  kuro_board_free(solved);
+
+  return solves;
+}
+
+/* The first puzzle in @path, with its solution worked out if it didn't come
+ * with a right one, so that hints work */
+static KuroBoard *load_puzzle(const gchar *path, GError **error) {
+  PuzzleInput input;
+  KuroBoard *board;
+  guint64 n_solutions;
+
+  if (!open_puzzles(&input, path, error))
+    return NULL;
+
+  if (!kuro_format_read(&input.reader, &board, error)) {
+    close_puzzles(&input);
+    return NULL;
+  }
+  close_puzzles(&input);
+
+  if (board == NULL) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                _("There’s no puzzle in ‘%s’"), path);
+    return NULL;
+  } else if (input.reader.format == KURO_FORMAT_KURO) {
+    if (check_solution(board))
+      return board;
+    g_printerr(_("The solution given in ‘%s’ is wrong, so it’s been worked "
+                 "out again\n"),
+               path);
+  }
+
+  kuro_count_solve(board, 2, 0, &n_solutions);
+  if (n_solutions == 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                _("The puzzle in ‘%s’ can’t be solved"), path);
+    kuro_board_free(board);
+    return NULL;
+  } else if (n_solutions > 1) {
+    g_printerr(_("The puzzle in ‘%s’ has more than one solution\n"), path);
+  }
+
+  return board;
+}
+
+/* Puzzles are solved and converted without ever registering the application
+ * or opening a window, so it works without a display */
+static gint handle_local_options(GApplication *application,
+                                 GVariantDict *options) {
+  KuroApplicationPrivate *priv;
+  GError *error = NULL;
+  gint status = -1;
+
+  priv = kuro_application_get_instance_private(KURO_APPLICATION(application));
+
+  if (priv->solve_path != NULL) {
+    status = solve_puzzles(priv->solve_path, priv->format);
+  } else if (priv->convert_path != NULL) {
+    status = convert_puzzles(priv->convert_path, priv->format);
+  } else if (priv->puzzle_path != NULL) {
+    priv->puzzle = load_puzzle(priv->puzzle_path, &error);
+    if (priv->puzzle == NULL) {
+      g_printerr("%s\n", error->message);
+      g_error_free(error);
+      status = EXIT_FAILURE;
+    }
+  }
+
+  g_clear_pointer(&priv->solve_path, g_free);
+  g_clear_pointer(&priv->convert_path, g_free);
+  g_clear_pointer(&priv->puzzle_path, g_free);
+  g_clear_pointer(&priv->format, g_free);
+
+  return status;
+}
+
 static void startup(GApplication *application) {
+  KuroApplication *self = KURO_APPLICATION(application);
+  KuroApplicationPrivate *priv;
+
+  priv = kuro_application_get_instance_private(self);
+  if (priv->startup_trace)
+    self->startup_time = priv->start_time;
+
   /* Chain up. */
   G_APPLICATION_CLASS(kuro_application_parent_class)->startup(application);
 
   /* Initialize Libadwaita */
   adw_init();
+  kuro_startup_trace(self, "Startup");
 
   /* Debug log handling */
   g_log_set_handler(G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, (GLogFunc)debug_handler,
                     application);
 }
 
+static void install_board(Kuro *kuro, KuroBoard *board,
+                          gint64 generation_time) {
+  /* Deallocate any previous board */
+  kuro_free_board(kuro);
+
+  kuro->board = board;
+  kuro->propagator = kuro_propagator_new(board);
+  kuro->dead_end = KURO_DEAD_END_NONE;
+  kuro->perf.generation_time = generation_time;
+
+  /* Update things */
+  kuro_enable_events(kuro);
+  kuro_queue_next_hint(kuro);
+}
+
+void kuro_generate_board(Kuro *kuro, guint board_size, guint seed) {
+  KuroBoard *board;
+  gint64 start;
+
+  g_return_if_fail(board_size > 0);
+
+  start = g_get_monotonic_time();
+  board =
+      kuro_generator_new_board_speculative(board_size, seed, 0, kuro->debug);
+  install_board(kuro, board, g_get_monotonic_time() - start);
+}
+
+static gboolean open_history_cb(gpointer user_data) {
+  KuroApplication *self = KURO_APPLICATION(user_data);
+  gchar *history_dir;
+  GError *error = NULL;
+
+  history_dir = g_build_filename(g_get_user_data_dir(), PACKAGE, NULL);
+  self->history = kuro_history_open(history_dir, &error);
+  if (self->history == NULL) {
+    g_warning("Couldn’t open the game history: %s", error->message);
+    g_clear_error(&error);
+  }
+  g_free(history_dir);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void activate(GApplication *application) {
   KuroApplication *self = KURO_APPLICATION(application);
   KuroApplicationPrivate *priv;
@@ -210,34 +542,51 @@ static void activate(GApplication *application) {
   /* Create the interface. */
   if (self->window == NULL) {
     GdkRectangle geometry;
-    KuroUndo *undo;
+    KuroGeneratorJob *generation;
+    KuroBoard *board;
+    gint64 generation_time;
     gboolean window_maximized;
     gchar *size_str;
+    guint board_size;
 
     /* Setup */
     self->debug = priv->debug;
     self->settings = g_settings_new(APPLICATION_ID);
     size_str = g_settings_get_string(self->settings, "board-size");
-    self->board_size = g_ascii_strtoull(size_str, NULL, 10);
+    board_size = g_ascii_strtoull(size_str, NULL, 10);
     g_free(size_str);
 
-    if (self->board_size > MAX_BOARD_SIZE) {
+    if (board_size > MAX_BOARD_SIZE) {
       GVariant *default_size =
           g_settings_get_default_value(self->settings, "board-size");
       g_variant_get(default_size, "s", &size_str);
       g_variant_unref(default_size);
-      self->board_size = g_ascii_strtoull(size_str, NULL, 10);
+      board_size = g_ascii_strtoull(size_str, NULL, 10);
       g_free(size_str);
-      g_assert(self->board_size <= MAX_BOARD_SIZE);
+      g_assert(board_size <= MAX_BOARD_SIZE);
+    }
+
+    /* The board's made while the window is built and shown, unless one was
+     * given on the command line */
+    generation = NULL;
+    if (priv->puzzle == NULL) {
+      generation =
+          kuro_generator_begin_board(board_size, priv->seed, self->debug);
+      kuro_startup_trace(self, "Board generation started");
     }
 
-    undo = g_new0(KuroUndo, 1);
-    undo->type = UNDO_NEW_GAME;
-    self->undo_stack = undo;
+    self->scores = kuro_score_store_new(self->settings);
+    self->scheduler = kuro_scheduler_new(scheduler_changed_cb, self);
+    self->hint_worker = kuro_hint_worker_new(next_hint_cb, self);
+
+    /* The history isn't needed until a game's finished */
+    g_idle_add_full(G_PRIORITY_LOW, open_history_cb, self, NULL);
+
+    self->undo_stack = kuro_undo_stack_new();
 
     /* Showtime! */
     kuro_create_interface(self);
-    kuro_generate_board(self, self->board_size, priv->seed);
+    kuro_startup_trace(self, "Interface built");
 
     /* Restore window position and size */
     window_maximized =
@@ -261,21 +610,121 @@ static void activate(GApplication *application) {
 
     gtk_window_set_application(GTK_WINDOW(self->window), GTK_APPLICATION(self));
     gtk_widget_set_visible(self->window, TRUE);
+    kuro_startup_trace(self, "Window shown");
+
+    /* Nothing can be drawn or clicked until the main loop runs again */
+    if (generation != NULL) {
+      board = kuro_generator_end_board(generation, &generation_time);
+    } else {
+      board = g_steal_pointer(&priv->puzzle);
+      generation_time = 0;
+    }
+    install_board(self, board, generation_time);
+    kuro_startup_trace(self, "Board ready");
   }
 
   /* Bring it to the foreground */
   gtk_window_present(GTK_WINDOW(self->window));
 }
 
+gboolean kuro_check_win(Kuro *kuro) {
+  /* Check to see if all three rules are satisfied yet. If they are, we've
+   * won. */
+  if (kuro_check_board(kuro->board)) {
+    /* Win! */
+    kuro_disable_events(kuro);
+    kuro_record_game(kuro);
+
+    if (kuro_score_is_high_score(kuro->scores, kuro->board->size,
+                                 kuro_get_timer_ms(kuro))) {
+      /* New High Score! */
+      kuro_show_new_high_score_dialog(kuro);
+
+    } else {
+      /* Standard Win */
+      kuro_show_win_dialog(kuro);
+    }
+  }
+
+  return TRUE;
+}
+
+/* The background hint's been worked out */
+static void next_hint_cb(guint64 key, const KuroHint *hint, gboolean found,
+                         gpointer user_data) {
+  Kuro *kuro = (Kuro *)user_data;
+
+  /* Only keep the hint if the board hasn't changed since; otherwise the
+   * worker's already on the board as it is now */
+  if (kuro->board == NULL || key != kuro_board_hash(kuro->board))
+    return;
+
+  kuro->next_hint = *hint;
+  kuro->next_hint_found = found;
+  kuro->next_hint_key = key;
+  kuro->next_hint_valid = TRUE;
+
+  /* The player asked for it before it was ready */
+  if (kuro->next_hint_requested) {
+    kuro->next_hint_requested = FALSE;
+    if (kuro->processing_events)
+      g_action_activate(G_ACTION(kuro->hint_action), NULL);
+  }
+}
+
+/* Forget the next hint, as the board's changed, and have the worker start on
+ * the new one, giving up on the old one if it's still going */
+void kuro_queue_next_hint(Kuro *kuro) {
+  kuro->next_hint_valid = FALSE;
+  kuro->next_hint_requested = FALSE;
+
+  kuro_hint_worker_queue(kuro->hint_worker, kuro->board);
+}
+
+/* The next hint for the board as it is. If the background one isn't ready,
+ * small boards work it out now; on bigger ones the hint action is activated
+ * again once it is. Returns FALSE if there's nothing left to hint, or it's
+ * not ready yet. */
+gboolean kuro_get_next_hint(Kuro *kuro, KuroHint *hint) {
+  guint64 key = kuro_board_hash(kuro->board);
+
+  if (!kuro->next_hint_valid || kuro->next_hint_key != key) {
+    if (kuro->board->size > SYNC_HINT_MAX_SIZE) {
+      kuro->next_hint_requested = TRUE;
+      return FALSE;
+    }
+
+    kuro->next_hint_found = kuro_hint_find(kuro->board, &kuro->next_hint);
+    kuro->next_hint_key = key;
+    kuro->next_hint_valid = TRUE;
+  }
+
+  *hint = kuro->next_hint;
+  return kuro->next_hint_found;
+}
+
+/* With --startup-trace, print how far into startup @phase was reached. This
+ * stops once the first board has been drawn. */
+void kuro_startup_trace(Kuro *kuro, const gchar *phase) {
+  if (kuro->startup_time == 0)
+    return;
+
+  g_printerr("%8.2f ms  %s\n",
+             (g_get_monotonic_time() - kuro->startup_time) / 1000.0, phase);
+}
+
 KuroApplication *kuro_application_new(void) {
   return KURO_APPLICATION(g_object_new(KURO_TYPE_APPLICATION, NULL));
 }
 
 void kuro_new_game(Kuro *kuro, guint board_size) {
   kuro->made_a_move = FALSE;
+  kuro->n_moves = 0;
+  kuro->n_hints = 0;
 
   kuro_generate_board(kuro, board_size, 0);
   kuro_clear_undo_stack(kuro);
+  kuro->sweeping = FALSE;
   gtk_widget_queue_draw(kuro->drawing_area);
 
   kuro_reset_timer(kuro);
@@ -284,25 +733,16 @@ void kuro_new_game(Kuro *kuro, guint board_size) {
   /* Reset the cursor position */
   kuro->cursor_position.x = 0;
   kuro->cursor_position.y = 0;
+
+  /* Let the viewport pick a default zoom for the new board size */
+  kuro->zoom = 0.0;
+  kuro->view_x = kuro->view_y = 0.0;
 }
 
 void kuro_clear_undo_stack(Kuro *kuro) {
   /* Clear the undo stack */
-  if (kuro->undo_stack != NULL) {
-    while (kuro->undo_stack->redo != NULL)
-      kuro->undo_stack = kuro->undo_stack->redo;
-
-    while (kuro->undo_stack->undo != NULL) {
-      kuro->undo_stack = kuro->undo_stack->undo;
-      g_free(kuro->undo_stack->redo);
-      if (kuro->undo_stack->type == UNDO_NEW_GAME)
-        break;
-    }
-
-    /* Reset the "new game" item */
-    kuro->undo_stack->undo = NULL;
-    kuro->undo_stack->redo = NULL;
-  }
+  if (kuro->undo_stack != NULL)
+    kuro_undo_clear(kuro->undo_stack);
 
   g_simple_action_set_enabled(kuro->undo_action, FALSE);
   g_simple_action_set_enabled(kuro->redo_action, FALSE);
@@ -349,40 +789,30 @@ void kuro_set_board_size(Kuro *kuro, guint board_size) {
   }
 }
 
+/* Print the puzzle and its solution in the Kuro format, so it can be played
+ * again with --puzzle */
 void kuro_print_board(Kuro *kuro) {
   if (kuro->debug) {
-    KuroVector iter;
-
-    for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-      for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
-        if ((kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE)
-          g_printf("%u ", kuro->board[iter.x][iter.y].num);
-        else
-          g_printf("X ");
-      }
-      g_printf("\n");
-    }
+    GString *text = g_string_new(NULL);
+
+    kuro_format_write(text, kuro->board, KURO_FORMAT_KURO);
+    g_printf("%s", text->str);
+    g_string_free(text, TRUE);
   }
 }
 
 void kuro_free_board(Kuro *kuro) {
-  guint i;
-
-  if (kuro->board == NULL)
-    return;
-
-  for (i = 0; i < kuro->board_size; i++)
-    g_slice_free1(sizeof(KuroCell) * kuro->board_size, kuro->board[i]);
-  g_free(kuro->board);
+  g_clear_pointer(&kuro->propagator, kuro_propagator_free);
+  kuro_board_free(kuro->board);
   kuro->board = NULL;
 }
 
 void kuro_enable_events(Kuro *kuro) {
   kuro->processing_events = TRUE;
 
-  if (kuro->undo_stack->redo != NULL)
+  if (kuro->undo_stack->current->redo != NULL)
     g_simple_action_set_enabled(kuro->redo_action, TRUE);
-  if (kuro->undo_stack->undo != NULL)
+  if (kuro->undo_stack->current->undo != NULL)
     g_simple_action_set_enabled(kuro->undo_action, TRUE);
   g_simple_action_set_enabled(kuro->hint_action, TRUE);
 
@@ -398,41 +828,123 @@ void kuro_disable_events(Kuro *kuro) {
   kuro_pause_timer(kuro);
 }
 
+guint kuro_get_timer_ms(Kuro *kuro) {
+  gint64 elapsed = kuro->timer_elapsed;
+
+  if (kuro->timer_started != 0)
+    elapsed += g_get_monotonic_time() - kuro->timer_started;
+
+  return (guint)MIN(elapsed / 1000, G_MAXUINT);
+}
+
 static void set_timer_label(Kuro *kuro) {
-  gchar *text = g_strdup_printf("%02u∶\xE2\x80\x8E%02u", kuro->timer_value / 60,
-                                kuro->timer_value % 60);
+  guint seconds = kuro_get_timer_ms(kuro) / 1000;
+  gchar *text = g_strdup_printf("%02u∶\xE2\x80\x8E%02u", seconds / 60,
+                                seconds % 60);
   gtk_label_set_text(kuro->timer_label, text);
   g_free(text);
 }
 
-static gboolean update_timer_cb(Kuro *kuro) {
-  kuro->timer_value++;
-  set_timer_label(kuro);
+static gboolean timer_tick_cb(GtkWidget *widget, GdkFrameClock *frame_clock,
+                              gpointer user_data);
 
-  return TRUE;
+static gboolean timer_wake_cb(gpointer user_data) {
+  Kuro *kuro = user_data;
+
+  /* Wait for the next frame, which never comes while the window is hidden */
+  kuro->timeout_id = 0;
+  kuro->timer_tick_id = gtk_widget_add_tick_callback(
+      GTK_WIDGET(kuro->timer_label), timer_tick_cb, kuro, NULL);
+
+  return G_SOURCE_REMOVE;
 }
 
-void kuro_start_timer(Kuro *kuro) {
-  // Remove any old timeout
-  kuro_pause_timer(kuro);
+static gboolean timer_tick_cb(GtkWidget *widget, GdkFrameClock *frame_clock,
+                              gpointer user_data) {
+  Kuro *kuro = user_data;
 
   set_timer_label(kuro);
-  kuro->timeout_id =
-      g_timeout_add_seconds(1, (GSourceFunc)update_timer_cb, kuro);
+
+  /* Sleep until the displayed second changes */
+  kuro->timer_tick_id = 0;
+  kuro->timeout_id = g_timeout_add(1000 - kuro_get_timer_ms(kuro) % 1000,
+                                   timer_wake_cb, kuro);
+
+  return G_SOURCE_REMOVE;
 }
 
-void kuro_pause_timer(Kuro *kuro) {
+/* Run the clock only while the game wants it and the window can be seen */
+static void update_timer(Kuro *kuro) {
+  gboolean running =
+      kuro->timer_enabled &&
+      kuro_scheduler_is_running(kuro->scheduler, KURO_TASK_TIMER);
+
+  if (running == (kuro->timer_started != 0))
+    return;
+
+  if (running) {
+    kuro->timer_started = g_get_monotonic_time();
+    set_timer_label(kuro);
+    timer_wake_cb(kuro);
+    return;
+  }
+
+  kuro->timer_elapsed += g_get_monotonic_time() - kuro->timer_started;
+  kuro->timer_started = 0;
+
   if (kuro->timeout_id > 0) {
     g_source_remove(kuro->timeout_id);
     kuro->timeout_id = 0;
   }
+  if (kuro->timer_tick_id > 0) {
+    gtk_widget_remove_tick_callback(GTK_WIDGET(kuro->timer_label),
+                                    kuro->timer_tick_id);
+    kuro->timer_tick_id = 0;
+  }
+}
+
+static void scheduler_changed_cb(KuroScheduler *scheduler, gpointer user_data) {
+  update_timer(user_data);
+}
+
+void kuro_start_timer(Kuro *kuro) {
+  kuro->timer_enabled = TRUE;
+  update_timer(kuro);
+}
+
+void kuro_pause_timer(Kuro *kuro) {
+  kuro->timer_enabled = FALSE;
+  update_timer(kuro);
 }
 
 void kuro_reset_timer(Kuro *kuro) {
-  kuro->timer_value = 0;
+  kuro->timer_elapsed = 0;
+  if (kuro->timer_started != 0)
+    kuro->timer_started = g_get_monotonic_time();
   set_timer_label(kuro);
 }
 
+/* Add the game which has just been won to the history log */
+void kuro_record_game(Kuro *kuro) {
+  KuroHistoryRecord record = {0};
+  GError *error = NULL;
+
+  if (kuro->history == NULL)
+    return;
+
+  record.finished = g_get_real_time();
+  record.seed = kuro->board->seed;
+  record.time_ms = kuro_get_timer_ms(kuro);
+  record.moves = kuro->n_moves;
+  record.hints = MIN(kuro->n_hints, G_MAXUINT16);
+  record.board_size = kuro->board->size;
+
+  if (!kuro_history_append(kuro->history, &record, &error)) {
+    g_warning("Couldn’t record the game in the history: %s", error->message);
+    g_error_free(error);
+  }
+}
+
 void kuro_quit(Kuro *kuro) { g_application_quit(G_APPLICATION(kuro)); }
 
 int main(int argc, char *argv[]) {
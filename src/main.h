@@ -23,42 +23,18 @@
 #ifndef KURO_MAIN_H
 #define KURO_MAIN_H
 
+#include "board.h"
+#include "hint-worker.h"
+#include "hint.h"
+#include "history.h"
+#include "perf.h"
+#include "propagator.h"
+#include "scheduler.h"
 #include "score.h"
+#include "undo.h"
 
 G_BEGIN_DECLS
 
-#define DEFAULT_BOARD_SIZE 5
-#define MAX_BOARD_SIZE 10
-
-typedef struct {
-  guchar x;
-  guchar y;
-} KuroVector;
-
-typedef enum {
-  UNDO_NEW_GAME,
-  UNDO_PAINT,
-  UNDO_TAG1,
-  UNDO_TAG2,
-  UNDO_TAGS /* = UNDO_TAG1 and UNDO_TAG2 */
-} KuroUndoType;
-
-typedef struct _KuroUndo KuroUndo;
-struct _KuroUndo {
-  KuroUndoType type;
-  KuroVector cell;
-  KuroUndo *undo;
-  KuroUndo *redo;
-};
-
-typedef enum {
-  CELL_PAINTED = 1 << 1,
-  CELL_SHOULD_BE_PAINTED = 1 << 2,
-  CELL_TAG1 = 1 << 3,
-  CELL_TAG2 = 1 << 4,
-  CELL_ERROR = 1 << 5
-} KuroCellStatus;
-
 typedef struct {
   GdkRGBA unpainted_bg;
   GdkRGBA painted_bg;
@@ -69,11 +45,6 @@ typedef struct {
   GdkRGBA error_text;
 } KuroTheme;
 
-typedef struct {
-  guchar num;
-  guchar status;
-} KuroCell;
-
 #define KURO_TYPE_APPLICATION (kuro_application_get_type())
 G_DECLARE_FINAL_TYPE(KuroApplication, kuro_application, KURO, APPLICATION,
                      GtkApplication)
@@ -97,34 +68,92 @@ struct _KuroApplication {
   gdouble drawing_area_x_offset;
   gdouble drawing_area_y_offset;
 
+  /* Viewport onto the board. The zoom is relative to the size at which the
+   * whole board fits; 0 means it's yet to be chosen for the current board. */
+  gdouble cell_size;
+  gdouble zoom;
+  gdouble view_x;
+  gdouble view_y;
+  gdouble pointer_x;
+  gdouble pointer_y;
+  gdouble gesture_zoom;
+  gdouble gesture_x;
+  gdouble gesture_y;
+
   PangoFontDescription *normal_font_desc;
   PangoFontDescription *painted_font_desc;
+  PangoLayout *cell_layout; /* reused for every cell's number */
 
-  guchar board_size;
-  KuroCell **board;
+  KuroBoard *board;
 
   gboolean debug;
   gboolean processing_events;
   gboolean made_a_move;
-  KuroUndo *undo_stack;
+  KuroUndoStack *undo_stack;
+  guint n_moves;
+  guint n_hints;
 
   guint hint_status;
   KuroVector hint_position;
   guint hint_timeout_id;
 
-  guint timer_value; /* seconds into the game */
+  /* The next hint is worked out in the background after each move, so that
+   * asking for it is just a lookup */
+  KuroHintWorker *hint_worker;
+  KuroHint next_hint;
+  gboolean next_hint_found;
+  gboolean next_hint_valid;
+  guint64 next_hint_key;        /* kuro_board_hash() of the position it's for */
+  gboolean next_hint_requested; /* asked for before it was worked out */
+
+  /* What follows from the painted cells, kept up to date move by move so the
+   * player can be warned as soon as the board can't be solved */
+  KuroPropagator *propagator;
+  KuroDeadEnd dead_end; /* the last one warned about */
+  gboolean assist; /* tag cells as soon as moves force them to stay unpainted */
+
+  /* Game time is kept as monotonic clock deltas rather than counted ticks */
+  gint64 timer_elapsed; /* µs accumulated while the timer was last running */
+  gint64 timer_started; /* monotonic time it was started, or 0 if stopped */
   GtkLabel *timer_label;
   guint timeout_id;
+  guint timer_tick_id;
+  gboolean timer_enabled; /* the game wants the clock running */
 
   gboolean cursor_active;
   KuroVector cursor_position;
 
+  /* Dragging paints or tags every cell swept over, as one undo step */
+  gboolean sweeping;
+  gboolean sweep_started; /* the first cell has been changed */
+  KuroUndoType sweep_type;
+  guchar sweep_from; /* the first cell's state before it was changed */
+  KuroVector sweep_first;
+  KuroVector sweep_last;
+  gdouble sweep_x; /* where the drag started */
+  gdouble sweep_y;
+  gboolean *swept; /* cells already swept over, indexed as [x * size + y] */
+  guint n_swept;
+
+  /* Input is validated and redrawn once per frame */
+  guint input_tick_id;
+  gboolean input_recheck;
+
   gboolean is_paused;
   GtkWidget *pause_overlay;
   GtkWidget *pause_button;
+  GtkWidget *toast_overlay;
+
+  gboolean show_perf_overlay;
+  KuroPerf perf;
 
   const KuroTheme *theme;
   GSettings *settings;
+  KuroScoreStore *scores;
+  KuroHistory *history;
+  KuroScheduler *scheduler;
+
+  gint64 startup_time; /* 0 unless tracing startup */
 };
 
 KuroApplication *
@@ -134,6 +163,10 @@ kuro_application_new(void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 typedef KuroApplication Kuro;
 
 void kuro_new_game(Kuro *kuro, guint board_size);
+void kuro_generate_board(Kuro *kuro, guint board_size, guint seed);
+gboolean kuro_check_win(Kuro *kuro);
+void kuro_queue_next_hint(Kuro *kuro);
+gboolean kuro_get_next_hint(Kuro *kuro, KuroHint *hint);
 void kuro_clear_undo_stack(Kuro *kuro);
 void kuro_set_board_size(Kuro *kuro, guint board_size);
 void kuro_print_board(Kuro *kuro);
@@ -143,12 +176,16 @@ void kuro_disable_events(Kuro *kuro);
 void kuro_start_timer(Kuro *kuro);
 void kuro_pause_timer(Kuro *kuro);
 void kuro_reset_timer(Kuro *kuro);
+guint kuro_get_timer_ms(Kuro *kuro);
 void kuro_set_error_position(Kuro *kuro, KuroVector position);
+void kuro_record_game(Kuro *kuro);
+void kuro_startup_trace(Kuro *kuro, const gchar *phase);
 void kuro_quit(Kuro *kuro);
 
 void kuro_show_new_high_score_dialog(Kuro *kuro);
 void kuro_show_high_scores_dialog(Kuro *kuro);
 void kuro_show_win_dialog(Kuro *kuro);
+void kuro_show_print_book_dialog(Kuro *kuro);
 
 G_END_DECLS
 
@@ -0,0 +1,101 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "perf.h"
+
+void kuro_perf_ring_add(KuroPerfRing *ring, gint64 sample) {
+  ring->samples[ring->next] = sample;
+  ring->next = (ring->next + 1) % KURO_PERF_RING_SIZE;
+  if (ring->n_samples < KURO_PERF_RING_SIZE)
+    ring->n_samples++;
+}
+
+static gint compare_samples(gconstpointer a, gconstpointer b) {
+  gint64 sample_a = *(const gint64 *)a;
+  gint64 sample_b = *(const gint64 *)b;
+
+  return (sample_a > sample_b) - (sample_a < sample_b);
+}
+
+/* Returns FALSE if there are no samples to summarise yet */
+gboolean kuro_perf_ring_summarise(const KuroPerfRing *ring,
+                                  KuroPerfSummary *summary) {
+  gint64 sorted[KURO_PERF_RING_SIZE];
+  gint64 total = 0;
+  guint i;
+
+  if (ring->n_samples == 0)
+    return FALSE;
+
+  /* The samples are in no particular order once the ring has wrapped, but
+   * that doesn't matter for any of these */
+  memcpy(sorted, ring->samples, sizeof(gint64) * ring->n_samples);
+  qsort(sorted, ring->n_samples, sizeof(gint64), compare_samples);
+
+  for (i = 0; i < ring->n_samples; i++)
+    total += sorted[i];
+
+  summary->min = sorted[0];
+  summary->avg = (gdouble)total / ring->n_samples;
+  summary->p99 = sorted[(ring->n_samples * 99 - 1) / 100];
+
+  return TRUE;
+}
+
+void kuro_perf_reset(KuroPerf *perf) {
+  gint64 generation_time = perf->generation_time;
+
+  /* The generation time belongs to the board, not to the measurements */
+  memset(perf, 0, sizeof(KuroPerf));
+  perf->generation_time = generation_time;
+}
+
+static void append_ring(GString *text, const gchar *label,
+                        const KuroPerfRing *ring, gdouble scale,
+                        const gchar *unit) {
+  KuroPerfSummary summary;
+
+  if (!kuro_perf_ring_summarise(ring, &summary)) {
+    g_string_append_printf(text, "%-10s –\n", label);
+    return;
+  }
+
+  g_string_append_printf(text, "%-10s %7.2f %7.2f %7.2f %s\n", label,
+                         summary.min / scale, summary.avg / scale,
+                         summary.p99 / scale, unit);
+}
+
+/* Format the current figures as a small fixed-width table for the overlay */
+gchar *kuro_perf_format(const KuroPerf *perf) {
+  GString *text = g_string_new(NULL);
+
+  g_string_append_printf(text, "%-10s %7s %7s %7s\n", "", "min", "avg", "p99");
+  append_ring(text, "draw", &perf->draw_time, 1000.0, "ms");
+  append_ring(text, "cells", &perf->cells_drawn, 1.0, "");
+  append_ring(text, "layouts", &perf->layouts, 1.0, "");
+  append_ring(text, "validate", &perf->validation, 1000.0, "ms");
+  g_string_append_printf(text, "%-10s %7.2f ms", "generate",
+                         perf->generation_time / 1000.0);
+
+  return g_string_free(text, FALSE);
+}
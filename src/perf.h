@@ -0,0 +1,62 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_PERF_H
+#define KURO_PERF_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define KURO_PERF_RING_SIZE 128
+
+/* A fixed-size window onto the most recent samples of some measurement */
+typedef struct {
+  gint64 samples[KURO_PERF_RING_SIZE];
+  guint n_samples;
+  guint next;
+} KuroPerfRing;
+
+typedef struct {
+  gint64 min;
+  gdouble avg;
+  gint64 p99;
+} KuroPerfSummary;
+
+typedef struct {
+  KuroPerfRing draw_time;   /* µs spent in each kuro_draw_cb() */
+  KuroPerfRing cells_drawn; /* cells repainted per frame */
+  KuroPerfRing layouts;     /* Pango layouts created per frame */
+  KuroPerfRing validation;  /* µs from a move to the end of its validation */
+  gint64 generation_time;   /* µs taken to generate the current board */
+
+  /* Counters for the frame being drawn */
+  guint frame_cells;
+  guint frame_layouts;
+} KuroPerf;
+
+void kuro_perf_ring_add(KuroPerfRing *ring, gint64 sample);
+gboolean kuro_perf_ring_summarise(const KuroPerfRing *ring,
+                                  KuroPerfSummary *summary);
+void kuro_perf_reset(KuroPerf *perf);
+gchar *kuro_perf_format(const KuroPerf *perf) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* KURO_PERF_H */
@@ -0,0 +1,71 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <sysprof-capture.h>
+
+#include "profiler.h"
+
+static const struct {
+  const gchar *name;
+  const gchar *description;
+} counter_info[KURO_PROFILER_N_COUNTERS] = {
+    {"Generation attempts", "Seeds tried to generate the last board"},
+    {"Cells drawn", "Cells repainted in the last frame"},
+    {"Layouts", "Pango layouts created in the last frame"},
+};
+
+static guint counter_base;
+
+/* Counters have to be defined once per process before they can be set */
+static void define_counters(void) {
+  static gsize defined = 0;
+
+  if (g_once_init_enter(&defined)) {
+    SysprofCaptureCounter counters[KURO_PROFILER_N_COUNTERS] = {0};
+    guint i;
+
+    counter_base = sysprof_collector_request_counters(KURO_PROFILER_N_COUNTERS);
+
+    for (i = 0; i < KURO_PROFILER_N_COUNTERS; i++) {
+      counters[i].id = counter_base + i;
+      counters[i].type = SYSPROF_CAPTURE_COUNTER_INT64;
+      counters[i].value.v64 = 0;
+      g_strlcpy(counters[i].category, "Kuro", sizeof(counters[i].category));
+      g_strlcpy(counters[i].name, counter_info[i].name,
+                sizeof(counters[i].name));
+      g_strlcpy(counters[i].description, counter_info[i].description,
+                sizeof(counters[i].description));
+    }
+
+    sysprof_collector_define_counters(counters, KURO_PROFILER_N_COUNTERS);
+    g_once_init_leave(&defined, 1);
+  }
+}
+
+void kuro_profiler_set_counter(KuroProfilerCounter counter, gint64 value) {
+  guint id;
+  SysprofCaptureCounterValue counter_value;
+
+  define_counters();
+
+  id = counter_base + counter;
+  counter_value.v64 = value;
+  sysprof_collector_set_counters(&id, &counter_value, 1);
+}
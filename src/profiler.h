@@ -0,0 +1,65 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_PROFILER_H
+#define KURO_PROFILER_H
+
+#include <glib.h>
+
+#include "config.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  KURO_PROFILER_COUNTER_GENERATION_ATTEMPTS,
+  KURO_PROFILER_COUNTER_CELLS_DRAWN,
+  KURO_PROFILER_COUNTER_LAYOUTS,
+  KURO_PROFILER_N_COUNTERS
+} KuroProfilerCounter;
+
+/* Marks and counters for sysprof. Without the sysprof option these all
+ * expand to nothing, and don't so much as read the clock. */
+#ifdef HAVE_SYSPROF
+#include <sysprof-capture.h>
+
+#define KURO_PROFILER_CURRENT_TIME SYSPROF_CAPTURE_CURRENT_TIME
+#define KURO_PROFILER_ADD_MARK(begin, name, message)                           \
+  sysprof_collector_mark((begin), SYSPROF_CAPTURE_CURRENT_TIME - (begin),      \
+                         "Kuro", (name), (message))
+#define KURO_PROFILER_ADD_MARK_PRINTF(begin, name, ...)                        \
+  sysprof_collector_mark_printf((begin),                                       \
+                                SYSPROF_CAPTURE_CURRENT_TIME - (begin),        \
+                                "Kuro", (name), __VA_ARGS__)
+#define KURO_PROFILER_SET_COUNTER(counter, value)                              \
+  kuro_profiler_set_counter((counter), (value))
+
+void kuro_profiler_set_counter(KuroProfilerCounter counter, gint64 value);
+#else
+#define KURO_PROFILER_CURRENT_TIME 0
+#define KURO_PROFILER_ADD_MARK(begin, name, message)                           \
+  G_STMT_START { (void)(begin); } G_STMT_END
+#define KURO_PROFILER_ADD_MARK_PRINTF(begin, name, ...)                        \
+  G_STMT_START { (void)(begin); } G_STMT_END
+#define KURO_PROFILER_SET_COUNTER(counter, value)                              \
+  G_STMT_START { } G_STMT_END
+#endif
+
+G_END_DECLS
+
+#endif /* KURO_PROFILER_H */
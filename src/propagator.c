@@ -0,0 +1,509 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "profiler.h"
+#include "propagator.h"
+
+/* Every cell is black (painted, or has to be), white (has to stay
+ * unpainted) or still open. Only sound deductions are made, unlike hints,
+ * which may assume the puzzle has a unique solution. */
+typedef enum { STATE_OPEN, STATE_WHITE, STATE_BLACK } CellState;
+
+struct _KuroPropagator {
+  const KuroBoard *board;
+  guint n_cells;
+  guchar *state;     /* CellState of each cell, indexed as [x * size + y] */
+  guint *reason;     /* the painted cell each decided cell follows from, or
+                      * n_cells if it follows from the numbers alone */
+  gboolean *painted; /* the cells painted when last updated */
+  guint n_painted;
+  guint *queue;      /* cells decided but not yet followed up */
+  guint n_queue;
+  gboolean *reached; /* for checking connectivity */
+  guchar *pocket;    /* for looking for cut cells and marking requeued ones,
+                      * all 0 in between */
+  guint *stack;
+
+  /* A cell made black by the current update which might have cut the board
+   * in two, if there's one */
+  gboolean may_be_cut;
+  guint cut_cell;
+
+  KuroDeadEnd dead_end;
+  guint dead_end_cell;
+};
+
+static void set_dead_end(KuroPropagator *p, KuroDeadEnd dead_end,
+                         guint cell) {
+  if (p->dead_end == KURO_DEAD_END_NONE) {
+    p->dead_end = dead_end;
+    p->dead_end_cell = cell;
+  }
+}
+
+static gboolean is_black(const KuroPropagator *p, gint x, gint y) {
+  gint size = (gint)p->board->size;
+
+  return x < 0 || y < 0 || x >= size || y >= size ||
+         p->state[x * size + y] == STATE_BLACK;
+}
+
+/* Whether the cells around @cell, which has just turned black, are still
+ * joined up around it. If they are, it can't have cut the board in two. */
+static gboolean is_locally_connected(const KuroPropagator *p, guint cell) {
+  static const gint ring[8][2] = {{0, -1}, {1, -1}, {1, 0},  {1, 1},
+                                  {0, 1},  {-1, 1}, {-1, 0}, {-1, -1}};
+  gint x = (gint)(cell / p->board->size), y = (gint)(cell % p->board->size);
+  guint i, n_runs = 0;
+
+  /* Count the runs of open or white cells going round the ring */
+  for (i = 0; i < 8; i++) {
+    gboolean open = !is_black(p, x + ring[i][0], y + ring[i][1]);
+    gboolean previous_open =
+        !is_black(p, x + ring[(i + 7) % 8][0], y + ring[(i + 7) % 8][1]);
+
+    if (open && !previous_open)
+      n_runs++;
+  }
+
+  return n_runs <= 1;
+}
+
+static void decide(KuroPropagator *p, guint cell, CellState state,
+                   guint reason) {
+  if (p->state[cell] == state)
+    return;
+
+  if (p->state[cell] != STATE_OPEN) {
+    set_dead_end(p, KURO_DEAD_END_CONFLICT, cell);
+    return;
+  }
+
+  p->state[cell] = state;
+  p->reason[cell] = reason;
+  p->queue[p->n_queue++] = cell;
+
+  /* Blackening a cell can only split the others up if they aren't joined up
+   * around it. Checking as each cell's decided keeps this exact. */
+  if (state == STATE_BLACK && !p->may_be_cut &&
+      !is_locally_connected(p, cell)) {
+    p->may_be_cut = TRUE;
+    p->cut_cell = cell;
+  }
+}
+
+/* Follow up decided cells until nothing more follows: black cells' neighbours
+ * are white (rule 2), and white cells' numbers are black everywhere else in
+ * their row and column (rule 1). Only the rows, columns and neighbourhoods
+ * of cells which change are visited. */
+static void propagate(KuroPropagator *p) {
+  guint size = p->board->size;
+
+  while (p->n_queue > 0 && p->dead_end == KURO_DEAD_END_NONE) {
+    guint cell = p->queue[--p->n_queue];
+    guint x = cell / size, y = cell % size, reason = p->reason[cell], i;
+
+    /* Everything which follows from a cell follows from what it did */
+    if (p->state[cell] == STATE_BLACK) {
+      if (x > 0)
+        decide(p, cell - size, STATE_WHITE, reason);
+      if (x < size - 1)
+        decide(p, cell + size, STATE_WHITE, reason);
+      if (y > 0)
+        decide(p, cell - 1, STATE_WHITE, reason);
+      if (y < size - 1)
+        decide(p, cell + 1, STATE_WHITE, reason);
+      continue;
+    }
+
+    for (i = 0; i < size; i++) {
+      guint others[2] = {i * size + y, x * size + i}, j;
+
+      for (j = 0; j < 2; j++) {
+        guint other = others[j];
+
+        if (other == cell ||
+            p->board->cells[other / size][other % size].num !=
+                p->board->cells[x][y].num)
+          continue;
+
+        if (p->state[other] == STATE_WHITE)
+          set_dead_end(p, KURO_DEAD_END_DUPLICATE, other);
+        else
+          decide(p, other, STATE_BLACK, reason);
+      }
+    }
+  }
+}
+
+/* Whether the cells which aren't black are all joined together (rule 3) */
+static gboolean is_connected(KuroPropagator *p) {
+  guint size = p->board->size, n_stack = 0, n_reached = 0, n_open = 0;
+  guint cell;
+
+  memset(p->reached, 0, sizeof(gboolean) * p->n_cells);
+
+  for (cell = 0; cell < p->n_cells; cell++) {
+    if (p->state[cell] == STATE_BLACK)
+      continue;
+    if (n_open++ == 0) {
+      p->reached[cell] = TRUE;
+      p->stack[n_stack++] = cell;
+    }
+  }
+
+  while (n_stack > 0) {
+    guint neighbours[4], n_neighbours = 0, i;
+
+    cell = p->stack[--n_stack];
+    n_reached++;
+
+    if (cell >= size)
+      neighbours[n_neighbours++] = cell - size;
+    if (cell + size < p->n_cells)
+      neighbours[n_neighbours++] = cell + size;
+    if (cell % size > 0)
+      neighbours[n_neighbours++] = cell - 1;
+    if (cell % size < size - 1)
+      neighbours[n_neighbours++] = cell + 1;
+
+    for (i = 0; i < n_neighbours; i++) {
+      if (!p->reached[neighbours[i]] &&
+          p->state[neighbours[i]] != STATE_BLACK) {
+        p->reached[neighbours[i]] = TRUE;
+        p->stack[n_stack++] = neighbours[i];
+      }
+    }
+  }
+
+  return n_reached == n_open;
+}
+
+/* Check the board hasn't been cut in two, if it might have been */
+static void check_connectivity(KuroPropagator *p) {
+  if (p->may_be_cut && p->dead_end == KURO_DEAD_END_NONE && !is_connected(p))
+    set_dead_end(p, KURO_DEAD_END_DISCONNECTED, p->cut_cell);
+
+  p->may_be_cut = FALSE;
+}
+
+/* Decide a newly painted cell, and follow everything which comes of it */
+static void add_black(KuroPropagator *p, guint cell) {
+  /* Already known to be black. Unless that's from the numbers alone, it's
+   * because of another painted cell, which this one may outlast. */
+  if (p->state[cell] == STATE_BLACK) {
+    if (p->reason[cell] != p->n_cells)
+      p->reason[cell] = cell;
+    return;
+  }
+
+  decide(p, cell, STATE_BLACK, cell);
+  propagate(p);
+  check_connectivity(p);
+}
+
+/* Queue @cell to be followed up again, unless it already is */
+static void requeue(KuroPropagator *p, guint cell) {
+  if (!p->pocket[cell]) {
+    p->pocket[cell] = 1;
+    p->queue[p->n_queue++] = cell;
+  }
+}
+
+/* Take back everything which followed from @cell being painted. Each
+ * deduction follows from a single cell, so that's just the cells it's the
+ * reason for. Whatever still follows from the rest is worked out again from
+ * the cells which could have decided them: their black neighbours, and
+ * white cells with the same number in their row or column. */
+static void remove_black(KuroPropagator *p, guint cell) {
+  guint size = p->board->size, n_retracted = 0, i, j;
+
+  for (i = 0; i < p->n_cells; i++) {
+    if (p->state[i] != STATE_OPEN && p->reason[i] == cell) {
+      p->state[i] = STATE_OPEN;
+      p->stack[n_retracted++] = i;
+    }
+  }
+
+  for (i = 0; i < n_retracted; i++) {
+    guint retracted = p->stack[i];
+    guint x = retracted / size, y = retracted % size;
+    guint num = p->board->cells[x][y].num;
+
+    if (x > 0 && p->state[retracted - size] == STATE_BLACK)
+      requeue(p, retracted - size);
+    if (x < size - 1 && p->state[retracted + size] == STATE_BLACK)
+      requeue(p, retracted + size);
+    if (y > 0 && p->state[retracted - 1] == STATE_BLACK)
+      requeue(p, retracted - 1);
+    if (y < size - 1 && p->state[retracted + 1] == STATE_BLACK)
+      requeue(p, retracted + 1);
+
+    for (j = 0; j < size; j++) {
+      guint others[2] = {j * size + y, x * size + j}, k;
+
+      for (k = 0; k < 2; k++) {
+        guint other = others[k];
+
+        if (other != retracted && p->state[other] == STATE_WHITE &&
+            p->board->cells[other / size][other % size].num == num)
+          requeue(p, other);
+      }
+    }
+  }
+
+  for (i = 0; i < p->n_queue; i++)
+    p->pocket[p->queue[i]] = 0;
+
+  /* Fewer black cells can't break any rules, so this can't find a dead
+   * end */
+  propagate(p);
+  p->may_be_cut = FALSE;
+}
+
+/* Patterns in the numbers which hold whatever's painted: in "a b a" and
+ * "a a a" the middle cell is white, as otherwise both a's would be; and two
+ * adjacent a's leave one of them white, so any other a in their line is
+ * black */
+static void add_patterns(KuroPropagator *p) {
+  guint size = p->board->size, line, i, j, dir;
+
+  for (dir = 0; dir < 2; dir++) {
+    for (line = 0; line < size; line++) {
+      guint step = (dir == 0) ? size : 1;
+      guint start = (dir == 0) ? line : line * size;
+
+      for (i = 0; i + 1 < size; i++) {
+        guint a = start + i * step;
+        guint num = p->board->cells[a / size][a % size].num;
+        guint b = a + step;
+
+        if (i + 2 < size && p->board->cells[(b + step) / size][(b + step) % size]
+                                    .num == num)
+          decide(p, b, STATE_WHITE, p->n_cells);
+
+        if (p->board->cells[b / size][b % size].num != num)
+          continue;
+
+        for (j = 0; j < size; j++) {
+          guint other = start + j * step;
+
+          if (j != i && j != i + 1 &&
+              p->board->cells[other / size][other % size].num == num)
+            decide(p, other, STATE_BLACK, p->n_cells);
+        }
+      }
+    }
+  }
+
+  propagate(p);
+  check_connectivity(p);
+}
+
+/* Work everything out again from scratch, which is only needed when a cell's
+ * unpainted after a dead end, as by then not everything's been followed up.
+ * All the painted cells are decided before following any of them up, so the
+ * board's only checked for being cut in two once. */
+static void recompute(KuroPropagator *p) {
+  guint cell;
+
+  memset(p->state, STATE_OPEN, p->n_cells);
+  p->n_queue = 0;
+  p->may_be_cut = FALSE;
+  p->n_painted = 0;
+  p->dead_end = KURO_DEAD_END_NONE;
+
+  add_patterns(p);
+
+  for (cell = 0; cell < p->n_cells; cell++) {
+    const KuroCell *board_cell =
+        &p->board->cells[cell / p->board->size][cell % p->board->size];
+
+    p->painted[cell] = (board_cell->status & CELL_PAINTED) != 0;
+    if (p->painted[cell]) {
+      p->n_painted++;
+      decide(p, cell, STATE_BLACK, cell);
+    }
+  }
+
+  propagate(p);
+  check_connectivity(p);
+}
+
+/* The propagator keeps a pointer to @board, which must outlive it */
+KuroPropagator *kuro_propagator_new(const KuroBoard *board) {
+  KuroPropagator *p = g_new0(KuroPropagator, 1);
+
+  p->board = board;
+  p->n_cells = board->size * board->size;
+  p->state = g_new(guchar, p->n_cells);
+  p->reason = g_new(guint, p->n_cells);
+  p->painted = g_new(gboolean, p->n_cells);
+  /* Each cell's decided at most once, and only decided cells are requeued
+   * while the others are open, so the queue can't overflow */
+  p->queue = g_new(guint, p->n_cells);
+  p->reached = g_new(gboolean, p->n_cells);
+  p->pocket = g_new0(guchar, p->n_cells);
+  p->stack = g_new(guint, p->n_cells);
+
+  recompute(p);
+
+  return p;
+}
+
+void kuro_propagator_free(KuroPropagator *p) {
+  if (p == NULL)
+    return;
+
+  g_free(p->state);
+  g_free(p->reason);
+  g_free(p->painted);
+  g_free(p->queue);
+  g_free(p->reached);
+  g_free(p->pocket);
+  g_free(p->stack);
+  g_free(p);
+}
+
+/* Catch up with @cell having been painted or unpainted */
+void kuro_propagator_update(KuroPropagator *p, KuroVector cell) {
+  guint index = cell.x * p->board->size + cell.y;
+  gboolean painted =
+      (p->board->cells[cell.x][cell.y].status & CELL_PAINTED) != 0;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  if (painted == p->painted[index])
+    return;
+
+  p->painted[index] = painted;
+
+  /* Painting only adds to what's known, so it can be followed up from the
+   * cell alone, and can't get out of a dead end. Unpainting only takes back
+   * what followed from the cell, unless things have already gone wrong and
+   * not everything was followed up. */
+  if (painted) {
+    p->n_painted++;
+    if (p->dead_end == KURO_DEAD_END_NONE)
+      add_black(p, index);
+  } else {
+    p->n_painted--;
+    if (p->dead_end == KURO_DEAD_END_NONE)
+      remove_black(p, index);
+    else
+      recompute(p);
+  }
+
+  KURO_PROFILER_ADD_MARK(begin, "Propagate",
+                         painted ? "Painted" : "Unpainted");
+}
+
+KuroDeadEnd kuro_propagator_get_dead_end(const KuroPropagator *p,
+                                         KuroVector *cell) {
+  if (cell != NULL && p->dead_end != KURO_DEAD_END_NONE) {
+    cell->x = (guint16)(p->dead_end_cell / p->board->size);
+    cell->y = (guint16)(p->dead_end_cell % p->board->size);
+  }
+
+  return p->dead_end;
+}
+
+/* Whether painting @cell would shut some unpainted cells off from the rest,
+ * so it has to stay unpainted. Only pockets of up to @budget cells are looked
+ * for, so this never searches far from @cell. */
+gboolean kuro_propagator_is_cut(KuroPropagator *p, KuroVector cell,
+                                guint budget) {
+  guint size = p->board->size, index = cell.x * size + cell.y;
+  guint neighbours[4], n_neighbours = 0, n_visited = 0, i;
+  gboolean cut = FALSE;
+
+  if (p->painted[index])
+    return FALSE;
+
+  if (cell.x > 0 && !p->painted[index - size])
+    neighbours[n_neighbours++] = index - size;
+  if (cell.x < size - 1 && !p->painted[index + size])
+    neighbours[n_neighbours++] = index + size;
+  if (cell.y > 0 && !p->painted[index - 1])
+    neighbours[n_neighbours++] = index - 1;
+  if (cell.y < size - 1 && !p->painted[index + 1])
+    neighbours[n_neighbours++] = index + 1;
+
+  /* Pretend @cell is painted, and search out from each of its neighbours in
+   * turn, labelling cells with the neighbour they were reached from. Running
+   * into another neighbour's cells means they're joined up. The visited cells
+   * are logged in the queue, which is only used while updating, so they can
+   * be cleared afterwards. */
+  p->pocket[index] = G_N_ELEMENTS(neighbours) + 1;
+  p->queue[n_visited++] = index;
+
+  for (i = 0; i < n_neighbours && n_neighbours > 1 && !cut; i++) {
+    guint n_stack = 0, n_pocket = 0;
+    guchar label = (guchar)(i + 1);
+    gboolean joined = p->pocket[neighbours[i]] != 0;
+
+    if (joined)
+      continue;
+
+    p->pocket[neighbours[i]] = label;
+    p->queue[n_visited++] = neighbours[i];
+    p->stack[n_stack++] = neighbours[i];
+
+    while (n_stack > 0 && n_pocket < budget && !joined) {
+      guint next[4], n_next = 0, current = p->stack[--n_stack], j;
+
+      n_pocket++;
+
+      if (current >= size)
+        next[n_next++] = current - size;
+      if (current + size < p->n_cells)
+        next[n_next++] = current + size;
+      if (current % size > 0)
+        next[n_next++] = current - 1;
+      if (current % size < size - 1)
+        next[n_next++] = current + 1;
+
+      for (j = 0; j < n_next; j++) {
+        guchar other = p->pocket[next[j]];
+
+        if (p->painted[next[j]] || other == label || next[j] == index)
+          continue;
+
+        if (other != 0) {
+          joined = TRUE;
+        } else {
+          p->pocket[next[j]] = label;
+          p->queue[n_visited++] = next[j];
+          p->stack[n_stack++] = next[j];
+        }
+      }
+    }
+
+    /* A pocket which ran out before the rest of the board did */
+    cut = !joined && n_stack == 0 &&
+          n_pocket < p->n_cells - p->n_painted - 1;
+  }
+
+  for (i = 0; i < n_visited; i++)
+    p->pocket[p->queue[i]] = 0;
+
+  return cut;
+}
@@ -0,0 +1,53 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_PROPAGATOR_H
+#define KURO_PROPAGATOR_H
+
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+/* Why the painted cells can no longer lead to a solution */
+typedef enum {
+  KURO_DEAD_END_NONE,
+  KURO_DEAD_END_CONFLICT,    /* a cell would have to be painted and not */
+  KURO_DEAD_END_DUPLICATE,   /* a number would have to stay unpainted twice */
+  KURO_DEAD_END_DISCONNECTED /* the painted cells would cut the board in two */
+} KuroDeadEnd;
+
+/* Keeps track of everything which follows from the painted cells by the
+ * rules alone, as they're painted, so that dead ends show up as soon as
+ * they're made rather than when the board's finished. */
+typedef struct _KuroPropagator KuroPropagator;
+
+KuroPropagator *kuro_propagator_new(const KuroBoard *board)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_propagator_free(KuroPropagator *propagator);
+void kuro_propagator_update(KuroPropagator *propagator, KuroVector cell);
+KuroDeadEnd kuro_propagator_get_dead_end(const KuroPropagator *propagator,
+                                         KuroVector *cell);
+gboolean kuro_propagator_is_cut(KuroPropagator *propagator, KuroVector cell,
+                                guint budget);
+
+G_END_DECLS
+
+#endif /* KURO_PROPAGATOR_H */
@@ -17,21 +17,20 @@
  * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <adwaita.h>
 #include <glib.h>
-#include <glib/gi18n.h>
 #include <glib/gprintf.h>
+#include <string.h>
 
-#include "main.h"
+#include "profiler.h"
 #include "rules.h"
 
 /* Rule 1: There must only be one of each number in the unpainted cells
  * in each row and column.
  * NOTE: We don't set the error position with this rule, or it would give
  * the game away! */
-gboolean kuro_check_rule1(Kuro *kuro) {
+static gboolean check_rule1(KuroBoard *board) {
   KuroVector iter;
-  gboolean *accum = g_new0(gboolean, kuro->board_size + 1);
+  gboolean *accum = board->workspace.seen;
 
   /*
    * The accumulator is an array of all the possible numbers on
@@ -43,19 +42,19 @@ gboolean kuro_check_rule1(Kuro *kuro) {
    */
 
   /* Check columns for repeating numbers */
-  for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
     /* Reset accum */
-    for (iter.y = 0; iter.y < kuro->board_size + 1; iter.y++)
+    for (iter.y = 0; iter.y < board->size + 1; iter.y++)
       accum[iter.y] = FALSE;
 
-    for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-      if ((kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
-        if (accum[kuro->board[iter.x][iter.y].num - 1] == TRUE) {
-          if (kuro->debug) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      if ((board->cells[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
+        if (accum[board->cells[iter.x][iter.y].num - 1] == TRUE) {
+          if (board->debug) {
             g_debug("Rule 1 failed in column %u, row %u", iter.x, iter.y);
 
             /* Print out the accumulator */
-            for (iter.y = 0; iter.y < kuro->board_size + 1; iter.y++) {
+            for (iter.y = 0; iter.y < board->size + 1; iter.y++) {
               if (accum[iter.y] == TRUE)
                 g_printf("X");
               else
@@ -64,29 +63,28 @@ gboolean kuro_check_rule1(Kuro *kuro) {
             g_printf("\n");
           }
 
-          g_free(accum);
           return FALSE;
         }
 
-        accum[kuro->board[iter.x][iter.y].num - 1] = TRUE;
+        accum[board->cells[iter.x][iter.y].num - 1] = TRUE;
       }
     }
   }
 
   /* Now check the rows */
-  for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
+  for (iter.y = 0; iter.y < board->size; iter.y++) {
     /* Reset accum */
-    for (iter.x = 0; iter.x < kuro->board_size + 1; iter.x++)
+    for (iter.x = 0; iter.x < board->size + 1; iter.x++)
       accum[iter.x] = FALSE;
 
-    for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
-      if ((kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
-        if (accum[kuro->board[iter.x][iter.y].num - 1] == TRUE) {
-          if (kuro->debug) {
+    for (iter.x = 0; iter.x < board->size; iter.x++) {
+      if ((board->cells[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
+        if (accum[board->cells[iter.x][iter.y].num - 1] == TRUE) {
+          if (board->debug) {
             g_debug("Rule 1 failed in row %u, column %u", iter.y, iter.x);
 
             /* Print out the accumulator */
-            for (iter.y = 0; iter.y < kuro->board_size + 1; iter.y++) {
+            for (iter.y = 0; iter.y < board->size + 1; iter.y++) {
               if (accum[iter.y] == TRUE)
                 g_printf("X");
               else
@@ -95,18 +93,15 @@ gboolean kuro_check_rule1(Kuro *kuro) {
             g_printf("\n");
           }
 
-          g_free(accum);
           return FALSE;
         }
 
-        accum[kuro->board[iter.x][iter.y].num - 1] = TRUE;
+        accum[board->cells[iter.x][iter.y].num - 1] = TRUE;
       }
     }
   }
 
-  g_free(accum);
-
-  if (kuro->debug)
+  if (board->debug)
     g_debug("Rule 1 OK");
 
   return TRUE;
@@ -114,163 +109,152 @@ gboolean kuro_check_rule1(Kuro *kuro) {
 
 /* Rule 2: No painted cell may be adjacent to another, vertically or
  * horizontally. */
-gboolean kuro_check_rule2(Kuro *kuro) {
+static gboolean check_rule2(KuroBoard *board) {
   KuroVector iter;
   gboolean success = TRUE;
 
   /* Check the squares immediately next to the current one; if they're painted,
    * the rule fails. */
-  for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
-    for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-      if (kuro->board[iter.x][iter.y].status & CELL_PAINTED &&
-          ((iter.x < kuro->board_size - 1 &&
-            kuro->board[iter.x + 1][iter.y].status & CELL_PAINTED) ||
-           (iter.y < kuro->board_size - 1 &&
-            kuro->board[iter.x][iter.y + 1].status & CELL_PAINTED) ||
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      if (board->cells[iter.x][iter.y].status & CELL_PAINTED &&
+          ((iter.x < board->size - 1 &&
+            board->cells[iter.x + 1][iter.y].status & CELL_PAINTED) ||
+           (iter.y < board->size - 1 &&
+            board->cells[iter.x][iter.y + 1].status & CELL_PAINTED) ||
            (iter.x > 0 &&
-            kuro->board[iter.x - 1][iter.y].status & CELL_PAINTED) ||
+            board->cells[iter.x - 1][iter.y].status & CELL_PAINTED) ||
            (iter.y > 0 &&
-            kuro->board[iter.x][iter.y - 1].status & CELL_PAINTED))) {
-        if (kuro->debug)
+            board->cells[iter.x][iter.y - 1].status & CELL_PAINTED))) {
+        if (board->debug)
           g_debug("Rule 2 failed");
 
         /* Mark the cell as being erroneous and continue to the other cells so
          * that they also get marked */
-        kuro->board[iter.x][iter.y].status |= CELL_ERROR;
+        board->cells[iter.x][iter.y].status |= CELL_ERROR;
         success = FALSE;
       } else {
         /* Clear any error in the cell */
-        kuro->board[iter.x][iter.y].status &= ~CELL_ERROR;
+        board->cells[iter.x][iter.y].status &= ~CELL_ERROR;
       }
     }
   }
 
-  if (kuro->debug && success)
+  if (board->debug && success)
     g_debug("Rule 2 OK");
 
   return success;
 }
 
+/* Queue up the cell at (@x, @y) for the flood fill, unless it's painted or
+ * already reached */
+static inline void reach_cell(KuroBoard *board, guint *n_stack, guint x,
+                              guint y) {
+  KuroBoardWorkspace *workspace = &board->workspace;
+
+  if (workspace->reached[x * board->size + y] == FALSE &&
+      (board->cells[x][y].status & CELL_PAINTED) == FALSE) {
+    workspace->reached[x * board->size + y] = TRUE;
+    workspace->stack[*n_stack].x = (guint16)x;
+    workspace->stack[*n_stack].y = (guint16)y;
+    (*n_stack)++;
+  }
+}
+
 /* Rule 3: all the unpainted cells must be joined together in one group. */
-gboolean kuro_check_rule3(Kuro *kuro) {
-  GQueue queue = G_QUEUE_INIT;
-  gboolean **reached;
-  KuroVector iter, *first = NULL;
+static gboolean check_rule3(KuroBoard *board) {
+  gboolean *reached = board->workspace.reached;
+  KuroVector iter;
+  guint n_stack = 0;
   gboolean success;
 
+  /* Clear the board of booleans which keeps track of which cells we can
+   * reach */
+  memset(reached, 0, sizeof(gboolean) * board->size * board->size);
+
   /* Pick an unpainted cell. */
-  for (iter.x = 0; first == NULL && iter.x < kuro->board_size; iter.x++)
-    for (iter.y = 0; !first && iter.y < kuro->board_size; iter.y++)
-      if ((kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE)
-        first = g_slice_dup(KuroVector, &iter);
-  if (first == NULL)
+  for (iter.x = 0; n_stack == 0 && iter.x < board->size; iter.x++)
+    for (iter.y = 0; n_stack == 0 && iter.y < board->size; iter.y++)
+      reach_cell(board, &n_stack, iter.x, iter.y);
+  if (n_stack == 0)
     return FALSE;
 
-  /* Allocate a board of booleans to keep track of which cells we can reach */
-  reached = g_new(gboolean *, kuro->board_size);
-  for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-    reached[iter.x] = g_new0(gboolean, kuro->board_size);
-
-  /* Use a basic floodfill algorithm to traverse the board */
-  g_queue_push_tail(&queue, first);
-  while (g_queue_is_empty(&queue) == FALSE) {
-    KuroVector *ptr = g_queue_pop_head(&queue);
-
-    iter = *ptr;
-
-    if (reached[iter.x][iter.y] == FALSE &&
-        (kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
-      /* Mark the cell as having been reached */
-      reached[iter.x][iter.y] = TRUE;
-
-      if (iter.x > 0) {
-        /* Cell to our left */
-        KuroVector *neighbour = g_slice_new(KuroVector);
-        neighbour->x = iter.x - 1;
-        neighbour->y = iter.y;
-        g_queue_push_tail(&queue, neighbour);
-      }
-      if (iter.y > 0) {
-        /* Cell above us */
-        KuroVector *neighbour = g_slice_new(KuroVector);
-        neighbour->x = iter.x;
-        neighbour->y = iter.y - 1;
-        g_queue_push_tail(&queue, neighbour);
-      }
-      if (iter.x < kuro->board_size - 1) {
-        /* Cell to our right */
-        KuroVector *neighbour = g_slice_new(KuroVector);
-        neighbour->x = iter.x + 1;
-        neighbour->y = iter.y;
-        g_queue_push_tail(&queue, neighbour);
-      }
-      if (iter.y < kuro->board_size - 1) {
-        /* Cell below us */
-        KuroVector *neighbour = g_slice_new(KuroVector);
-        neighbour->x = iter.x;
-        neighbour->y = iter.y + 1;
-        g_queue_push_tail(&queue, neighbour);
-      }
-    }
-
-    g_slice_free(KuroVector, ptr);
+  /* Use a basic floodfill algorithm to traverse the board. Cells are marked
+   * as reached when they're pushed, so the stack never overflows. */
+  while (n_stack > 0) {
+    iter = board->workspace.stack[--n_stack];
+
+    if (iter.x > 0) /* Cell to our left */
+      reach_cell(board, &n_stack, iter.x - 1u, iter.y);
+    if (iter.y > 0) /* Cell above us */
+      reach_cell(board, &n_stack, iter.x, iter.y - 1u);
+    if (iter.x < board->size - 1) /* Cell to our right */
+      reach_cell(board, &n_stack, iter.x + 1u, iter.y);
+    if (iter.y < board->size - 1) /* Cell below us */
+      reach_cell(board, &n_stack, iter.x, iter.y + 1u);
   }
 
   /* Check if there's an unpainted cell we haven't reached */
   success = TRUE;
-  for (iter.x = 0; iter.x < kuro->board_size; iter.x++) {
-    for (iter.y = 0; iter.y < kuro->board_size; iter.y++) {
-      if (reached[iter.x][iter.y] == FALSE &&
-          (kuro->board[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y < board->size; iter.y++) {
+      if (reached[iter.x * board->size + iter.y] == FALSE &&
+          (board->cells[iter.x][iter.y].status & CELL_PAINTED) == FALSE) {
         success = FALSE;
 
         /* Highlight its neighbours as erroneous */
-        if (iter.x > 0 && kuro->board[iter.x - 1][iter.y].status & CELL_PAINTED)
-          kuro->board[iter.x - 1][iter.y].status |= CELL_ERROR;
-        if (iter.y > 0 && kuro->board[iter.x][iter.y - 1].status & CELL_PAINTED)
-          kuro->board[iter.x][iter.y - 1].status |= CELL_ERROR;
-        if (iter.x < kuro->board_size - 1 &&
-            kuro->board[iter.x + 1][iter.y].status & CELL_PAINTED)
-          kuro->board[iter.x + 1][iter.y].status |= CELL_ERROR;
-        if (iter.y < kuro->board_size - 1 &&
-            kuro->board[iter.x][iter.y + 1].status & CELL_PAINTED)
-          kuro->board[iter.x][iter.y + 1].status |= CELL_ERROR;
+        if (iter.x > 0 && board->cells[iter.x - 1][iter.y].status & CELL_PAINTED)
+          board->cells[iter.x - 1][iter.y].status |= CELL_ERROR;
+        if (iter.y > 0 && board->cells[iter.x][iter.y - 1].status & CELL_PAINTED)
+          board->cells[iter.x][iter.y - 1].status |= CELL_ERROR;
+        if (iter.x < board->size - 1 &&
+            board->cells[iter.x + 1][iter.y].status & CELL_PAINTED)
+          board->cells[iter.x + 1][iter.y].status |= CELL_ERROR;
+        if (iter.y < board->size - 1 &&
+            board->cells[iter.x][iter.y + 1].status & CELL_PAINTED)
+          board->cells[iter.x][iter.y + 1].status |= CELL_ERROR;
       }
     }
   }
 
-  /* Free everything */
-  for (iter.x = 0; iter.x < kuro->board_size; iter.x++)
-    g_free(reached[iter.x]);
-  g_free(reached);
-
-  if (kuro->debug)
+  if (board->debug)
     g_debug(success ? "Rule 3 OK" : "Rule 3 failed");
 
   return success;
 }
 
-gboolean kuro_check_win(Kuro *kuro) {
-  /* Check to see if all three rules are satisfied yet. If they are, we've won.
-   * NOTE: We check rule 1 last, as it's the only rule which won't set an error
-   * position. We check rules 2 and 3 unconditionally because they both set
-   * errors. */
-  gboolean rule2 = kuro_check_rule2(kuro);
-  gboolean rule3 = kuro_check_rule3(kuro);
-
-  if (rule2 && rule3 && kuro_check_rule1(kuro)) {
-    /* Win! */
-    kuro_disable_events(kuro);
-
-    if (kuro_score_is_high_score(kuro, kuro->board_size, kuro->timer_value)) {
-      /* New High Score! */
-      kuro_show_new_high_score_dialog(kuro);
-
-    } else {
-      /* Standard Win */
-      kuro_show_win_dialog(kuro);
-    }
-  }
+/* The public entry points wrap each rule in a profiler mark */
+gboolean kuro_check_rule1(KuroBoard *board) {
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+  gboolean success = check_rule1(board);
 
-  return TRUE;
+  KURO_PROFILER_ADD_MARK(begin, "Rule 1", success ? "OK" : "Failed");
+  return success;
+}
+
+gboolean kuro_check_rule2(KuroBoard *board) {
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+  gboolean success = check_rule2(board);
+
+  KURO_PROFILER_ADD_MARK(begin, "Rule 2", success ? "OK" : "Failed");
+  return success;
+}
+
+gboolean kuro_check_rule3(KuroBoard *board) {
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+  gboolean success = check_rule3(board);
+
+  KURO_PROFILER_ADD_MARK(begin, "Rule 3", success ? "OK" : "Failed");
+  return success;
+}
+
+/* Whether all three rules are satisfied, so the board's solved.
+ * NOTE: We check rule 1 last, as it's the only rule which won't set an error
+ * position. We check rules 2 and 3 unconditionally because they both set
+ * errors. */
+gboolean kuro_check_board(KuroBoard *board) {
+  gboolean rule2 = kuro_check_rule2(board);
+  gboolean rule3 = kuro_check_rule3(board);
+
+  return rule2 && rule3 && kuro_check_rule1(board);
 }
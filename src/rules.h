@@ -18,17 +18,17 @@
  */
 
 #include <glib.h>
-#include "main.h"
+#include "board.h"
 
 #ifndef KURO_RULES_H
 #define KURO_RULES_H
 
 G_BEGIN_DECLS
 
-gboolean kuro_check_rule1 (Kuro *kuro);
-gboolean kuro_check_rule2 (Kuro *kuro);
-gboolean kuro_check_rule3 (Kuro *kuro);
-gboolean kuro_check_win (Kuro *kuro);
+gboolean kuro_check_rule1 (KuroBoard *board);
+gboolean kuro_check_rule2 (KuroBoard *board);
+gboolean kuro_check_rule3 (KuroBoard *board);
+gboolean kuro_check_board (KuroBoard *board);
 
 G_END_DECLS
 
@@ -0,0 +1,433 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "sat.h"
+
+/* Each variable is false, true or unassigned. A literal's value is its
+ * variable's, flipped if it's negated. */
+#define VALUE_FALSE 0
+#define VALUE_TRUE 1
+#define VALUE_UNDEF 2
+
+#define NO_REASON G_MAXUINT
+#define VAR(lit) ((lit) >> 1)
+
+/* Conflicts between restarts are this times the Luby sequence */
+#define RESTART_BASE 64
+
+struct _KuroSat {
+  guint n_vars;
+  gboolean unsatisfiable; /* found out for good */
+
+  /* Clauses are stored one after another as their length then their
+   * literals, and referred to by their offset. The first two literals of
+   * each clause are watched: watches[lit] has the clauses to look at when lit
+   * becomes true, which are those watching its negation. */
+  GArray *clauses; /* of guint */
+  GArray **watches;
+
+  guchar *values; /* per variable */
+  guint *levels;
+  guint *reasons; /* the clause which implied each variable, or NO_REASON */
+  guint *trail;   /* assigned literals, in order */
+  guint n_trail;
+  guint *trail_lims; /* where each decision level starts on the trail */
+  guint n_levels;
+  guint queue_head; /* the first literal on the trail not yet propagated */
+
+  gdouble *activities;
+  gdouble activity_inc;
+  guchar *phases; /* each variable's last value, to try first next time */
+  gboolean *seen; /* for conflict analysis, all FALSE in between */
+  GArray *learnt; /* of guint, the clause being learnt or added */
+  gboolean *model;
+  guint64 n_conflicts; /* over every solve so far */
+};
+
+static guchar lit_value(const KuroSat *sat, guint lit) {
+  guchar value = sat->values[VAR(lit)];
+
+  return (value == VALUE_UNDEF) ? VALUE_UNDEF : value ^ (lit & 1u);
+}
+
+static guint *clause_lits(KuroSat *sat, guint clause) {
+  return &g_array_index(sat->clauses, guint, clause + 1);
+}
+
+static guint clause_size(KuroSat *sat, guint clause) {
+  return g_array_index(sat->clauses, guint, clause);
+}
+
+static void assign(KuroSat *sat, guint lit, guint reason) {
+  guint var = VAR(lit);
+
+  sat->values[var] = (lit & 1u) ? VALUE_FALSE : VALUE_TRUE;
+  sat->levels[var] = sat->n_levels;
+  sat->reasons[var] = reason;
+  sat->trail[sat->n_trail++] = lit;
+}
+
+/* Store a clause of two or more literals, watching its first two */
+static guint attach_clause(KuroSat *sat, const guint *lits, guint n_lits) {
+  guint clause = sat->clauses->len;
+
+  g_array_append_val(sat->clauses, n_lits);
+  g_array_append_vals(sat->clauses, lits, n_lits);
+  g_array_append_val(sat->watches[KURO_SAT_NOT(lits[0])], clause);
+  g_array_append_val(sat->watches[KURO_SAT_NOT(lits[1])], clause);
+
+  return clause;
+}
+
+/* Assign everything implied by the trail so far. Returns the clause which
+ * ended up false, or NO_REASON if none did. */
+static guint propagate(KuroSat *sat) {
+  while (sat->queue_head < sat->n_trail) {
+    guint lit = sat->trail[sat->queue_head++];
+    guint false_lit = KURO_SAT_NOT(lit);
+    GArray *watches = sat->watches[lit];
+    guint *list = (guint *)watches->data;
+    guint i, j, n = watches->len;
+
+    for (i = j = 0; i < n; i++) {
+      guint clause = list[i], *lits = clause_lits(sat, clause);
+      guint size = clause_size(sat, clause), k;
+
+      /* Make sure the literal which has become false is the second */
+      if (lits[0] == false_lit) {
+        lits[0] = lits[1];
+        lits[1] = false_lit;
+      }
+
+      if (lit_value(sat, lits[0]) == VALUE_TRUE) {
+        list[j++] = clause;
+        continue;
+      }
+
+      /* Watch another literal which isn't false, if there is one */
+      for (k = 2; k < size; k++) {
+        if (lit_value(sat, lits[k]) != VALUE_FALSE) {
+          lits[1] = lits[k];
+          lits[k] = false_lit;
+          g_array_append_val(sat->watches[KURO_SAT_NOT(lits[1])], clause);
+          break;
+        }
+      }
+      if (k < size)
+        continue;
+
+      /* Otherwise the clause is unit or false */
+      list[j++] = clause;
+      if (lit_value(sat, lits[0]) == VALUE_FALSE) {
+        for (i++; i < n; i++)
+          list[j++] = list[i];
+        g_array_set_size(watches, j);
+        return clause;
+      }
+      assign(sat, lits[0], clause);
+    }
+
+    g_array_set_size(watches, j);
+  }
+
+  return NO_REASON;
+}
+
+static void cancel_until(KuroSat *sat, guint level) {
+  guint i;
+
+  if (sat->n_levels <= level)
+    return;
+
+  for (i = sat->n_trail; i > sat->trail_lims[level]; i--) {
+    guint var = VAR(sat->trail[i - 1]);
+
+    sat->phases[var] = sat->values[var];
+    sat->values[var] = VALUE_UNDEF;
+  }
+
+  sat->n_trail = sat->queue_head = sat->trail_lims[level];
+  sat->n_levels = level;
+}
+
+static void bump_activity(KuroSat *sat, guint var) {
+  guint i;
+
+  sat->activities[var] += sat->activity_inc;
+  if (sat->activities[var] > 1e100) {
+    for (i = 0; i < sat->n_vars; i++)
+      sat->activities[i] *= 1e-100;
+    sat->activity_inc *= 1e-100;
+  }
+}
+
+/* Learn a clause from the conflict in @clause, going back through the trail
+ * to the first point where a single literal at the current level implies it.
+ * Returns the level to go back to, where the learnt clause is unit. */
+static guint analyze(KuroSat *sat, guint clause) {
+  guint n_paths = 0, lit = G_MAXUINT, index = sat->n_trail, i;
+  guint back_level = 0;
+
+  g_array_set_size(sat->learnt, 1); /* the asserting literal goes first */
+
+  do {
+    guint *lits = clause_lits(sat, clause);
+    guint size = clause_size(sat, clause);
+
+    /* The implied literal is always first in its reason */
+    for (i = (lit == G_MAXUINT) ? 0 : 1; i < size; i++) {
+      guint var = VAR(lits[i]);
+
+      if (sat->seen[var] || sat->levels[var] == 0)
+        continue;
+
+      sat->seen[var] = TRUE;
+      bump_activity(sat, var);
+      if (sat->levels[var] >= sat->n_levels)
+        n_paths++;
+      else
+        g_array_append_val(sat->learnt, lits[i]);
+    }
+
+    /* The next literal on the trail which was part of the conflict */
+    while (!sat->seen[VAR(sat->trail[--index])])
+      ;
+    lit = sat->trail[index];
+    clause = sat->reasons[VAR(lit)];
+    sat->seen[VAR(lit)] = FALSE;
+    n_paths--;
+  } while (n_paths > 0);
+
+  g_array_index(sat->learnt, guint, 0) = KURO_SAT_NOT(lit);
+
+  /* Go back to the highest level among the rest, which is watched second */
+  for (i = 1; i < sat->learnt->len; i++) {
+    guint *learnt = (guint *)sat->learnt->data;
+    guint level = sat->levels[VAR(learnt[i])];
+
+    sat->seen[VAR(learnt[i])] = FALSE;
+    if (level > back_level) {
+      guint tmp = learnt[1];
+
+      back_level = level;
+      learnt[1] = learnt[i];
+      learnt[i] = tmp;
+    }
+  }
+
+  return back_level;
+}
+
+/* 1, 1, 2, 1, 1, 2, 4, … */
+static guint64 luby(guint64 i) {
+  guint64 size = 1, power = 1;
+
+  while (size < i + 1) {
+    size = size * 2 + 1;
+    power *= 2;
+  }
+
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    power /= 2;
+    i %= size;
+  }
+
+  return power;
+}
+
+KuroSat *kuro_sat_new(guint n_vars) {
+  KuroSat *sat = g_new0(KuroSat, 1);
+  guint i;
+
+  sat->n_vars = n_vars;
+  sat->clauses = g_array_new(FALSE, FALSE, sizeof(guint));
+  sat->watches = g_new(GArray *, n_vars * 2);
+  for (i = 0; i < n_vars * 2; i++)
+    sat->watches[i] = g_array_new(FALSE, FALSE, sizeof(guint));
+
+  sat->values = g_new(guchar, n_vars);
+  memset(sat->values, VALUE_UNDEF, n_vars);
+  sat->levels = g_new0(guint, n_vars);
+  sat->reasons = g_new(guint, n_vars);
+  sat->trail = g_new(guint, n_vars);
+  sat->trail_lims = g_new(guint, n_vars + 1);
+
+  sat->activities = g_new0(gdouble, n_vars);
+  sat->activity_inc = 1.0;
+  sat->phases = g_new0(guchar, n_vars); /* false first */
+  sat->seen = g_new0(gboolean, n_vars);
+  sat->learnt = g_array_new(FALSE, FALSE, sizeof(guint));
+  sat->model = g_new0(gboolean, n_vars);
+
+  return sat;
+}
+
+void kuro_sat_free(KuroSat *sat) {
+  guint i;
+
+  if (sat == NULL)
+    return;
+
+  for (i = 0; i < sat->n_vars * 2; i++)
+    g_array_unref(sat->watches[i]);
+  g_free(sat->watches);
+  g_array_unref(sat->clauses);
+  g_free(sat->values);
+  g_free(sat->levels);
+  g_free(sat->reasons);
+  g_free(sat->trail);
+  g_free(sat->trail_lims);
+  g_free(sat->activities);
+  g_free(sat->phases);
+  g_free(sat->seen);
+  g_array_unref(sat->learnt);
+  g_free(sat->model);
+  g_free(sat);
+}
+
+/* Add a clause: at least one of @lits must be true. Returns FALSE if that
+ * makes the problem unsatisfiable. */
+gboolean kuro_sat_add_clause(KuroSat *sat, const guint *lits, guint n_lits) {
+  guint *kept, n_kept = 0, i, j;
+
+  if (sat->unsatisfiable)
+    return FALSE;
+
+  cancel_until(sat, 0);
+
+  /* Drop literals which are already false or repeated, and clauses which
+   * are already true or always will be. The learnt clause's space isn't
+   * used in between solves, so they're gathered there. */
+  g_array_set_size(sat->learnt, n_lits);
+  kept = (guint *)sat->learnt->data;
+  for (i = 0; i < n_lits; i++) {
+    guchar value;
+
+    g_return_val_if_fail(VAR(lits[i]) < sat->n_vars, FALSE);
+
+    value = lit_value(sat, lits[i]);
+    if (value == VALUE_TRUE)
+      return TRUE;
+    if (value == VALUE_FALSE)
+      continue;
+
+    for (j = 0; j < n_kept && kept[j] != lits[i]; j++) {
+      if (kept[j] == KURO_SAT_NOT(lits[i]))
+        return TRUE;
+    }
+    if (j == n_kept)
+      kept[n_kept++] = lits[i];
+  }
+
+  if (n_kept == 0) {
+    sat->unsatisfiable = TRUE;
+  } else if (n_kept == 1) {
+    assign(sat, kept[0], NO_REASON);
+    sat->unsatisfiable = propagate(sat) != NO_REASON;
+  } else {
+    attach_clause(sat, kept, n_kept);
+  }
+
+  return !sat->unsatisfiable;
+}
+
+/* Look for an assignment which satisfies every clause, giving up after
+ * @max_conflicts conflicts, or never if it's 0 */
+KuroSatResult kuro_sat_solve(KuroSat *sat, guint64 max_conflicts) {
+  guint64 n_conflicts = 0, n_restarts = 0, next_restart;
+
+  if (sat->unsatisfiable)
+    return KURO_SAT_UNSATISFIABLE;
+
+  next_restart = luby(0) * RESTART_BASE;
+
+  for (;;) {
+    guint conflict = propagate(sat);
+
+    if (conflict != NO_REASON) {
+      guint back_level;
+
+      n_conflicts++;
+      sat->n_conflicts++;
+      if (sat->n_levels == 0) {
+        sat->unsatisfiable = TRUE;
+        return KURO_SAT_UNSATISFIABLE;
+      }
+
+      back_level = analyze(sat, conflict);
+      cancel_until(sat, back_level);
+
+      if (sat->learnt->len == 1) {
+        assign(sat, g_array_index(sat->learnt, guint, 0), NO_REASON);
+      } else {
+        guint *learnt = (guint *)sat->learnt->data;
+
+        assign(sat, learnt[0], attach_clause(sat, learnt, sat->learnt->len));
+      }
+
+      sat->activity_inc /= 0.95;
+
+      if (max_conflicts != 0 && n_conflicts >= max_conflicts) {
+        cancel_until(sat, 0);
+        return KURO_SAT_UNKNOWN;
+      }
+      if (n_conflicts >= next_restart) {
+        next_restart = n_conflicts + luby(++n_restarts) * RESTART_BASE;
+        cancel_until(sat, 0);
+      }
+    } else {
+      guint var, best = G_MAXUINT;
+
+      /* Decide the most active unassigned variable, the way it last was */
+      for (var = 0; var < sat->n_vars; var++) {
+        if (sat->values[var] == VALUE_UNDEF &&
+            (best == G_MAXUINT ||
+             sat->activities[var] > sat->activities[best]))
+          best = var;
+      }
+
+      if (best == G_MAXUINT) {
+        for (var = 0; var < sat->n_vars; var++)
+          sat->model[var] = sat->values[var] == VALUE_TRUE;
+        cancel_until(sat, 0);
+        return KURO_SAT_SATISFIABLE;
+      }
+
+      sat->trail_lims[sat->n_levels++] = sat->n_trail;
+      assign(sat, KURO_SAT_LIT(best, sat->phases[best] != VALUE_TRUE),
+             NO_REASON);
+    }
+  }
+}
+
+/* The value of @var in the assignment found by the last successful solve */
+gboolean kuro_sat_get_model(const KuroSat *sat, guint var) {
+  g_return_val_if_fail(var < sat->n_vars, FALSE);
+
+  return sat->model[var];
+}
+
+/* How many conflicts every solve so far has run into between them */
+guint64 kuro_sat_get_n_conflicts(const KuroSat *sat) {
+  return sat->n_conflicts;
+}
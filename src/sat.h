@@ -0,0 +1,52 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_SAT_H
+#define KURO_SAT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* A small conflict-driven clause learning SAT solver, for proving things
+ * about boards too big to search. Clauses can be added between solves, and
+ * what was learnt from earlier solves is kept. */
+typedef struct _KuroSat KuroSat;
+
+typedef enum {
+  KURO_SAT_UNKNOWN, /* gave up after too many conflicts */
+  KURO_SAT_SATISFIABLE,
+  KURO_SAT_UNSATISFIABLE
+} KuroSatResult;
+
+/* Literals are variables shifted up by one, with the bottom bit set if
+ * they're negated */
+#define KURO_SAT_LIT(var, negated) (((guint)(var) << 1) | ((negated) ? 1u : 0u))
+#define KURO_SAT_NOT(lit) ((lit) ^ 1u)
+
+KuroSat *kuro_sat_new(guint n_vars) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_sat_free(KuroSat *sat);
+gboolean kuro_sat_add_clause(KuroSat *sat, const guint *lits, guint n_lits);
+KuroSatResult kuro_sat_solve(KuroSat *sat, guint64 max_conflicts);
+gboolean kuro_sat_get_model(const KuroSat *sat, guint var);
+guint64 kuro_sat_get_n_conflicts(const KuroSat *sat);
+
+G_END_DECLS
+
+#endif /* KURO_SAT_H */
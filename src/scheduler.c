@@ -0,0 +1,210 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config.h"
+#include "profiler.h"
+
+#include "scheduler.h"
+
+typedef struct {
+  KuroScheduler *scheduler;
+  guint id;
+  KuroTaskKind kind;
+  guint interval; /* ms, or 0 for an idle task */
+  GSourceFunc func;
+  gpointer user_data;
+  guint source_id; /* 0 while suspended */
+} KuroTask;
+
+struct _KuroScheduler {
+  GHashTable *tasks; /* task ID → KuroTask */
+  guint next_id;
+  gboolean visible;
+  gboolean focused;
+  KuroSchedulerFunc changed_func;
+  gpointer user_data;
+};
+
+static void suspend_task(KuroTask *task) {
+  if (task->source_id != 0) {
+    g_source_remove(task->source_id);
+    task->source_id = 0;
+  }
+}
+
+static void task_free(KuroTask *task) {
+  suspend_task(task);
+  g_free(task);
+}
+
+static gboolean task_dispatch_cb(gpointer user_data) {
+  KuroTask *task = user_data;
+  KuroScheduler *scheduler = task->scheduler;
+  guint id = task->id;
+
+  if (task->func(task->user_data) == G_SOURCE_CONTINUE)
+    return G_SOURCE_CONTINUE;
+
+  /* The task may have removed itself already */
+  task = g_hash_table_lookup(scheduler->tasks, GUINT_TO_POINTER(id));
+  if (task != NULL) {
+    task->source_id = 0;
+    g_hash_table_remove(scheduler->tasks, GUINT_TO_POINTER(id));
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void resume_task(KuroTask *task) {
+  gint priority;
+
+  if (task->source_id != 0)
+    return;
+
+  priority = (task->kind == KURO_TASK_BACKGROUND) ? G_PRIORITY_LOW
+                                                  : G_PRIORITY_DEFAULT;
+
+  if (task->interval == 0)
+    task->source_id = g_idle_add_full(priority, task_dispatch_cb, task, NULL);
+  else
+    task->source_id = g_timeout_add_full(priority, task->interval,
+                                         task_dispatch_cb, task, NULL);
+}
+
+KuroScheduler *kuro_scheduler_new(KuroSchedulerFunc changed_func,
+                                  gpointer user_data) {
+  KuroScheduler *scheduler = g_new0(KuroScheduler, 1);
+
+  scheduler->tasks = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                           (GDestroyNotify)task_free);
+  scheduler->visible = TRUE;
+  scheduler->focused = TRUE;
+  scheduler->changed_func = changed_func;
+  scheduler->user_data = user_data;
+
+  return scheduler;
+}
+
+void kuro_scheduler_free(KuroScheduler *scheduler) {
+  if (scheduler == NULL)
+    return;
+
+  g_hash_table_unref(scheduler->tasks);
+  g_free(scheduler);
+}
+
+gboolean kuro_scheduler_is_running(KuroScheduler *scheduler,
+                                   KuroTaskKind kind) {
+  switch (kind) {
+  case KURO_TASK_TIMER:
+  case KURO_TASK_ANIMATION:
+    return scheduler->visible;
+  case KURO_TASK_BACKGROUND:
+    return scheduler->visible && scheduler->focused;
+  case KURO_N_TASK_KINDS:
+  default:
+    g_assert_not_reached();
+  }
+
+  return FALSE;
+}
+
+/* Suspend or resume every task to match the window */
+static void update_tasks(KuroScheduler *scheduler) {
+  GHashTableIter iter;
+  gpointer value;
+  guint n_running = 0;
+
+  g_hash_table_iter_init(&iter, scheduler->tasks);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    KuroTask *task = value;
+
+    if (kuro_scheduler_is_running(scheduler, task->kind)) {
+      resume_task(task);
+      n_running++;
+    } else {
+      suspend_task(task);
+    }
+  }
+
+  KURO_PROFILER_ADD_MARK_PRINTF(KURO_PROFILER_CURRENT_TIME, "Scheduler",
+                                "%s, %s, %u of %u tasks running",
+                                scheduler->visible ? "shown" : "hidden",
+                                scheduler->focused ? "focused" : "unfocused",
+                                n_running, g_hash_table_size(scheduler->tasks));
+
+  if (scheduler->changed_func != NULL)
+    scheduler->changed_func(scheduler, scheduler->user_data);
+}
+
+void kuro_scheduler_set_visible(KuroScheduler *scheduler, gboolean visible) {
+  if (scheduler->visible == visible)
+    return;
+
+  scheduler->visible = visible;
+  update_tasks(scheduler);
+}
+
+void kuro_scheduler_set_focused(KuroScheduler *scheduler, gboolean focused) {
+  if (scheduler->focused == focused)
+    return;
+
+  scheduler->focused = focused;
+  update_tasks(scheduler);
+}
+
+static guint add_task(KuroScheduler *scheduler, KuroTaskKind kind,
+                      guint interval, GSourceFunc func, gpointer user_data) {
+  KuroTask *task = g_new0(KuroTask, 1);
+
+  task->scheduler = scheduler;
+  task->id = ++scheduler->next_id;
+  task->kind = kind;
+  task->interval = interval;
+  task->func = func;
+  task->user_data = user_data;
+
+  g_hash_table_insert(scheduler->tasks, GUINT_TO_POINTER(task->id), task);
+  if (kuro_scheduler_is_running(scheduler, kind))
+    resume_task(task);
+
+  return task->id;
+}
+
+/* Like g_timeout_add(), but the interval starts over when a suspended task
+ * is resumed. Returns a task ID for kuro_scheduler_remove(). */
+guint kuro_scheduler_add_timeout(KuroScheduler *scheduler, KuroTaskKind kind,
+                                 guint interval, GSourceFunc func,
+                                 gpointer user_data) {
+  g_return_val_if_fail(interval > 0, 0);
+
+  return add_task(scheduler, kind, interval, func, user_data);
+}
+
+guint kuro_scheduler_add_idle(KuroScheduler *scheduler, KuroTaskKind kind,
+                              GSourceFunc func, gpointer user_data) {
+  return add_task(scheduler, kind, 0, func, user_data);
+}
+
+void kuro_scheduler_remove(KuroScheduler *scheduler, guint task_id) {
+  if (g_hash_table_remove(scheduler->tasks, GUINT_TO_POINTER(task_id)) ==
+      FALSE)
+    g_warning("No scheduler task with ID %u", task_id);
+}
@@ -0,0 +1,63 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef KURO_SCHEDULER_H
+#define KURO_SCHEDULER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* What a task is for, which decides when it's allowed to run */
+typedef enum {
+  KURO_TASK_TIMER,      /* the game clock; only while the window is shown */
+  KURO_TASK_ANIMATION,  /* hint flashes and the like; only while shown */
+  KURO_TASK_BACKGROUND, /* low-priority work; only while shown and focused */
+  KURO_N_TASK_KINDS
+} KuroTaskKind;
+
+/* Runs the main loop sources of the whole game, removing them while the
+ * window can't be seen and adding them back once it can, so nothing wakes up
+ * on an idle desktop. Task IDs stay valid across suspensions. */
+typedef struct _KuroScheduler KuroScheduler;
+
+typedef void (*KuroSchedulerFunc)(KuroScheduler *scheduler,
+                                  gpointer user_data);
+
+KuroScheduler *kuro_scheduler_new(KuroSchedulerFunc changed_func,
+                                  gpointer user_data)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_scheduler_free(KuroScheduler *scheduler);
+
+void kuro_scheduler_set_visible(KuroScheduler *scheduler, gboolean visible);
+void kuro_scheduler_set_focused(KuroScheduler *scheduler, gboolean focused);
+gboolean kuro_scheduler_is_running(KuroScheduler *scheduler,
+                                   KuroTaskKind kind);
+
+guint kuro_scheduler_add_timeout(KuroScheduler *scheduler, KuroTaskKind kind,
+                                 guint interval, GSourceFunc func,
+                                 gpointer user_data);
+guint kuro_scheduler_add_idle(KuroScheduler *scheduler, KuroTaskKind kind,
+                              GSourceFunc func, gpointer user_data);
+void kuro_scheduler_remove(KuroScheduler *scheduler, guint task_id);
+
+G_END_DECLS
+
+#endif /* KURO_SCHEDULER_H */
@@ -18,153 +18,363 @@
  */
 
 #include "config.h"
-#include "main.h"
-#include <glib/gi18n.h>
+#include "profiler.h"
 
 #include "score.h"
 
+struct _KuroScoreStore {
+  GSettings *settings;
+  gulong changed_id;
+  guint write_id;    /* pending write back to GSettings */
+  gboolean writing;  /* ignore change notifications for our own writes */
+  gboolean loaded;   /* the index is only read in when first needed */
+  GPtrArray *by_size[MAX_BOARD_SIZE + 1]; /* sorted, at most MAX_HIGH_SCORES */
+};
+
 void kuro_score_free(KuroScore *score) {
   g_free(score->name);
   g_free(score);
 }
 
 static gint compare_scores(gconstpointer a, gconstpointer b) {
-  const KuroScore *score_a = (const KuroScore *)a;
-  const KuroScore *score_b = (const KuroScore *)b;
+  const KuroScore *score_a = *(KuroScore *const *)a;
+  const KuroScore *score_b = *(KuroScore *const *)b;
 
-  if (score_a->time < score_b->time)
+  if (score_a->time_ms < score_b->time_ms)
     return -1;
-  else if (score_a->time > score_b->time)
+  else if (score_a->time_ms > score_b->time_ms)
     return 1;
 
   return 0;
 }
 
-GList *kuro_score_get_top_scores(Kuro *kuro, guint board_size) {
+static void clear_index(KuroScoreStore *store) {
+  guint i;
+
+  for (i = 0; i <= MAX_BOARD_SIZE; i++)
+    g_clear_pointer(&store->by_size[i], g_ptr_array_unref);
+}
+
+static GPtrArray *get_scores_for_size(KuroScoreStore *store,
+                                      guint board_size) {
+  if (store->by_size[board_size] == NULL)
+    store->by_size[board_size] = g_ptr_array_new_full(
+        MAX_HIGH_SCORES + 1, (GDestroyNotify)kuro_score_free);
+
+  return store->by_size[board_size];
+}
+
+/* Rebuild the whole index from GSettings. This only happens at startup and
+ * when something else changes the key. Scores saved before times were kept in
+ * milliseconds are read from the old key until the first write. */
+static void load_index(KuroScoreStore *store) {
   GVariant *variant;
   GVariantIter iter;
-  guint size, time;
-  gchar *name = NULL;
-  GList *scores = NULL;
+  guint size, time, scale, i;
+  const gchar *name;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  clear_index(store);
 
-  variant = g_settings_get_value(kuro->settings, "high-scores");
+  variant = g_settings_get_user_value(store->settings, "high-scores-ms");
+  scale = 1;
+  if (variant == NULL) {
+    variant = g_settings_get_value(store->settings, "high-scores");
+    scale = 1000;
+  }
   g_variant_iter_init(&iter, variant);
 
-  while (g_variant_iter_loop(&iter, "(usu)", &size, &name, &time)) {
-    if (size == board_size) {
-      KuroScore *score = g_new0(KuroScore, 1);
-      score->board_size = size;
-      score->name = g_strdup(name);
-      score->time = time;
-      scores = g_list_prepend(scores, score);
-    }
+  while (g_variant_iter_next(&iter, "(u&su)", &size, &name, &time)) {
+    KuroScore *score;
+
+    if (size == 0 || size > MAX_BOARD_SIZE)
+      continue;
+
+    score = g_new0(KuroScore, 1);
+    score->board_size = size;
+    score->name = g_strdup(name);
+    score->time_ms = (guint)MIN((guint64)time * scale, G_MAXUINT);
+    g_ptr_array_add(get_scores_for_size(store, size), score);
   }
 
   g_variant_unref(variant);
 
-  scores = g_list_sort(scores, compare_scores);
+  /* The key should already be sorted and trimmed, but don't rely on it */
+  for (i = 0; i <= MAX_BOARD_SIZE; i++) {
+    if (store->by_size[i] == NULL)
+      continue;
 
-  /* Keep only top 10 */
-  /* Since we're just reading here, we return all of them, but the saving logic
-     ensures top 10. Wait, if we change board size strategy we might have more.
-     Let's clamp here too just in case. */
+    g_ptr_array_sort(store->by_size[i], compare_scores);
+    if (store->by_size[i]->len > MAX_HIGH_SCORES)
+      g_ptr_array_set_size(store->by_size[i], MAX_HIGH_SCORES);
+  }
 
-  /* Actually for display we might want to ensure it's limited,
-     but typically we limit on write. */
+  store->loaded = TRUE;
 
-  return scores;
+  KURO_PROFILER_ADD_MARK(begin, "Load high scores", NULL);
 }
 
-gboolean kuro_score_is_high_score(Kuro *kuro, guint board_size, guint time) {
-  GList *scores = kuro_score_get_top_scores(kuro, board_size);
-  guint count = g_list_length(scores);
-  gboolean is_high = FALSE;
+static KuroScoreStore *ensure_loaded(KuroScoreStore *store) {
+  if (!store->loaded)
+    load_index(store);
 
-  if (count < 10) {
-    is_high = TRUE;
-  } else {
-    KuroScore *last = (KuroScore *)g_list_last(scores)->data;
-    if (time < last->time)
-      is_high = TRUE;
-  }
+  return store;
+}
 
-  g_list_free_full(scores, (GDestroyNotify)kuro_score_free);
-  return is_high;
+static void settings_changed_cb(GSettings *settings, const gchar *key,
+                                gpointer user_data) {
+  KuroScoreStore *store = user_data;
+
+  /* A pending write holds newer scores than the key does, and an index
+   * which hasn't been loaded yet will read the new key anyway */
+  if (store->writing || store->write_id != 0 || !store->loaded)
+    return;
+
+  load_index(store);
 }
 
-void kuro_score_add(Kuro *kuro, guint board_size, const gchar *name,
-                    guint time) {
-  GVariant *variant;
-  GVariantIter iter;
-  guint size, t;
-  gchar *n = NULL;
+static void write_index(KuroScoreStore *store) {
   GVariantBuilder builder;
-  GList *scores = NULL;
-  GList *l;
-
-  /* Load existing scores for ALL sizes, but parsing them into a list structure
-     might be complex if we want to preserve other sizes.
-     Actually, GVariantBuilder makes this easier. We can iterate the existing
-     ones, parse the ones matching our board_size into a list, add the new one,
-     sort, trim, and then rebuild the GVariant with the new list + the untouched
-     ones from other sizes. */
-
-  /* Approach:
-     1. Read all scores.
-     2. Append scores NOT matching current board_size directly to builder.
-     3. Collect scores matching current board_size into a GList.
-     4. Add new score to GList.
-     5. Sort GList.
-     6. Trim GList to 10.
-     7. Append GList items to builder.
-     8. Save.
-  */
-
-  variant = g_settings_get_value(kuro->settings, "high-scores");
+  guint i, j;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
   g_variant_builder_init(&builder, G_VARIANT_TYPE("a(usu)"));
-  g_variant_iter_init(&iter, variant);
 
-  /* Step 1 & 2 & 3 */
-  while (g_variant_iter_loop(&iter, "(usu)", &size, &n, &t)) {
-    if (size != board_size) {
-      g_variant_builder_add(&builder, "(usu)", size, n, t);
-    } else {
-      KuroScore *s = g_new0(KuroScore, 1);
-      s->board_size = size;
-      s->name = g_strdup(n);
-      s->time = t;
-      scores = g_list_prepend(scores, s);
+  for (i = 0; i <= MAX_BOARD_SIZE; i++) {
+    if (store->by_size[i] == NULL)
+      continue;
+
+    for (j = 0; j < store->by_size[i]->len; j++) {
+      const KuroScore *score = g_ptr_array_index(store->by_size[i], j);
+      g_variant_builder_add(&builder, "(usu)", score->board_size, score->name,
+                            score->time_ms);
     }
   }
 
-  g_variant_unref(variant);
+  store->writing = TRUE;
+  g_settings_set_value(store->settings, "high-scores-ms",
+                       g_variant_builder_end(&builder));
+  store->writing = FALSE;
+
+  KURO_PROFILER_ADD_MARK(begin, "Save high scores", NULL);
+}
+
+static gboolean write_idle_cb(gpointer user_data) {
+  KuroScoreStore *store = user_data;
+
+  store->write_id = 0;
+  write_index(store);
+
+  return G_SOURCE_REMOVE;
+}
+
+KuroScoreStore *kuro_score_store_new(GSettings *settings) {
+  KuroScoreStore *store = g_new0(KuroScoreStore, 1);
+
+  store->settings = g_object_ref(settings);
+  store->changed_id =
+      g_signal_connect(settings, "changed::high-scores-ms",
+                       G_CALLBACK(settings_changed_cb), store);
+
+  return store;
+}
 
-  /* Step 4 */
-  KuroScore *new_score = g_new0(KuroScore, 1);
-  new_score->board_size = board_size;
-  new_score->name = g_strdup(name);
-  new_score->time = time;
-  scores = g_list_prepend(scores, new_score);
-
-  /* Step 5 */
-  scores = g_list_sort(scores, compare_scores);
-
-  /* Step 6 */
-  while (g_list_length(scores) > 10) {
-    GList *last = g_list_last(scores);
-    kuro_score_free((KuroScore *)last->data);
-    scores = g_list_delete_link(scores, last);
+void kuro_score_store_free(KuroScoreStore *store) {
+  if (store == NULL)
+    return;
+
+  /* Don't lose a score which hasn't been written out yet */
+  if (store->write_id != 0) {
+    g_source_remove(store->write_id);
+    store->write_id = 0;
+    write_index(store);
   }
 
-  /* Step 7 */
-  for (l = scores; l != NULL; l = l->next) {
-    KuroScore *s = (KuroScore *)l->data;
-    g_variant_builder_add(&builder, "(usu)", s->board_size, s->name, s->time);
+  g_signal_handler_disconnect(store->settings, store->changed_id);
+  g_object_unref(store->settings);
+  clear_index(store);
+  g_free(store);
+}
+
+/* Returns the scores for @board_size, best first, or NULL if there are none.
+ * The array belongs to the store and is only valid until the next change. */
+const GPtrArray *kuro_score_get_top_scores(KuroScoreStore *store,
+                                           guint board_size) {
+  g_return_val_if_fail(board_size <= MAX_BOARD_SIZE, NULL);
+
+  return ensure_loaded(store)->by_size[board_size];
+}
+
+/* Where a new score of @time_ms goes among @scores, sorted best first, which
+ * may be NULL: ahead of the first score no better than it, so ahead of any
+ * equal times */
+guint kuro_score_find_position(const GPtrArray *scores, guint time_ms) {
+  guint low = 0, high = (scores != NULL) ? scores->len : 0;
+
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
+    const KuroScore *other = g_ptr_array_index(scores, mid);
+
+    if (other->time_ms < time_ms)
+      low = mid + 1;
+    else
+      high = mid;
   }
 
-  g_list_free_full(scores, (GDestroyNotify)kuro_score_free);
+  return low;
+}
 
-  /* Step 8 */
-  g_settings_set_value(kuro->settings, "high-scores",
-                       g_variant_builder_end(&builder));
+gboolean kuro_score_is_high_score(KuroScoreStore *store, guint board_size,
+                                  guint time_ms) {
+  const GPtrArray *scores;
+  const KuroScore *last;
+
+  g_return_val_if_fail(board_size <= MAX_BOARD_SIZE, FALSE);
+
+  scores = ensure_loaded(store)->by_size[board_size];
+  if (scores == NULL || scores->len < MAX_HIGH_SCORES)
+    return TRUE;
+
+  last = g_ptr_array_index(scores, scores->len - 1);
+  return time_ms < last->time_ms;
+}
+
+void kuro_score_add(KuroScoreStore *store, guint board_size,
+                    const gchar *name, guint time_ms) {
+  GPtrArray *scores;
+  KuroScore *score;
+  guint position;
+
+  g_return_if_fail(board_size > 0 && board_size <= MAX_BOARD_SIZE);
+
+  scores = get_scores_for_size(ensure_loaded(store), board_size);
+
+  position = kuro_score_find_position(scores, time_ms);
+  if (position >= MAX_HIGH_SCORES)
+    return;
+
+  score = g_new0(KuroScore, 1);
+  score->board_size = board_size;
+  score->name = g_strdup(name);
+  score->time_ms = time_ms;
+  g_ptr_array_insert(scores, (gint)position, score);
+
+  if (scores->len > MAX_HIGH_SCORES)
+    g_ptr_array_set_size(scores, MAX_HIGH_SCORES);
+
+  /* Write back once the main loop's idle, coalescing several changes */
+  if (store->write_id == 0)
+    store->write_id = g_idle_add(write_idle_cb, store);
+}
+
+struct _KuroScoreItem {
+  GObject parent;
+  guint rank;
+  KuroScore score;
+};
+
+enum {
+  PROP_RANK = 1,
+  PROP_BOARD_SIZE,
+  PROP_NAME,
+  PROP_TIME_MS,
+  N_ITEM_PROPS
+};
+
+static GParamSpec *item_props[N_ITEM_PROPS] = {NULL};
+
+G_DEFINE_FINAL_TYPE(KuroScoreItem, kuro_score_item, G_TYPE_OBJECT)
+
+static void kuro_score_item_get_property(GObject *object, guint property_id,
+                                         GValue *value, GParamSpec *pspec) {
+  KuroScoreItem *self = KURO_SCORE_ITEM(object);
+
+  switch (property_id) {
+  case PROP_RANK:
+    g_value_set_uint(value, self->rank);
+    break;
+  case PROP_BOARD_SIZE:
+    g_value_set_uint(value, self->score.board_size);
+    break;
+  case PROP_NAME:
+    g_value_set_string(value, self->score.name);
+    break;
+  case PROP_TIME_MS:
+    g_value_set_uint(value, self->score.time_ms);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+    break;
+  }
+}
+
+static void kuro_score_item_finalize(GObject *object) {
+  KuroScoreItem *self = KURO_SCORE_ITEM(object);
+
+  g_free(self->score.name);
+
+  G_OBJECT_CLASS(kuro_score_item_parent_class)->finalize(object);
+}
+
+static void kuro_score_item_class_init(KuroScoreItemClass *klass) {
+  GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+
+  gobject_class->get_property = kuro_score_item_get_property;
+  gobject_class->finalize = kuro_score_item_finalize;
+
+  item_props[PROP_RANK] =
+      g_param_spec_uint("rank", NULL, NULL, 0, G_MAXUINT, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_BOARD_SIZE] =
+      g_param_spec_uint("board-size", NULL, NULL, 0, G_MAXUINT, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_NAME] = g_param_spec_string(
+      "name", NULL, NULL, NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  item_props[PROP_TIME_MS] =
+      g_param_spec_uint("time-ms", NULL, NULL, 0, G_MAXUINT, 0,
+                        G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties(gobject_class, N_ITEM_PROPS, item_props);
+}
+
+static void kuro_score_item_init(KuroScoreItem *self) {}
+
+guint kuro_score_item_get_rank(KuroScoreItem *item) {
+  g_return_val_if_fail(KURO_IS_SCORE_ITEM(item), 0);
+
+  return item->rank;
+}
+
+const KuroScore *kuro_score_item_get_score(KuroScoreItem *item) {
+  g_return_val_if_fail(KURO_IS_SCORE_ITEM(item), NULL);
+
+  return &item->score;
+}
+
+/* Snapshot every size's high scores as a list, smallest boards first */
+GListModel *kuro_score_store_list(KuroScoreStore *store) {
+  GListStore *list = g_list_store_new(KURO_TYPE_SCORE_ITEM);
+  guint i, j;
+
+  ensure_loaded(store);
+
+  for (i = 0; i <= MAX_BOARD_SIZE; i++) {
+    if (store->by_size[i] == NULL)
+      continue;
+
+    for (j = 0; j < store->by_size[i]->len; j++) {
+      const KuroScore *score = g_ptr_array_index(store->by_size[i], j);
+      KuroScoreItem *item = g_object_new(KURO_TYPE_SCORE_ITEM, NULL);
+
+      item->rank = j + 1;
+      item->score.board_size = score->board_size;
+      item->score.name = g_strdup(score->name);
+      item->score.time_ms = score->time_ms;
+
+      g_list_store_append(list, item);
+      g_object_unref(item);
+    }
+  }
+
+  return G_LIST_MODEL(list);
 }
@@ -20,23 +20,45 @@
 #ifndef KURO_SCORE_H
 #define KURO_SCORE_H
 
+#include <gio/gio.h>
+#include <glib-object.h>
 #include <glib.h>
 
 G_BEGIN_DECLS
 
-typedef struct _KuroApplication Kuro;
+#define MAX_HIGH_SCORES 10
 
 typedef struct {
   guint board_size;
   gchar *name;
-  guint time;
+  guint time_ms;
 } KuroScore;
 
+/* The high scores for every board size, sorted and trimmed in memory, and
+ * kept in sync with the high-scores-ms GSettings key. */
+typedef struct _KuroScoreStore KuroScoreStore;
+
+KuroScoreStore *kuro_score_store_new(GSettings *settings)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_score_store_free(KuroScoreStore *store);
+
 void kuro_score_free(KuroScore *score);
-GList *kuro_score_get_top_scores(Kuro *kuro, guint board_size);
-gboolean kuro_score_is_high_score(Kuro *kuro, guint board_size, guint time);
-void kuro_score_add(Kuro *kuro, guint board_size, const gchar *name,
-                    guint time);
+const GPtrArray *kuro_score_get_top_scores(KuroScoreStore *store,
+                                           guint board_size);
+guint kuro_score_find_position(const GPtrArray *scores, guint time_ms);
+gboolean kuro_score_is_high_score(KuroScoreStore *store, guint board_size,
+                                  guint time_ms);
+void kuro_score_add(KuroScoreStore *store, guint board_size,
+                    const gchar *name, guint time_ms);
+
+/* A high score as a list item, with its rank for that board size */
+#define KURO_TYPE_SCORE_ITEM (kuro_score_item_get_type())
+G_DECLARE_FINAL_TYPE(KuroScoreItem, kuro_score_item, KURO, SCORE_ITEM, GObject)
+
+guint kuro_score_item_get_rank(KuroScoreItem *item);
+const KuroScore *kuro_score_item_get_score(KuroScoreItem *item);
+GListModel *kuro_score_store_list(KuroScoreStore *store)
+    G_GNUC_WARN_UNUSED_RESULT;
 
 G_END_DECLS
 
@@ -0,0 +1,527 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "profiler.h"
+#include "search.h"
+
+/* Solutions are searched for by deciding cells one at a time, following up
+ * each decision by the rules, and backing up when they're broken. Every
+ * decision leaves another branch to look down later, which goes on the
+ * worker's own deque of tasks. Workers take their newest task, so each one
+ * goes deep first; when a worker runs out, it steals the oldest task of
+ * another, which is the biggest part of the tree left to search, or if there
+ * aren't any, waits for one. */
+
+/* How many decisions a worker makes before adding them to the total, unless
+ * the search is allowed fewer than that */
+#define NODE_BATCH 1024
+
+typedef enum { STATE_OPEN, STATE_WHITE, STATE_BLACK } CellState;
+
+/* A part of the tree left to search: a partial solution, and the cell just
+ * decided in it, whose consequences are still to be followed up */
+typedef struct {
+  guint decided;
+  guchar states[]; /* CellState of each cell, indexed as [x * size + y] */
+} Task;
+
+typedef struct {
+  GMutex lock;
+  Task **tasks; /* a ring buffer, oldest first */
+  guint head;
+  guint n_tasks;
+  guint capacity;
+} Deque;
+
+typedef struct {
+  guint size;
+  guint n_cells;
+  guint16 *nums; /* each cell's number */
+
+  Deque *deques; /* one per worker */
+  guint n_workers;
+  gint n_pending; /* tasks queued or being searched */
+  gint cancelled; /* set once enough solutions have been found, or too many
+                   * decisions made */
+
+  /* Idle workers wait for a task to be queued, or for the search to end */
+  GMutex idle_lock;
+  GCond idle_cond;
+  gint n_idle;
+
+  GMutex lock; /* for the counts */
+  guint64 n_solutions;
+  guint64 limit;
+  KuroCell **solution; /* where the first solution's marked, or NULL */
+  guint64 n_nodes;
+  guint64 max_nodes;
+  guint node_batch; /* decisions a worker makes between adding them up */
+  gboolean gave_up;
+} Search;
+
+typedef struct {
+  Search *search;
+  guint index;
+  GThread *thread;
+
+  guint n_nodes; /* not yet added to the search's total */
+
+  /* Scratch space */
+  guint *queue;
+  guint *stack;
+  gboolean *reached;
+} Worker;
+
+static Task *task_new(const Search *search, const guchar *states,
+                      guint decided) {
+  Task *task = g_malloc(sizeof(Task) + search->n_cells);
+
+  task->decided = decided;
+  memcpy(task->states, states, search->n_cells);
+
+  return task;
+}
+
+static void deque_push(Deque *deque, Task *task) {
+  g_mutex_lock(&deque->lock);
+
+  if (deque->n_tasks == deque->capacity) {
+    guint capacity = MAX(deque->capacity * 2, 16), i;
+    Task **tasks = g_new(Task *, capacity);
+
+    for (i = 0; i < deque->n_tasks; i++)
+      tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+    g_free(deque->tasks);
+    deque->tasks = tasks;
+    deque->head = 0;
+    deque->capacity = capacity;
+  }
+
+  deque->tasks[(deque->head + deque->n_tasks++) % deque->capacity] = task;
+
+  g_mutex_unlock(&deque->lock);
+}
+
+/* Take the newest task if @newest, or otherwise the oldest */
+static Task *deque_pop(Deque *deque, gboolean newest) {
+  Task *task = NULL;
+
+  g_mutex_lock(&deque->lock);
+
+  if (deque->n_tasks > 0) {
+    if (newest) {
+      task = deque->tasks[(deque->head + deque->n_tasks - 1) % deque->capacity];
+    } else {
+      task = deque->tasks[deque->head];
+      deque->head = (deque->head + 1) % deque->capacity;
+    }
+    deque->n_tasks--;
+  }
+
+  g_mutex_unlock(&deque->lock);
+
+  return task;
+}
+
+/* Queue @task on @worker's deque, waking a worker up to steal it if any are
+ * waiting */
+static void push_task(Worker *worker, Task *task) {
+  Search *search = worker->search;
+
+  g_atomic_int_inc(&search->n_pending);
+  deque_push(&search->deques[worker->index], task);
+
+  if (g_atomic_int_get(&search->n_idle) > 0) {
+    g_mutex_lock(&search->idle_lock);
+    g_cond_signal(&search->idle_cond);
+    g_mutex_unlock(&search->idle_lock);
+  }
+}
+
+/* A task from @worker's own deque, or failing that, stolen from the others in
+ * turn, starting from the next one along */
+static Task *take_task(Worker *worker) {
+  Search *search = worker->search;
+  Task *task = deque_pop(&search->deques[worker->index], TRUE);
+  guint i;
+
+  for (i = 1; task == NULL && i < search->n_workers; i++)
+    task = deque_pop(&search->deques[(worker->index + i) % search->n_workers],
+                     FALSE);
+
+  return task;
+}
+
+/* Wait until there's a task to take, or none are left */
+static Task *wait_for_task(Worker *worker) {
+  Search *search = worker->search;
+  Task *task;
+
+  g_mutex_lock(&search->idle_lock);
+  g_atomic_int_inc(&search->n_idle);
+
+  /* Anything queued after the count went up signals, so isn't missed */
+  while ((task = take_task(worker)) == NULL &&
+         g_atomic_int_get(&search->n_pending) > 0)
+    g_cond_wait(&search->idle_cond, &search->idle_lock);
+
+  g_atomic_int_add(&search->n_idle, -1);
+  g_mutex_unlock(&search->idle_lock);
+
+  return task;
+}
+
+/* Mark a task as done, waking every worker up once it was the last */
+static void finish_task(Search *search) {
+  if (g_atomic_int_dec_and_test(&search->n_pending)) {
+    g_mutex_lock(&search->idle_lock);
+    g_cond_broadcast(&search->idle_cond);
+    g_mutex_unlock(&search->idle_lock);
+  }
+}
+
+/* Add @worker's decisions to the total, giving up once there are too many */
+static void add_nodes(Worker *worker) {
+  Search *search = worker->search;
+
+  g_mutex_lock(&search->lock);
+
+  search->n_nodes += worker->n_nodes;
+  worker->n_nodes = 0;
+  if (search->max_nodes != 0 && search->n_nodes >= search->max_nodes &&
+      search->n_solutions < search->limit) {
+    search->gave_up = TRUE;
+    g_atomic_int_set(&search->cancelled, TRUE);
+  }
+
+  g_mutex_unlock(&search->lock);
+}
+
+static guint get_neighbours(guint size, guint cell, guint *neighbours) {
+  guint n_neighbours = 0;
+
+  if (cell >= size)
+    neighbours[n_neighbours++] = cell - size;
+  if (cell + size < size * size)
+    neighbours[n_neighbours++] = cell + size;
+  if (cell % size > 0)
+    neighbours[n_neighbours++] = cell - 1;
+  if (cell % size < size - 1)
+    neighbours[n_neighbours++] = cell + 1;
+
+  return n_neighbours;
+}
+
+/* Whether the cells which aren't black are all joined together (rule 3) */
+static gboolean is_connected(Worker *worker, const guchar *states) {
+  const Search *search = worker->search;
+  guint n_stack = 0, n_reached = 0, n_open = 0, cell;
+
+  memset(worker->reached, 0, sizeof(gboolean) * search->n_cells);
+
+  for (cell = 0; cell < search->n_cells; cell++) {
+    if (states[cell] == STATE_BLACK)
+      continue;
+    if (n_open++ == 0) {
+      worker->reached[cell] = TRUE;
+      worker->stack[n_stack++] = cell;
+    }
+  }
+
+  while (n_stack > 0) {
+    guint neighbours[4], n_neighbours, i;
+
+    n_neighbours =
+        get_neighbours(search->size, worker->stack[--n_stack], neighbours);
+    n_reached++;
+
+    for (i = 0; i < n_neighbours; i++) {
+      if (!worker->reached[neighbours[i]] &&
+          states[neighbours[i]] != STATE_BLACK) {
+        worker->reached[neighbours[i]] = TRUE;
+        worker->stack[n_stack++] = neighbours[i];
+      }
+    }
+  }
+
+  return n_open > 0 && n_reached == n_open;
+}
+
+/* Follow up @decided: black cells' neighbours are white (rule 2), and white
+ * cells' numbers are black everywhere else in their row and column (rule 1).
+ * Returns FALSE if that breaks a rule, including cutting the board in two. */
+static gboolean propagate(Worker *worker, guchar *states, guint decided) {
+  const Search *search = worker->search;
+  guint size = search->size, n_queue = 0;
+  gboolean blackened = FALSE;
+
+  worker->queue[n_queue++] = decided;
+
+  while (n_queue > 0) {
+    guint cell = worker->queue[--n_queue], x = cell / size, y = cell % size;
+    guint i;
+
+    if (states[cell] == STATE_BLACK) {
+      guint neighbours[4], n_neighbours = get_neighbours(size, cell, neighbours);
+
+      blackened = TRUE;
+      for (i = 0; i < n_neighbours; i++) {
+        if (states[neighbours[i]] == STATE_BLACK)
+          return FALSE;
+        if (states[neighbours[i]] == STATE_OPEN) {
+          states[neighbours[i]] = STATE_WHITE;
+          worker->queue[n_queue++] = neighbours[i];
+        }
+      }
+      continue;
+    }
+
+    for (i = 0; i < size; i++) {
+      guint others[2] = {i * size + y, x * size + i}, j;
+
+      for (j = 0; j < 2; j++) {
+        guint other = others[j];
+
+        if (other == cell || search->nums[other] != search->nums[cell])
+          continue;
+        if (states[other] == STATE_WHITE)
+          return FALSE;
+        if (states[other] == STATE_OPEN) {
+          states[other] = STATE_BLACK;
+          worker->queue[n_queue++] = other;
+        }
+      }
+    }
+  }
+
+  return !blackened || is_connected(worker, states);
+}
+
+/* The next cell to decide: preferably one whose number is repeated among the
+ * cells in its row or column which could still be unpainted, as deciding
+ * that has consequences */
+static guint choose_cell(const Search *search, const guchar *states) {
+  guint size = search->size, cell, first_open = G_MAXUINT;
+
+  for (cell = 0; cell < search->n_cells; cell++) {
+    guint x = cell / size, y = cell % size, i;
+
+    if (states[cell] != STATE_OPEN)
+      continue;
+    if (first_open == G_MAXUINT)
+      first_open = cell;
+
+    for (i = 0; i < size; i++) {
+      guint row = i * size + y, column = x * size + i;
+
+      if ((row != cell && states[row] != STATE_BLACK &&
+           search->nums[row] == search->nums[cell]) ||
+          (column != cell && states[column] != STATE_BLACK &&
+           search->nums[column] == search->nums[cell]))
+        return cell;
+    }
+  }
+
+  return first_open;
+}
+
+static void add_solution(Search *search, const guchar *states) {
+  guint cell;
+
+  g_mutex_lock(&search->lock);
+
+  if (search->n_solutions == 0 && search->solution != NULL) {
+    for (cell = 0; cell < search->n_cells; cell++) {
+      KuroCell *c = &search->solution[cell / search->size][cell % search->size];
+
+      if (states[cell] == STATE_BLACK)
+        c->status |= CELL_SHOULD_BE_PAINTED;
+      else
+        c->status &= ~CELL_SHOULD_BE_PAINTED;
+    }
+  }
+  if (search->n_solutions < search->limit)
+    search->n_solutions++;
+  if (search->n_solutions >= search->limit)
+    g_atomic_int_set(&search->cancelled, TRUE);
+
+  g_mutex_unlock(&search->lock);
+}
+
+/* Search below @task, deciding cells black and leaving the white branches
+ * as new tasks */
+static void run_task(Worker *worker, Task *task) {
+  Search *search = worker->search;
+  guint decided = task->decided;
+
+  while (!g_atomic_int_get(&search->cancelled)) {
+    guint cell;
+
+    if (++worker->n_nodes >= search->node_batch)
+      add_nodes(worker);
+
+    if (decided != G_MAXUINT && !propagate(worker, task->states, decided))
+      return;
+
+    cell = choose_cell(search, task->states);
+    if (cell == G_MAXUINT) {
+      add_solution(search, task->states);
+      return;
+    }
+
+    task->states[cell] = STATE_WHITE;
+    push_task(worker, task_new(search, task->states, cell));
+
+    task->states[cell] = STATE_BLACK;
+    decided = cell;
+  }
+}
+
+static gpointer worker_thread(gpointer user_data) {
+  Worker *worker = user_data;
+  Search *search = worker->search;
+
+  for (;;) {
+    Task *task = take_task(worker);
+
+    if (task == NULL)
+      task = wait_for_task(worker);
+    if (task == NULL)
+      break;
+
+    run_task(worker, task);
+    g_free(task);
+    finish_task(search);
+  }
+
+  return NULL;
+}
+
+static gboolean search_solutions(const KuroBoard *board, guint64 limit,
+                                 guint64 max_nodes, guint n_threads,
+                                 guint64 *n_solutions, KuroCell **solution) {
+  Search search;
+  Worker *workers;
+  guchar *states;
+  guint i, x, y;
+  gint64 begin = KURO_PROFILER_CURRENT_TIME;
+
+  g_return_val_if_fail(limit > 0, FALSE);
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors();
+
+  search.size = board->size;
+  search.n_cells = board->size * board->size;
+  search.nums = g_new(guint16, search.n_cells);
+  for (x = 0; x < board->size; x++)
+    for (y = 0; y < board->size; y++)
+      search.nums[x * board->size + y] = board->cells[x][y].num;
+
+  search.n_workers = n_threads;
+  search.deques = g_new0(Deque, n_threads);
+  for (i = 0; i < n_threads; i++)
+    g_mutex_init(&search.deques[i].lock);
+  search.n_pending = 1;
+  search.cancelled = FALSE;
+  g_mutex_init(&search.idle_lock);
+  g_cond_init(&search.idle_cond);
+  search.n_idle = 0;
+  g_mutex_init(&search.lock);
+  search.n_solutions = 0;
+  search.limit = limit;
+  search.solution = solution;
+  search.n_nodes = 0;
+  search.max_nodes = max_nodes;
+  search.node_batch =
+      (max_nodes != 0) ? (guint)MIN(max_nodes, NODE_BATCH) : NODE_BATCH;
+  search.gave_up = FALSE;
+
+  /* Start with nothing decided, on the first worker */
+  states = g_new0(guchar, search.n_cells);
+  deque_push(&search.deques[0], task_new(&search, states, G_MAXUINT));
+  g_free(states);
+
+  workers = g_new0(Worker, n_threads);
+  for (i = 0; i < n_threads; i++) {
+    workers[i].search = &search;
+    workers[i].index = i;
+    workers[i].queue = g_new(guint, search.n_cells);
+    workers[i].stack = g_new(guint, search.n_cells);
+    workers[i].reached = g_new(gboolean, search.n_cells);
+    workers[i].thread =
+        g_thread_new("kuro-search", worker_thread, &workers[i]);
+  }
+
+  for (i = 0; i < n_threads; i++) {
+    g_thread_join(workers[i].thread);
+    g_free(workers[i].queue);
+    g_free(workers[i].stack);
+    g_free(workers[i].reached);
+  }
+  g_free(workers);
+
+  /* Tasks left behind after cancelling */
+  for (i = 0; i < n_threads; i++) {
+    Task *task;
+
+    while ((task = deque_pop(&search.deques[i], TRUE)) != NULL)
+      g_free(task);
+    g_free(search.deques[i].tasks);
+    g_mutex_clear(&search.deques[i].lock);
+  }
+  g_free(search.deques);
+  g_mutex_clear(&search.idle_lock);
+  g_cond_clear(&search.idle_cond);
+  g_mutex_clear(&search.lock);
+  g_free(search.nums);
+
+  KURO_PROFILER_ADD_MARK_PRINTF(begin, "Search solutions", "%u×%u, %u threads",
+                                board->size, board->size, n_threads);
+
+  if (search.gave_up && search.n_solutions < limit)
+    return FALSE;
+
+  *n_solutions = search.n_solutions;
+  return TRUE;
+}
+
+/* Count the solutions to @board by searching, stopping at @limit, across
+ * @n_threads threads, or one per processor if it's 0. The count's the same
+ * however many threads there are, but only counts up to @limit are cheap.
+ * Returns FALSE, leaving @n_solutions alone, if the threads made
+ * @max_nodes decisions between them first, unless that's 0. */
+gboolean kuro_search_count_solutions(const KuroBoard *board, guint64 limit,
+                                     guint64 max_nodes, guint n_threads,
+                                     guint64 *n_solutions) {
+  return search_solutions(board, limit, max_nodes, n_threads, n_solutions,
+                          NULL);
+}
+
+/* As kuro_search_count_solutions(), also marking the first solution found in
+ * @board with CELL_SHOULD_BE_PAINTED. Painted cells are ignored, so this
+ * solves the puzzle from its numbers alone. */
+gboolean kuro_search_solve(KuroBoard *board, guint64 limit, guint64 max_nodes,
+                           guint n_threads, guint64 *n_solutions) {
+  return search_solutions(board, limit, max_nodes, n_threads, n_solutions,
+                          board->cells);
+}
@@ -0,0 +1,37 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_SEARCH_H
+#define KURO_SEARCH_H
+
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+gboolean kuro_search_count_solutions(const KuroBoard *board, guint64 limit,
+                                     guint64 max_nodes, guint n_threads,
+                                     guint64 *n_solutions);
+gboolean kuro_search_solve(KuroBoard *board, guint64 limit, guint64 max_nodes,
+                           guint n_threads, guint64 *n_solutions);
+
+G_END_DECLS
+
+#endif /* KURO_SEARCH_H */
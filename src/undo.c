@@ -0,0 +1,191 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <glib.h>
+
+#include "undo.h"
+
+#define UNDO_BLOCK_SIZE 64
+
+struct _KuroUndoBlock {
+  KuroUndoBlock *next;
+  KuroUndo items[UNDO_BLOCK_SIZE];
+};
+
+/* Put @undo and everything which could be redone after it on the spare list */
+static void release_items(KuroUndoStack *stack, KuroUndo *undo) {
+  KuroUndo *last = undo;
+
+  while (last->redo != NULL)
+    last = last->redo;
+
+  last->redo = stack->spare;
+  stack->spare = undo;
+}
+
+static KuroUndo *take_item(KuroUndoStack *stack) {
+  KuroUndo *undo;
+
+  if (stack->spare == NULL) {
+    KuroUndoBlock *block = g_new(KuroUndoBlock, 1);
+    guint i;
+
+    for (i = 0; i < UNDO_BLOCK_SIZE; i++)
+      block->items[i].redo = (i + 1 < UNDO_BLOCK_SIZE) ? &block->items[i + 1]
+                                                       : NULL;
+    block->next = stack->blocks;
+    stack->blocks = block;
+    stack->spare = &block->items[0];
+  }
+
+  undo = stack->spare;
+  stack->spare = undo->redo;
+
+  return undo;
+}
+
+/* Returns a new, empty stack, with room for a block of moves */
+KuroUndoStack *kuro_undo_stack_new(void) {
+  KuroUndoStack *stack = g_new0(KuroUndoStack, 1);
+
+  stack->current = take_item(stack);
+  stack->current->type = UNDO_NEW_GAME;
+  stack->current->chained = FALSE;
+  stack->current->undo = NULL;
+  stack->current->redo = NULL;
+
+  return stack;
+}
+
+void kuro_undo_stack_free(KuroUndoStack *stack) {
+  KuroUndoBlock *block, *next;
+
+  if (stack == NULL)
+    return;
+
+  for (block = stack->blocks; block != NULL; block = next) {
+    next = block->next;
+    g_free(block);
+  }
+  g_free(stack);
+}
+
+/* Add a move after the current position, dropping anything which could have
+ * been redone. The new move becomes the current position. */
+void kuro_undo_push(KuroUndoStack *stack, KuroUndoType type, KuroVector cell) {
+  KuroUndo *undo;
+
+  /* Recycle the redo stack after this point. */
+  if (stack->current->redo != NULL)
+    release_items(stack, stack->current->redo);
+
+  undo = take_item(stack);
+  undo->type = type;
+  undo->cell = cell;
+  undo->chained = stack->grouping && stack->n_grouped++ > 0;
+  undo->undo = stack->current;
+  undo->redo = NULL;
+
+  stack->current->redo = undo;
+  stack->current = undo;
+}
+
+/* Drop every move, leaving only the new game item */
+void kuro_undo_clear(KuroUndoStack *stack) {
+  while (stack->current->type != UNDO_NEW_GAME)
+    stack->current = stack->current->undo;
+
+  if (stack->current->redo != NULL)
+    release_items(stack, stack->current->redo);
+  stack->current->redo = NULL;
+  stack->grouping = FALSE;
+}
+
+/* Moves pushed between these are undone and redone as one step */
+void kuro_undo_begin_group(KuroUndoStack *stack) {
+  stack->grouping = TRUE;
+  stack->n_grouped = 0;
+}
+
+/* Like kuro_undo_begin_group(), but the group carries on from the current
+ * move, so it's undone and redone along with it */
+void kuro_undo_continue_group(KuroUndoStack *stack) {
+  stack->grouping = TRUE;
+  stack->n_grouped = 1;
+}
+
+void kuro_undo_end_group(KuroUndoStack *stack) {
+  stack->grouping = FALSE;
+}
+
+/* Every move toggles the same state, so this both undoes and redoes @undo */
+void kuro_undo_apply(const KuroUndo *undo, KuroBoard *board) {
+  switch (undo->type) {
+  case UNDO_PAINT:
+    kuro_board_toggle(board, undo->cell, CELL_PAINTED);
+    break;
+  case UNDO_TAG1:
+    kuro_board_toggle(board, undo->cell, CELL_TAG1);
+    break;
+  case UNDO_TAG2:
+    kuro_board_toggle(board, undo->cell, CELL_TAG2);
+    break;
+  case UNDO_TAGS:
+    kuro_board_toggle(board, undo->cell, CELL_TAG1 | CELL_TAG2);
+    break;
+  case UNDO_NEW_GAME:
+  default:
+    /* This is just here to stop the compiler warning */
+    g_assert_not_reached();
+    break;
+  }
+}
+
+/* Undo the last move, or group of moves. Returns the earliest move undone, or
+ * NULL if there was nothing to undo. */
+const KuroUndo *kuro_undo_step_back(KuroUndoStack *stack, KuroBoard *board) {
+  KuroUndo *undo;
+
+  if (stack->current->type == UNDO_NEW_GAME)
+    return NULL;
+
+  do {
+    undo = stack->current;
+    kuro_undo_apply(undo, board);
+    stack->current = undo->undo;
+  } while (undo->chained);
+
+  return undo;
+}
+
+/* Redo the next move, or group of moves. Returns the latest move redone, or
+ * NULL if there was nothing to redo. */
+const KuroUndo *kuro_undo_step_forward(KuroUndoStack *stack,
+                                       KuroBoard *board) {
+  if (stack->current->redo == NULL)
+    return NULL;
+
+  do {
+    stack->current = stack->current->redo;
+    kuro_undo_apply(stack->current, board);
+  } while (stack->current->redo != NULL && stack->current->redo->chained);
+
+  return stack->current;
+}
@@ -0,0 +1,76 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef KURO_UNDO_H
+#define KURO_UNDO_H
+
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  UNDO_NEW_GAME,
+  UNDO_PAINT,
+  UNDO_TAG1,
+  UNDO_TAG2,
+  UNDO_TAGS /* = UNDO_TAG1 and UNDO_TAG2 */
+} KuroUndoType;
+
+/* The undo stack is a list of moves, with an UNDO_NEW_GAME item at the
+ * bottom. */
+typedef struct _KuroUndo KuroUndo;
+struct _KuroUndo {
+  KuroUndoType type;
+  KuroVector cell;
+  gboolean chained; /* undone and redone along with the move before it */
+  KuroUndo *undo;
+  KuroUndo *redo;
+};
+
+typedef struct _KuroUndoBlock KuroUndoBlock;
+
+/* Items are allocated in blocks and recycled through the spare list, so
+ * making moves doesn't allocate once the stack has reached its usual depth */
+typedef struct {
+  KuroUndo *current; /* the last move made, or the new game item */
+  KuroUndo *spare;   /* unused items, linked through ->redo */
+  KuroUndoBlock *blocks;
+  gboolean grouping; /* chain moves pushed after the first one */
+  guint n_grouped;
+} KuroUndoStack;
+
+KuroUndoStack *kuro_undo_stack_new(void) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_MALLOC;
+void kuro_undo_stack_free(KuroUndoStack *stack);
+void kuro_undo_push(KuroUndoStack *stack, KuroUndoType type, KuroVector cell);
+void kuro_undo_clear(KuroUndoStack *stack);
+void kuro_undo_begin_group(KuroUndoStack *stack);
+void kuro_undo_continue_group(KuroUndoStack *stack);
+void kuro_undo_end_group(KuroUndoStack *stack);
+void kuro_undo_apply(const KuroUndo *undo, KuroBoard *board);
+const KuroUndo *kuro_undo_step_back(KuroUndoStack *stack, KuroBoard *board);
+const KuroUndo *kuro_undo_step_forward(KuroUndoStack *stack,
+                                       KuroBoard *board);
+
+G_END_DECLS
+
+#endif /* KURO_UNDO_H */
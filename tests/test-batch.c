@@ -0,0 +1,200 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "board.h"
+#include "count.h"
+#include "test-util.h"
+
+static const struct {
+  guint size;
+  guint n_boards;
+} batch_boards[] = {{5, 20}, {8, 5}, {12, 2}};
+
+/* Write the boards out the way they'd be typed in: a digit per cell on small
+ * boards and spaces between the numbers on bigger ones, with a comment or
+ * two thrown in */
+static gchar *write_puzzles(guint64 *n_solutions) {
+  GString *text = g_string_new("# Generated puzzles\n\n");
+  guint i, j, n = 0;
+  KuroVector iter;
+
+  for (i = 0; i < G_N_ELEMENTS(batch_boards); i++) {
+    for (j = 0; j < batch_boards[i].n_boards; j++) {
+      KuroBoard *board = kuro_test_new_board(batch_boards[i].size, j);
+
+      g_assert_true(kuro_count_solutions_sat(board, 2, 0, &n_solutions[n++]));
+
+      for (iter.y = 0; iter.y < board->size; iter.y++) {
+        for (iter.x = 0; iter.x < board->size; iter.x++) {
+          if (board->size < 10)
+            g_string_append_printf(text, "%u",
+                                   board->cells[iter.x][iter.y].num);
+          else
+            g_string_append_printf(text, " %u",
+                                   board->cells[iter.x][iter.y].num);
+        }
+        g_string_append(text, "\n");
+      }
+      g_string_append(text, (j % 2 == 0) ? "\n" : "\n# Next\n\n");
+
+      kuro_board_free(board);
+    }
+  }
+
+  return g_string_free(text, FALSE);
+}
+
+static gboolean run_batch(const gchar *input_text,
+                          const KuroBatchOptions *options, gchar **output_text,
+                          KuroBatchStats *stats, GError **error) {
+  GInputStream *input =
+      g_memory_input_stream_new_from_data(input_text, -1, NULL);
+  GOutputStream *output = g_memory_output_stream_new_resizable();
+  KuroFormatReader reader;
+  gboolean success;
+
+  /* Small chunks, so that puzzles are split between them */
+  kuro_format_reader_init_stream(&reader, input, 100);
+  success = kuro_batch_run(&reader, output, options, stats, error);
+  g_output_stream_write_all(output, "", 1, NULL, NULL, NULL);
+  *output_text = g_strdup(
+      g_memory_output_stream_get_data(G_MEMORY_OUTPUT_STREAM(output)));
+
+  kuro_format_reader_clear(&reader);
+  g_object_unref(output);
+  g_object_unref(input);
+
+  return success;
+}
+
+/* Every puzzle gets a line, in order, with as many solutions as the SAT
+ * solver finds, and a rating when there's just the one. Apart from the
+ * timings, the output is the same however many threads there are, and when
+ * the SAT solver gives up straight away and the puzzles are searched. */
+static void test_csv(void) {
+  static const KuroBatchOptions options[] = {
+      {KURO_BATCH_CSV, 1, 0}, {KURO_BATCH_CSV, 4, 0}, {KURO_BATCH_CSV, 4, 1}};
+  guint64 n_solutions[32], n_unique = 0;
+  gchar *input_text = write_puzzles(n_solutions), *first = NULL;
+  guint i, j, n_puzzles = 0;
+
+  for (i = 0; i < G_N_ELEMENTS(batch_boards); i++)
+    n_puzzles += batch_boards[i].n_boards;
+  for (i = 0; i < n_puzzles; i++)
+    n_unique += (n_solutions[i] == 1);
+  g_assert_cmpuint(n_unique, >, 0);
+
+  for (i = 0; i < G_N_ELEMENTS(options); i++) {
+    KuroBatchStats stats;
+    GString *untimed = g_string_new(NULL);
+    gchar *output_text, **lines;
+
+    g_assert_true(
+        run_batch(input_text, &options[i], &output_text, &stats, NULL));
+    g_assert_cmpuint(stats.n_puzzles, ==, n_puzzles);
+    g_assert_cmpuint(stats.n_unique, ==, n_unique);
+    g_assert_cmpuint(stats.n_unsolvable, ==, 0);
+
+    lines = g_strsplit(output_text, "\n", -1);
+    g_assert_cmpuint(g_strv_length(lines), ==, n_puzzles + 2);
+    g_assert_true(g_str_has_prefix(lines[0], "puzzle,"));
+
+    for (j = 0; j < n_puzzles; j++) {
+      gchar **fields = g_strsplit(lines[j + 1], ",", -1);
+
+      g_assert_cmpuint(g_strv_length(fields), ==, 7);
+      g_assert_cmpuint(g_ascii_strtoull(fields[0], NULL, 10), ==, j + 1);
+      g_assert_cmpuint(g_ascii_strtoull(fields[3], NULL, 10), ==,
+                       n_solutions[j]);
+      g_assert_cmpint(fields[4][0] != '\0', ==, n_solutions[j] == 1);
+
+      /* Everything but the time */
+      g_string_append_len(untimed, lines[j + 1],
+                          strrchr(lines[j + 1], ',') - lines[j + 1]);
+      g_string_append_c(untimed, '\n');
+      g_strfreev(fields);
+    }
+
+    if (first == NULL)
+      first = g_strdup(untimed->str);
+    else
+      g_assert_cmpstr(untimed->str, ==, first);
+
+    g_string_free(untimed, TRUE);
+    g_strfreev(lines);
+    g_free(output_text);
+  }
+
+  g_free(first);
+  g_free(input_text);
+}
+
+static void test_json(void) {
+  guint64 n_solutions[32];
+  gchar *input_text = write_puzzles(n_solutions), *output_text;
+  KuroBatchOptions options = {KURO_BATCH_JSON, 2, 0};
+  KuroBatchStats stats;
+
+  g_assert_true(run_batch(input_text, &options, &output_text, &stats, NULL));
+  g_assert_true(g_str_has_prefix(output_text, "{\"puzzle\":1,\"line\":3,"));
+  g_assert_nonnull(strstr(output_text, "\"rating\":\""));
+
+  g_free(output_text);
+  g_free(input_text);
+}
+
+/* A puzzle which can't be read stops the batch, saying where it is */
+static void test_invalid(void) {
+  static const gchar *inputs[] = {
+      "123\n231\n",          /* not square */
+      "12\n21\n\n123\n12\n", /* short row */
+      "12\n29\n",            /* number too big */
+      "1a\n21\n",            /* not a number */
+  };
+  KuroBatchOptions options = {KURO_BATCH_CSV, 1, 0};
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(inputs); i++) {
+    KuroBatchStats stats;
+    GError *error = NULL;
+    gchar *output_text;
+
+    g_assert_false(
+        run_batch(inputs[i], &options, &output_text, &stats, &error));
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+
+    g_clear_error(&error);
+    g_free(output_text);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_func("/batch/csv", test_csv);
+  g_test_add_func("/batch/json", test_json);
+  g_test_add_func("/batch/invalid", test_invalid);
+
+  return g_test_run();
+}
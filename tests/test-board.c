@@ -0,0 +1,88 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "generator.h"
+#include "undo.h"
+#include "test-util.h"
+
+
+/* The hash kept up to date move by move matches one worked out from
+ * scratch, and comes back to where it started once the moves are undone */
+static void test_incremental_hash(void) {
+  KuroBoard *board = kuro_test_new_board(8, 0);
+  KuroUndoStack *stack = kuro_undo_stack_new();
+  guint64 start = kuro_board_hash(board), hash;
+  guint i;
+
+  for (i = 0; i < 100; i++) {
+    static const KuroUndoType types[] = {UNDO_PAINT, UNDO_TAG1, UNDO_TAG2,
+                                         UNDO_TAGS};
+    KuroVector cell;
+
+    cell.x = (guint16)((i * 7) % board->size);
+    cell.y = (guint16)((i * 3) % board->size);
+    kuro_undo_push(stack, types[i % G_N_ELEMENTS(types)], cell);
+    kuro_undo_apply(stack->current, board);
+  }
+
+  hash = kuro_board_hash(board);
+  g_assert_cmpuint(hash, !=, start);
+
+  kuro_board_rehash(board);
+  g_assert_cmpuint(kuro_board_hash(board), ==, hash);
+
+  while (kuro_undo_step_back(stack, board) != NULL)
+    ;
+  g_assert_cmpuint(kuro_board_hash(board), ==, start);
+
+  while (kuro_undo_step_forward(stack, board) != NULL)
+    ;
+  g_assert_cmpuint(kuro_board_hash(board), ==, hash);
+
+  kuro_undo_stack_free(stack);
+  kuro_board_free(board);
+}
+
+/* Different puzzles hash differently, even before any moves, and copies
+ * hash the same */
+static void test_numbers_hash(void) {
+  KuroBoard *a = kuro_test_new_board(8, 0);
+  KuroBoard *b = kuro_generator_new_board(8, a->seed + 1, FALSE);
+  KuroBoard *copy = kuro_board_copy(a);
+
+  g_assert_cmpuint(a->marks_hash, ==, 0);
+  g_assert_cmpuint(a->numbers_hash, !=, b->numbers_hash);
+  g_assert_cmpuint(kuro_board_hash(copy), ==, kuro_board_hash(a));
+
+  kuro_board_free(copy);
+  kuro_board_free(b);
+  kuro_board_free(a);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_func("/board/incremental-hash", test_incremental_hash);
+  g_test_add_func("/board/numbers-hash", test_numbers_hash);
+
+  return g_test_run();
+}
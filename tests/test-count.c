@@ -0,0 +1,172 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "count.h"
+#include "generator.h"
+#include "rules.h"
+#include "test-util.h"
+
+#define N_BOARDS 20
+
+/* Count solutions the slow way: try painting every cell or not, stopping as
+ * soon as rule 1 or 2 is broken, and check rule 3 at the end */
+static guint64 count_by_search(KuroBoard *board, guint cell) {
+  guint size = board->size, x = cell / size, y = cell % size, i;
+  guint64 count = 0;
+
+  if (cell == size * size)
+    return kuro_check_board(board) ? 1 : 0;
+
+  /* Leave it unpainted, unless that repeats a number above or to the left */
+  for (i = 0; i < size; i++) {
+    if ((i < y && board->cells[x][i].num == board->cells[x][y].num &&
+         !(board->cells[x][i].status & CELL_PAINTED)) ||
+        (i < x && board->cells[i][y].num == board->cells[x][y].num &&
+         !(board->cells[i][y].status & CELL_PAINTED)))
+      break;
+  }
+  if (i == size)
+    count += count_by_search(board, cell + 1);
+
+  /* Paint it, unless that's next to a painted cell above or to the left */
+  if ((x == 0 || !(board->cells[x - 1][y].status & CELL_PAINTED)) &&
+      (y == 0 || !(board->cells[x][y - 1].status & CELL_PAINTED))) {
+    board->cells[x][y].status |= CELL_PAINTED;
+    count += count_by_search(board, cell + 1);
+    board->cells[x][y].status &= ~CELL_PAINTED;
+  }
+
+  return count;
+}
+
+/* Counting a row at a time agrees with searching */
+static void test_search(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_solutions;
+
+    g_assert_true(kuro_count_solutions(board, G_MAXUINT64, &n_solutions));
+    g_assert_cmpuint(n_solutions, >=, 1);
+    g_assert_cmpuint(n_solutions, ==, count_by_search(board, 0));
+
+    kuro_board_free(board);
+  }
+}
+
+/* Every generated board has a solution, and counting stops at the limit */
+static void test_generated(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_solutions, n_limited;
+
+    g_assert_true(kuro_count_solutions(board, G_MAXUINT64, &n_solutions));
+    g_assert_cmpuint(n_solutions, >=, 1);
+    g_assert_true(kuro_count_solutions(board, 2, &n_limited));
+    g_assert_cmpuint(n_limited, ==, MIN(n_solutions, 2));
+
+    kuro_board_free(board);
+  }
+}
+
+static void test_unsolvable(void) {
+  KuroBoard *board = kuro_test_new_unsolvable_board();
+  guint64 n_solutions = 1;
+
+  g_assert_true(kuro_count_solutions(board, G_MAXUINT64, &n_solutions));
+  g_assert_cmpuint(n_solutions, ==, 0);
+  g_assert_true(kuro_count_solutions_sat(board, 2, 0, &n_solutions));
+  g_assert_cmpuint(n_solutions, ==, 0);
+  g_assert_cmpint(kuro_generator_check_uniqueness(board), ==,
+                  KURO_UNIQUENESS_NONE);
+
+  kuro_board_free(board);
+}
+
+/* The SAT solver agrees with counting a row at a time */
+static void test_sat(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_counted, n_solved;
+
+    g_assert_true(kuro_count_solutions(board, 100, &n_counted));
+    g_assert_true(kuro_count_solutions_sat(board, 100, 0, &n_solved));
+    g_assert_cmpuint(n_solved, ==, n_counted);
+
+    kuro_board_free(board);
+  }
+}
+
+/* Boards too wide to count a row at a time can still be checked */
+static void test_sat_large(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i;
+
+  for (i = 0; i < 3; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_solutions;
+
+    g_assert_true(kuro_count_solutions_sat(board, 2, 0, &n_solutions));
+    g_assert_cmpuint(n_solutions, >=, 1);
+    g_assert_cmpint(kuro_generator_check_uniqueness(board), ==,
+                    n_solutions == 1 ? KURO_UNIQUENESS_UNIQUE
+                                     : KURO_UNIQUENESS_MULTIPLE);
+
+    kuro_board_free(board);
+  }
+}
+
+static void test_too_wide(void) {
+  KuroBoard *board = kuro_test_new_board(KURO_COUNT_MAX_WIDTH + 1, 0);
+  guint64 n_solutions = 42;
+
+  g_assert_false(kuro_count_solutions(board, G_MAXUINT64, &n_solutions));
+  g_assert_cmpuint(n_solutions, ==, 42);
+
+  kuro_board_free(board);
+}
+
+int main(int argc, char *argv[]) {
+  static const guint search_sizes[] = {4, 5, 6};
+  static const guint generated_sizes[] = {8, 10};
+  static const guint sat_sizes[] = {5, 8, 10};
+  static const guint sat_large_sizes[] = {20, 30};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/count/search", search_sizes, G_N_ELEMENTS(search_sizes),
+                      test_search);
+  kuro_test_add_sizes("/count/generated", generated_sizes,
+                      G_N_ELEMENTS(generated_sizes), test_generated);
+  kuro_test_add_sizes("/count/sat", sat_sizes, G_N_ELEMENTS(sat_sizes),
+                      test_sat);
+  kuro_test_add_sizes("/count/sat", sat_large_sizes,
+                      G_N_ELEMENTS(sat_large_sizes), test_sat_large);
+  g_test_add_func("/count/unsolvable", test_unsolvable);
+  g_test_add_func("/count/too-wide", test_too_wide);
+
+  return g_test_run();
+}
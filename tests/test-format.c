@@ -0,0 +1,250 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <string.h>
+
+#include "board.h"
+#include "format.h"
+#include "rules.h"
+#include "test-util.h"
+
+#define N_BOARDS 10
+
+/* Chunk sizes to read inputs in, with 0 for all at once */
+static const gsize chunk_sizes[] = {0, 1, 4};
+
+/* Read @input out of memory if @chunk_size is 0, or else out of a stream
+ * @chunk_size bytes at a time. Returns the stream, if there is one. */
+static GInputStream *init_reader(KuroFormatReader *reader, const gchar *input,
+                                 gsize chunk_size) {
+  GInputStream *stream;
+
+  if (chunk_size == 0) {
+    kuro_format_reader_init(reader, input, strlen(input));
+    return NULL;
+  }
+
+  stream = g_memory_input_stream_new_from_data(input, -1, NULL);
+  kuro_format_reader_init_stream(reader, stream, chunk_size);
+  return stream;
+}
+
+static void clear_reader(KuroFormatReader *reader, GInputStream *stream) {
+  kuro_format_reader_clear(reader);
+  if (stream != NULL)
+    g_object_unref(stream);
+}
+
+static void assert_same_numbers(const KuroBoard *a, const KuroBoard *b) {
+  g_assert_cmpuint(a->size, ==, b->size);
+  g_assert_cmpuint(a->numbers_hash, ==, b->numbers_hash);
+}
+
+/* Boards come back as they went out in every format, and the Kuro format
+ * keeps the solution */
+static void test_round_trip(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i, format;
+
+  for (format = KURO_FORMAT_PLAIN; format <= KURO_FORMAT_KURO; format++) {
+    KuroBoard *boards[N_BOARDS];
+    GString *text = g_string_new("# A comment\n\n");
+    KuroFormatReader reader;
+    KuroBoard *board;
+
+    for (i = 0; i < N_BOARDS; i++) {
+      boards[i] = kuro_test_new_board(size, i);
+      g_assert_true(kuro_format_write(text, boards[i], format));
+    }
+
+    kuro_format_reader_init(&reader, text->str, text->len);
+    for (i = 0; i < N_BOARDS; i++) {
+      KuroVector iter;
+
+      g_assert_true(kuro_format_read(&reader, &board, NULL));
+      g_assert_nonnull(board);
+      g_assert_cmpint(reader.format, ==, format);
+      assert_same_numbers(board, boards[i]);
+
+      for (iter.x = 0; iter.x < size; iter.x++) {
+        for (iter.y = 0; iter.y < size; iter.y++) {
+          guchar expected = (format == KURO_FORMAT_KURO)
+                                ? boards[i]->cells[iter.x][iter.y].status &
+                                      CELL_SHOULD_BE_PAINTED
+                                : 0;
+
+          g_assert_cmpuint(board->cells[iter.x][iter.y].status, ==, expected);
+        }
+      }
+
+      kuro_board_free(board);
+      kuro_board_free(boards[i]);
+    }
+
+    g_assert_true(kuro_format_read(&reader, &board, NULL));
+    g_assert_null(board);
+    g_string_free(text, TRUE);
+  }
+}
+
+/* The same puzzle in each format, without a trailing newline, and with
+ * Windows line endings, however it's split into chunks */
+static void test_formats(void) {
+  static const gchar *inputs[] = {
+      "123\n231\n312",
+      "1, 2, 3\r\n2, 3, 1\r\n3, 1, 2\r\n",
+      "3x3:123231312",
+      "3x3de:123231312\n",
+      "kuro 3\n1 2# 3\n2 3 1#\n3# 1 2\n",
+  };
+  KuroBoard *expected = NULL;
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS(inputs) * G_N_ELEMENTS(chunk_sizes); i++) {
+    KuroFormatReader reader;
+    KuroBoard *board;
+    GInputStream *stream;
+
+    j = i / G_N_ELEMENTS(chunk_sizes);
+    stream = init_reader(&reader, inputs[j],
+                         chunk_sizes[i % G_N_ELEMENTS(chunk_sizes)]);
+    g_assert_true(kuro_format_read(&reader, &board, NULL));
+    g_assert_nonnull(board);
+    g_assert_cmpuint(reader.puzzle_line, ==, 1);
+    g_assert_cmpuint(board->cells[1][0].num, ==, 2);
+    g_assert_cmpuint(board->cells[0][1].num, ==, 2);
+
+    if (expected == NULL)
+      expected = board;
+    else
+      assert_same_numbers(board, expected);
+
+    if (j == G_N_ELEMENTS(inputs) - 1) {
+      g_assert_true(board->cells[1][0].status & CELL_SHOULD_BE_PAINTED);
+      g_assert_false(board->cells[0][0].status & CELL_SHOULD_BE_PAINTED);
+    }
+
+    if (board != expected)
+      kuro_board_free(board);
+    g_assert_true(kuro_format_read(&reader, &board, NULL));
+    g_assert_null(board);
+    clear_reader(&reader, stream);
+  }
+
+  kuro_board_free(expected);
+}
+
+/* Puzzles which can't be read are pointed out by line, even once the lines
+ * before them have been let go of */
+static void test_invalid(void) {
+  static const struct {
+    const gchar *input;
+    guint line;
+  } inputs[] = {
+      {"123\n231\n", 3},      {"12\n21\n\n# Next\n123\n12\n", 6},
+      {"12\n29\n", 2},        {"1a\n21\n", 1},
+      {"3x2:123231\n", 1},    {"3x3:12323131\n", 1},
+      {"kuro\n1 2\n2 1\n", 1}, {"kuro 2\n1# 2\n2 1 1\n", 3},
+  };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS(inputs) * G_N_ELEMENTS(chunk_sizes); i++) {
+    KuroFormatReader reader;
+    KuroBoard *board;
+    GInputStream *stream;
+    GError *error = NULL;
+    gchar *prefix;
+
+    j = i / G_N_ELEMENTS(chunk_sizes);
+    stream = init_reader(&reader, inputs[j].input,
+                         chunk_sizes[i % G_N_ELEMENTS(chunk_sizes)]);
+    while (kuro_format_read(&reader, &board, &error) && board != NULL)
+      kuro_board_free(board);
+
+    g_assert_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+    prefix = g_strdup_printf("Line %u:", inputs[j].line);
+    g_assert_true(g_str_has_prefix(error->message, prefix));
+
+    g_free(prefix);
+    g_clear_error(&error);
+    clear_reader(&reader, stream);
+  }
+}
+
+/* Converting to the Kuro format solves puzzles which didn't come with their
+ * solution */
+static void test_convert(void) {
+  GString *text = g_string_new(NULL);
+  GOutputStream *output = g_memory_output_stream_new_resizable();
+  KuroBoard *boards[N_BOARDS], *board;
+  KuroFormatReader reader;
+  guint64 n_puzzles;
+  gsize length;
+  guint i;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    boards[i] = kuro_test_new_board(5, i);
+    g_assert_true(kuro_format_write(text, boards[i], KURO_FORMAT_SINGLES));
+  }
+
+  kuro_format_reader_init(&reader, text->str, text->len);
+  g_assert_true(kuro_format_convert(&reader, output, KURO_FORMAT_KURO,
+                                    &n_puzzles, NULL));
+  g_assert_cmpuint(n_puzzles, ==, N_BOARDS);
+
+  length = g_memory_output_stream_get_data_size(G_MEMORY_OUTPUT_STREAM(output));
+  kuro_format_reader_init(
+      &reader, g_memory_output_stream_get_data(G_MEMORY_OUTPUT_STREAM(output)),
+      length);
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroVector iter;
+
+    g_assert_true(kuro_format_read(&reader, &board, NULL));
+    g_assert_cmpint(reader.format, ==, KURO_FORMAT_KURO);
+    assert_same_numbers(board, boards[i]);
+
+    /* Painting the marked cells solves it */
+    for (iter.x = 0; iter.x < board->size; iter.x++)
+      for (iter.y = 0; iter.y < board->size; iter.y++)
+        if (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED)
+          board->cells[iter.x][iter.y].status |= CELL_PAINTED;
+    g_assert_true(kuro_check_board(board));
+
+    kuro_board_free(board);
+    kuro_board_free(boards[i]);
+  }
+
+  g_object_unref(output);
+  g_string_free(text, TRUE);
+}
+
+int main(int argc, char *argv[]) {
+  static const guint sizes[] = {5, 8, 10, 20};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/format/round-trip", sizes, G_N_ELEMENTS(sizes),
+                      test_round_trip);
+  g_test_add_func("/format/formats", test_formats);
+  g_test_add_func("/format/invalid", test_invalid);
+  g_test_add_func("/format/convert", test_convert);
+
+  return g_test_run();
+}
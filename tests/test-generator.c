@@ -0,0 +1,61 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "generator.h"
+#include "test-util.h"
+
+#define N_BOARDS 50
+
+/* Sharing attempts out between threads gives the same board as making them
+ * one after another, whichever thread gets there first */
+static void test_speculative(gconstpointer data) {
+  static const guint n_threads[] = {1, 2, 4};
+  guint size = GPOINTER_TO_UINT(data), i, j;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    guint seed = kuro_generator_derive_seed(KURO_TEST_SEED, i);
+    KuroBoard *board = kuro_generator_new_board(size, seed, FALSE);
+
+    for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+      KuroBoard *speculative =
+          kuro_generator_new_board_speculative(size, seed, n_threads[j], FALSE);
+
+      g_assert_cmpuint(speculative->seed, ==, board->seed);
+      g_assert_cmpuint(speculative->numbers_hash, ==, board->numbers_hash);
+
+      kuro_board_free(speculative);
+    }
+
+    kuro_board_free(board);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  static const guint sizes[] = {5, 8, 10, 20};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/generator/speculative", sizes, G_N_ELEMENTS(sizes),
+                      test_speculative);
+
+  return g_test_run();
+}
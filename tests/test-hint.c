@@ -0,0 +1,241 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "count.h"
+#include "hint-worker.h"
+#include "hint.h"
+#include "rules.h"
+#include "test-util.h"
+
+#define N_BOARDS 20
+
+/* Solve boards by painting nothing but hinted cells. Every hint must be part
+ * of the solution, as anything deduced from correctly painted cells is. */
+static void test_solve_with_hints(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint n_hints = 0;
+    KuroHint hint;
+
+    while (!kuro_check_board(board)) {
+      KuroCell *cell;
+
+      g_assert_true(kuro_hint_find(board, &hint));
+      cell = &board->cells[hint.cell.x][hint.cell.y];
+
+      g_assert_cmpint(hint.technique, !=, KURO_HINT_MISTAKE);
+      g_assert_true(cell->status & CELL_SHOULD_BE_PAINTED);
+      g_assert_false(cell->status & CELL_PAINTED);
+
+      cell->status |= CELL_PAINTED;
+      g_assert_cmpuint(++n_hints, <=, size * size);
+    }
+
+    kuro_board_free(board);
+  }
+}
+
+/* A painted cell which breaks the rules is pointed out */
+static void test_mistake(void) {
+  KuroBoard *board = kuro_test_new_board(8, 0);
+  KuroVector iter;
+  KuroHint hint;
+
+  /* Paint next to a cell which should be painted, breaking rule 2 */
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y + 1 < board->size; iter.y++) {
+      if (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED) {
+        board->cells[iter.x][iter.y].status |= CELL_PAINTED;
+        board->cells[iter.x][iter.y + 1].status |= CELL_PAINTED;
+
+        g_assert_true(kuro_hint_find(board, &hint));
+        g_assert_cmpint(hint.technique, ==, KURO_HINT_MISTAKE);
+        g_assert_cmpuint(hint.cell.x, ==, iter.x);
+        g_assert_cmpuint(hint.cell.y, ==, iter.y + 1);
+
+        kuro_board_free(board);
+        return;
+      }
+    }
+  }
+
+  g_assert_not_reached();
+}
+
+/* Solve @board again, with @cell painted as well as whatever already is.
+ * Returns NULL if that can't be solved. */
+static KuroBoard *solve_with(const KuroBoard *board, guint x, guint y) {
+  KuroBoard *solved = kuro_board_copy(board);
+  guint64 n_solutions;
+
+  solved->cells[x][y].status |= CELL_PAINTED;
+  if (kuro_count_solve(solved, 1, 0, &n_solutions) && n_solutions > 0)
+    return solved;
+
+  kuro_board_free(solved);
+  return NULL;
+}
+
+/* Boards usually have more than one solution. Following another one than
+ * the board came with is never called a mistake. */
+static void test_other_solution(void) {
+  guint i, n_tried = 0;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(8, i), *other = NULL;
+    KuroVector iter;
+    KuroHint hint;
+
+    for (iter.x = 0; iter.x < 8 && other == NULL; iter.x++)
+      for (iter.y = 0; iter.y < 8 && other == NULL; iter.y++)
+        if (!(board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED))
+          other = solve_with(board, iter.x, iter.y);
+
+    for (iter.x = 0; iter.x < 8 && other != NULL; iter.x++) {
+      for (iter.y = 0; iter.y < 8; iter.y++) {
+        if (!(other->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED))
+          continue;
+
+        board->cells[iter.x][iter.y].status |= CELL_PAINTED;
+        if (!kuro_check_board(board)) {
+          g_assert_true(kuro_hint_find(board, &hint));
+          g_assert_cmpint(hint.technique, !=, KURO_HINT_MISTAKE);
+        }
+      }
+    }
+
+    n_tried += (other != NULL);
+    kuro_board_free(other);
+    kuro_board_free(board);
+  }
+
+  g_assert_cmpuint(n_tried, >, 0);
+}
+
+typedef struct {
+  guint64 key;
+  KuroHint hint;
+  gboolean found;
+  guint n_results;
+} WorkerResult;
+
+static void worker_cb(guint64 key, const KuroHint *hint, gboolean found,
+                      gpointer user_data) {
+  WorkerResult *result = user_data;
+
+  result->key = key;
+  result->hint = *hint;
+  result->found = found;
+  result->n_results++;
+}
+
+/* Moves made while the worker's busy cancel what it's doing, and it carries
+ * on with the board as it ends up */
+static void test_worker(void) {
+  KuroBoard *board = kuro_test_new_board(20, 0);
+  WorkerResult result = {0};
+  KuroHintWorker *worker = kuro_hint_worker_new(worker_cb, &result);
+  KuroHint hint;
+  guint i;
+
+  for (i = 0; i < 20; i++) {
+    KuroVector cell = {(guint16)i, (guint16)((i * 7) % 20)};
+
+    if (board->cells[cell.x][cell.y].status & CELL_SHOULD_BE_PAINTED)
+      kuro_board_toggle(board, cell, CELL_PAINTED);
+    kuro_hint_worker_queue(worker, board);
+  }
+
+  while (result.n_results == 0 || result.key != kuro_board_hash(board))
+    g_main_context_iteration(NULL, TRUE);
+
+  g_assert_cmpint(result.found, ==, kuro_hint_find(board, &hint));
+  g_assert_cmpuint(result.hint.cell.x, ==, hint.cell.x);
+  g_assert_cmpuint(result.hint.cell.y, ==, hint.cell.y);
+  g_assert_cmpint(result.hint.technique, ==, hint.technique);
+
+  kuro_hint_worker_free(worker);
+  kuro_board_free(board);
+}
+
+/* Boards too big to deduce everything about still get a hint promptly. Each
+ * number here is in every row and column twice, far apart, so none of the
+ * cheap techniques get anywhere and every cell has to be tried. */
+static void test_large(void) {
+  const guint size = 200;
+  KuroBoard *board = kuro_board_new(size);
+  gint64 begin;
+  KuroHint hint;
+  guint x, y;
+
+  for (x = 0; x < size; x++)
+    for (y = 0; y < size; y++)
+      board->cells[x][y].num = (x + y) % (size / 2) + 1;
+  kuro_board_rehash(board);
+
+  begin = g_get_monotonic_time();
+  kuro_hint_find(board, &hint);
+  g_assert_cmpint(g_get_monotonic_time() - begin, <, 10 * G_USEC_PER_SEC);
+
+  kuro_board_free(board);
+}
+
+/* A cancelled hint gives up straight away, however big the board */
+static void test_cancelled(void) {
+  const guint size = 200;
+  KuroBoard *board = kuro_board_new(size);
+  GCancellable *cancellable = g_cancellable_new();
+  gint64 begin;
+  KuroHint hint;
+  guint x, y;
+
+  for (x = 0; x < size; x++)
+    for (y = 0; y < size; y++)
+      board->cells[x][y].num = (x + y) % (size / 2) + 1;
+  kuro_board_rehash(board);
+
+  g_cancellable_cancel(cancellable);
+  begin = g_get_monotonic_time();
+  kuro_hint_find_cancellable(board, &hint, cancellable);
+  g_assert_cmpint(g_get_monotonic_time() - begin, <, G_USEC_PER_SEC);
+
+  g_object_unref(cancellable);
+  kuro_board_free(board);
+}
+
+int main(int argc, char *argv[]) {
+  static const guint sizes[] = {5, 8, 10};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/hint/solve", sizes, G_N_ELEMENTS(sizes),
+                      test_solve_with_hints);
+  g_test_add_func("/hint/mistake", test_mistake);
+  g_test_add_func("/hint/other-solution", test_other_solution);
+  g_test_add_func("/hint/large", test_large);
+  g_test_add_func("/hint/worker", test_worker);
+  g_test_add_func("/hint/cancelled", test_cancelled);
+
+  return g_test_run();
+}
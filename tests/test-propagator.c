@@ -0,0 +1,294 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "propagator.h"
+#include "test-util.h"
+
+#define N_BOARDS 20
+
+static void toggle_paint(KuroBoard *board, KuroPropagator *propagator,
+                         guint x, guint y) {
+  KuroVector cell = {(guint16)x, (guint16)y};
+
+  board->cells[x][y].status ^= CELL_PAINTED;
+  kuro_propagator_update(propagator, cell);
+}
+
+/* No cell still to be painted in the solution looks like it has to stay
+ * unpainted */
+static void assert_no_solution_cuts(KuroBoard *board,
+                                    KuroPropagator *propagator) {
+  KuroVector cell;
+
+  for (cell.x = 0; cell.x < board->size; cell.x++) {
+    for (cell.y = 0; cell.y < board->size; cell.y++) {
+      if (board->cells[cell.x][cell.y].status & CELL_SHOULD_BE_PAINTED)
+        g_assert_false(kuro_propagator_is_cut(propagator, cell, 16));
+    }
+  }
+}
+
+/* Painting the solution one cell at a time never looks like a dead end, and
+ * neither does taking it back again */
+static void test_solution(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i, x, y;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    KuroPropagator *propagator = kuro_propagator_new(board);
+
+    for (x = 0; x < size; x++) {
+      for (y = 0; y < size; y++) {
+        if (board->cells[x][y].status & CELL_SHOULD_BE_PAINTED) {
+          toggle_paint(board, propagator, x, y);
+          g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                          KURO_DEAD_END_NONE);
+          assert_no_solution_cuts(board, propagator);
+        }
+      }
+    }
+
+    for (x = 0; x < size; x++) {
+      for (y = 0; y < size; y++) {
+        if (board->cells[x][y].status & CELL_PAINTED) {
+          toggle_paint(board, propagator, x, y);
+          g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                          KURO_DEAD_END_NONE);
+        }
+      }
+    }
+
+    kuro_propagator_free(propagator);
+    kuro_board_free(board);
+  }
+}
+
+/* Build a board from rows of numbers */
+static KuroBoard *board_from_rows(guint size, const guchar *rows) {
+  KuroBoard *board = kuro_board_new(size);
+  guint x, y;
+
+  for (y = 0; y < size; y++)
+    for (x = 0; x < size; x++)
+      board->cells[x][y].num = rows[y * size + x];
+
+  return board;
+}
+
+static void test_conflict(void) {
+  static const guchar rows[] = {1, 2, 3, 4, 2, 3, 4, 1,
+                                3, 4, 1, 2, 4, 1, 2, 3};
+  KuroBoard *board = board_from_rows(4, rows);
+  KuroPropagator *propagator = kuro_propagator_new(board);
+  KuroVector cell;
+
+  toggle_paint(board, propagator, 1, 1);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                  KURO_DEAD_END_NONE);
+
+  /* Next to a painted cell, so it has to be unpainted */
+  toggle_paint(board, propagator, 2, 1);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, &cell), ==,
+                  KURO_DEAD_END_CONFLICT);
+  g_assert_cmpuint(cell.x, ==, 2);
+  g_assert_cmpuint(cell.y, ==, 1);
+
+  /* Which goes away when it's undone */
+  toggle_paint(board, propagator, 2, 1);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                  KURO_DEAD_END_NONE);
+
+  kuro_propagator_free(propagator);
+  kuro_board_free(board);
+}
+
+static void test_duplicate(void) {
+  /* Painting the top left 1 leaves the 3 beside it and the 2 below it
+   * unpainted, so the other 2 in the second row has to be painted, which
+   * leaves the 3 above that unpainted too */
+  static const guchar rows[] = {1, 3, 3, 4, 2, 4, 2, 1,
+                                3, 1, 4, 2, 4, 2, 1, 3};
+  KuroBoard *board = board_from_rows(4, rows);
+  KuroPropagator *propagator = kuro_propagator_new(board);
+
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                  KURO_DEAD_END_NONE);
+
+  toggle_paint(board, propagator, 0, 0);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                  KURO_DEAD_END_DUPLICATE);
+
+  kuro_propagator_free(propagator);
+  kuro_board_free(board);
+}
+
+static void test_disconnected(void) {
+  static const guchar rows[] = {1, 2, 3, 4, 2, 3, 4, 1,
+                                3, 4, 1, 2, 4, 1, 2, 3};
+  KuroBoard *board = board_from_rows(4, rows);
+  KuroPropagator *propagator = kuro_propagator_new(board);
+  KuroVector cell;
+
+  /* Wall off the top left corner */
+  toggle_paint(board, propagator, 1, 0);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                  KURO_DEAD_END_NONE);
+
+  toggle_paint(board, propagator, 0, 1);
+  g_assert_cmpint(kuro_propagator_get_dead_end(propagator, &cell), ==,
+                  KURO_DEAD_END_DISCONNECTED);
+  g_assert_cmpuint(cell.x, ==, 0);
+  g_assert_cmpuint(cell.y, ==, 1);
+
+  kuro_propagator_free(propagator);
+  kuro_board_free(board);
+}
+
+/* Cells which would shut others off if painted are found, as long as the
+ * pocket they'd leave is small enough to look for */
+static void test_cut(void) {
+  static const guchar rows[] = {1, 2, 3, 4, 2, 3, 4, 1,
+                                3, 4, 1, 2, 4, 1, 2, 3};
+  KuroBoard *board = board_from_rows(4, rows);
+  KuroPropagator *propagator = kuro_propagator_new(board);
+  KuroVector corner = {0, 1}, middle = {2, 2}, far = {2, 0};
+
+  toggle_paint(board, propagator, 1, 0);
+
+  g_assert_true(kuro_propagator_is_cut(propagator, corner, 4));
+  g_assert_false(kuro_propagator_is_cut(propagator, middle, 4));
+
+  /* Painting (2, 0) too would leave the top right corner on its own, which
+   * is only found if pockets of one cell are looked for */
+  toggle_paint(board, propagator, 3, 1);
+  g_assert_true(kuro_propagator_is_cut(propagator, far, 1));
+  g_assert_false(kuro_propagator_is_cut(propagator, far, 0));
+
+  kuro_propagator_free(propagator);
+  kuro_board_free(board);
+}
+
+/* Following moves one at a time finds a dead end exactly when working it all
+ * out again from scratch does */
+static void test_incremental(void) {
+  KuroBoard *board = kuro_test_new_board(8, 0);
+  KuroPropagator *propagator = kuro_propagator_new(board);
+  GRand *rand = g_rand_new_with_seed(KURO_TEST_SEED);
+  guint i;
+
+  for (i = 0; i < 2000; i++) {
+    KuroPropagator *fresh;
+
+    toggle_paint(board, propagator, (guint)g_rand_int_range(rand, 0, 8),
+                 (guint)g_rand_int_range(rand, 0, 8));
+
+    fresh = kuro_propagator_new(board);
+    g_assert_cmpint(
+        kuro_propagator_get_dead_end(propagator, NULL) == KURO_DEAD_END_NONE,
+        ==, kuro_propagator_get_dead_end(fresh, NULL) == KURO_DEAD_END_NONE);
+    kuro_propagator_free(fresh);
+  }
+
+  g_rand_free(rand);
+  kuro_propagator_free(propagator);
+  kuro_board_free(board);
+}
+
+#define N_MOVES 60
+
+/* Play @moves afresh, painting and unpainting cells one at a time */
+static KuroPropagator *replay(KuroBoard *board, const KuroVector *moves,
+                              guint n_moves) {
+  KuroPropagator *propagator;
+  guint i, x, y;
+
+  for (x = 0; x < board->size; x++)
+    for (y = 0; y < board->size; y++)
+      board->cells[x][y].status &= ~CELL_PAINTED;
+
+  propagator = kuro_propagator_new(board);
+  for (i = 0; i < n_moves; i++)
+    toggle_paint(board, propagator, moves[i].x, moves[i].y);
+
+  return propagator;
+}
+
+/* Unpainting takes back exactly what followed from the cell: after playing
+ * back and forth over the solution, painting any other cell leads to a dead
+ * end just when it would starting afresh */
+static void test_unpaint(void) {
+  KuroBoard *board = kuro_test_new_board(8, 1);
+  GRand *rand = g_rand_new_with_seed(KURO_TEST_SEED);
+  KuroVector moves[N_MOVES];
+  guint n_moves = 0, i, x, y;
+
+  while (n_moves < N_MOVES) {
+    x = (guint)g_rand_int_range(rand, 0, 8);
+    y = (guint)g_rand_int_range(rand, 0, 8);
+    if (board->cells[x][y].status & CELL_SHOULD_BE_PAINTED) {
+      moves[n_moves].x = (guint16)x;
+      moves[n_moves].y = (guint16)y;
+      n_moves++;
+    }
+  }
+
+  for (i = 1; i <= N_MOVES; i++) {
+    for (x = 0; x < 8; x++) {
+      for (y = 0; y < 8; y++) {
+        KuroPropagator *propagator = replay(board, moves, i), *fresh;
+
+        if (board->cells[x][y].status & CELL_PAINTED) {
+          kuro_propagator_free(propagator);
+          continue;
+        }
+
+        toggle_paint(board, propagator, x, y);
+        fresh = kuro_propagator_new(board);
+        g_assert_cmpint(kuro_propagator_get_dead_end(propagator, NULL), ==,
+                        kuro_propagator_get_dead_end(fresh, NULL));
+
+        kuro_propagator_free(fresh);
+        kuro_propagator_free(propagator);
+      }
+    }
+  }
+
+  g_rand_free(rand);
+  kuro_board_free(board);
+}
+
+int main(int argc, char *argv[]) {
+  static const guint sizes[] = {5, 8, 10};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/propagator/solution", sizes, G_N_ELEMENTS(sizes),
+                      test_solution);
+  g_test_add_func("/propagator/conflict", test_conflict);
+  g_test_add_func("/propagator/duplicate", test_duplicate);
+  g_test_add_func("/propagator/disconnected", test_disconnected);
+  g_test_add_func("/propagator/cut", test_cut);
+  g_test_add_func("/propagator/incremental", test_incremental);
+  g_test_add_func("/propagator/unpaint", test_unpaint);
+
+  return g_test_run();
+}
@@ -0,0 +1,130 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "sat.h"
+
+/* Can't fit n + 1 pigeons into n holes, one to a hole */
+static void test_pigeonhole(void) {
+  const guint n_holes = 5, n_pigeons = n_holes + 1;
+  KuroSat *sat = kuro_sat_new(n_pigeons * n_holes);
+  guint pigeon, other, hole, clause[16];
+
+  for (pigeon = 0; pigeon < n_pigeons; pigeon++) {
+    for (hole = 0; hole < n_holes; hole++)
+      clause[hole] = KURO_SAT_LIT(pigeon * n_holes + hole, FALSE);
+    g_assert_true(kuro_sat_add_clause(sat, clause, n_holes));
+  }
+
+  for (hole = 0; hole < n_holes; hole++) {
+    for (pigeon = 0; pigeon < n_pigeons; pigeon++) {
+      for (other = pigeon + 1; other < n_pigeons; other++) {
+        clause[0] = KURO_SAT_LIT(pigeon * n_holes + hole, TRUE);
+        clause[1] = KURO_SAT_LIT(other * n_holes + hole, TRUE);
+        g_assert_true(kuro_sat_add_clause(sat, clause, 2));
+      }
+    }
+  }
+
+  /* Giving up early counts towards the running total of conflicts */
+  g_assert_cmpint(kuro_sat_solve(sat, 1), ==, KURO_SAT_UNKNOWN);
+  g_assert_cmpint(kuro_sat_solve(sat, 1), ==, KURO_SAT_UNKNOWN);
+  g_assert_cmpuint(kuro_sat_get_n_conflicts(sat), ==, 2);
+
+  g_assert_cmpint(kuro_sat_solve(sat, 0), ==, KURO_SAT_UNSATISFIABLE);
+  g_assert_cmpuint(kuro_sat_get_n_conflicts(sat), >, 2);
+  kuro_sat_free(sat);
+}
+
+/* Random 3-SAT below the threshold is usually satisfiable, and any solution
+ * found has to satisfy every clause. Clauses are added between solves. */
+static void test_random(void) {
+  const guint n_vars = 60, n_clauses = 240;
+  GRand *rand = g_rand_new_with_seed(20260101u);
+  guint round, n_satisfiable = 0;
+
+  for (round = 0; round < 20; round++) {
+    KuroSat *sat = kuro_sat_new(n_vars);
+    guint *clauses = g_new(guint, n_clauses * 3), i, j;
+    KuroSatResult result = KURO_SAT_UNKNOWN;
+
+    for (i = 0; i < n_clauses; i++) {
+      for (j = 0; j < 3; j++)
+        clauses[i * 3 + j] =
+            KURO_SAT_LIT(g_rand_int_range(rand, 0, (gint32)n_vars),
+                         g_rand_int_range(rand, 0, 2));
+      kuro_sat_add_clause(sat, &clauses[i * 3], 3);
+
+      if (i % 60 == 59)
+        result = kuro_sat_solve(sat, 0);
+    }
+
+    if (result == KURO_SAT_SATISFIABLE) {
+      n_satisfiable++;
+
+      for (i = 0; i < n_clauses; i++) {
+        gboolean satisfied = FALSE;
+
+        for (j = 0; j < 3; j++) {
+          guint lit = clauses[i * 3 + j];
+
+          satisfied |=
+              (guint)kuro_sat_get_model(sat, lit >> 1) != (lit & 1u);
+        }
+        g_assert_true(satisfied);
+      }
+    } else {
+      g_assert_cmpint(result, ==, KURO_SAT_UNSATISFIABLE);
+    }
+
+    g_free(clauses);
+    kuro_sat_free(sat);
+  }
+
+  g_assert_cmpuint(n_satisfiable, >, 0);
+  g_rand_free(rand);
+}
+
+/* Clauses of one literal are assigned straight away, and contradicting one
+ * makes the problem unsatisfiable for good */
+static void test_unit_clauses(void) {
+  KuroSat *sat = kuro_sat_new(1);
+  guint clause[1] = {KURO_SAT_LIT(0, FALSE)};
+
+  g_assert_true(kuro_sat_add_clause(sat, clause, 1));
+  g_assert_cmpint(kuro_sat_solve(sat, 0), ==, KURO_SAT_SATISFIABLE);
+  g_assert_true(kuro_sat_get_model(sat, 0));
+
+  clause[0] = KURO_SAT_LIT(0, TRUE);
+  g_assert_false(kuro_sat_add_clause(sat, clause, 1));
+  g_assert_cmpint(kuro_sat_solve(sat, 0), ==, KURO_SAT_UNSATISFIABLE);
+
+  kuro_sat_free(sat);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_func("/sat/pigeonhole", test_pigeonhole);
+  g_test_add_func("/sat/random", test_random);
+  g_test_add_func("/sat/unit-clauses", test_unit_clauses);
+
+  return g_test_run();
+}
@@ -0,0 +1,154 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "board.h"
+#include "count.h"
+#include "rules.h"
+#include "search.h"
+#include "test-util.h"
+
+#define N_BOARDS 20
+
+static const guint n_threads[] = {1, 2, 4};
+
+/* Searching agrees with counting a row at a time, however many threads share
+ * the work */
+static void test_count(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i, j;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_counted, n_searched;
+
+    g_assert_true(kuro_count_solutions(board, 100, &n_counted));
+    for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+      g_assert_true(kuro_search_count_solutions(board, 100, 0, n_threads[j],
+                                                &n_searched));
+      g_assert_cmpuint(n_searched, ==, n_counted);
+    }
+
+    kuro_board_free(board);
+  }
+}
+
+/* Wide boards agree with the SAT solver, and every thread stops once the
+ * limit is reached */
+static void test_large(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i, j;
+
+  for (i = 0; i < 3; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_solved, n_searched;
+
+    g_assert_true(kuro_count_solutions_sat(board, 2, 0, &n_solved));
+    for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+      g_assert_true(kuro_search_count_solutions(board, 2, 0, n_threads[j],
+                                                &n_searched));
+      g_assert_cmpuint(n_searched, ==, n_solved);
+    }
+
+    kuro_board_free(board);
+  }
+}
+
+/* Painting the cells the search marked solves the board, whichever thread
+ * found that solution first */
+static void test_solve(gconstpointer data) {
+  guint size = GPOINTER_TO_UINT(data), i, j;
+
+  for (i = 0; i < N_BOARDS; i++) {
+    KuroBoard *board = kuro_test_new_board(size, i);
+    guint64 n_solved, n_searched;
+
+    g_assert_true(kuro_count_solutions_sat(board, 2, 0, &n_solved));
+    for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+      KuroVector iter;
+
+      g_assert_true(kuro_search_solve(board, 2, 0, n_threads[j], &n_searched));
+      g_assert_cmpuint(n_searched, ==, n_solved);
+      if (n_searched == 0)
+        continue;
+
+      for (iter.x = 0; iter.x < size; iter.x++) {
+        for (iter.y = 0; iter.y < size; iter.y++) {
+          if (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED)
+            kuro_board_toggle(board, iter, CELL_PAINTED);
+        }
+      }
+      g_assert_true(kuro_check_board(board));
+
+      for (iter.x = 0; iter.x < size; iter.x++) {
+        for (iter.y = 0; iter.y < size; iter.y++) {
+          if (board->cells[iter.x][iter.y].status & CELL_PAINTED)
+            kuro_board_toggle(board, iter, CELL_PAINTED);
+        }
+      }
+    }
+
+    kuro_board_free(board);
+  }
+}
+
+static void test_unsolvable(void) {
+  KuroBoard *board = kuro_test_new_unsolvable_board();
+  guint64 n_searched;
+  guint j;
+
+  for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+    g_assert_true(
+        kuro_search_count_solutions(board, 2, 0, n_threads[j], &n_searched));
+    g_assert_cmpuint(n_searched, ==, 0);
+  }
+
+  kuro_board_free(board);
+}
+
+/* Running out of decisions before the search is over leaves the count
+ * unknown, and idle threads still finish */
+static void test_budget(void) {
+  KuroBoard *board = kuro_test_new_board(20, 0);
+  guint64 n_searched = 42;
+  guint j;
+
+  for (j = 0; j < G_N_ELEMENTS(n_threads); j++) {
+    g_assert_false(
+        kuro_search_count_solutions(board, 2, 1, n_threads[j], &n_searched));
+    g_assert_cmpuint(n_searched, ==, 42);
+  }
+
+  kuro_board_free(board);
+}
+
+int main(int argc, char *argv[]) {
+  static const guint sizes[] = {5, 8, 10};
+  static const guint large_sizes[] = {20};
+
+  g_test_init(&argc, &argv, NULL);
+
+  kuro_test_add_sizes("/search", sizes, G_N_ELEMENTS(sizes), test_count);
+  kuro_test_add_sizes("/search", large_sizes, G_N_ELEMENTS(large_sizes),
+                      test_large);
+  kuro_test_add_sizes("/search/solve", sizes, G_N_ELEMENTS(sizes), test_solve);
+  g_test_add_func("/search/unsolvable", test_unsolvable);
+  g_test_add_func("/search/budget", test_budget);
+
+  return g_test_run();
+}
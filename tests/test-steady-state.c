@@ -0,0 +1,219 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "alloc-counter.h"
+#include "board.h"
+#include "generator.h"
+#include "hint-worker.h"
+#include "propagator.h"
+#include "rules.h"
+#include "undo.h"
+
+#define BOARD_SIZE 8
+#define BOARD_SEED 20260101u
+#define N_MOVES 200 /* enough to need several blocks of undo items */
+#define N_GAMES 3
+
+/* As in the game */
+#define ASSIST_RADIUS 2
+#define ASSIST_BUDGET 16
+
+/* Everything a move goes through in the game, short of drawing it */
+typedef struct {
+  KuroBoard *board;
+  KuroUndoStack *stack;
+  KuroPropagator *propagator;
+  KuroHintWorker *hint_worker;
+} Game;
+
+static void hint_cb(guint64 key, const KuroHint *hint, gboolean found,
+                    gpointer user_data) {}
+
+/* Tag the cells near @cell which have to stay unpainted, as the assist does
+ * once it's been painted */
+static void assist_move(Game *game, KuroVector pos) {
+  gint dx, dy;
+
+  kuro_undo_continue_group(game->stack);
+
+  for (dx = -ASSIST_RADIUS; dx <= ASSIST_RADIUS; dx++) {
+    for (dy = -ASSIST_RADIUS; dy <= ASSIST_RADIUS; dy++) {
+      gint x = (gint)pos.x + dx, y = (gint)pos.y + dy;
+      KuroVector cell;
+
+      if (x < 0 || y < 0 || x >= BOARD_SIZE || y >= BOARD_SIZE ||
+          game->board->cells[x][y].status & (CELL_PAINTED | CELL_TAG1))
+        continue;
+
+      cell.x = (guint16)x;
+      cell.y = (guint16)y;
+      if (ABS(dx) + ABS(dy) == 1 ||
+          kuro_propagator_is_cut(game->propagator, cell, ASSIST_BUDGET)) {
+        kuro_undo_push(game->stack, UNDO_TAG1, cell);
+        kuro_undo_apply(game->stack->current, game->board);
+      }
+    }
+  }
+
+  kuro_undo_end_group(game->stack);
+}
+
+/* Paint or unpaint a cell, as clicking on it would */
+static void make_move(Game *game, guint move) {
+  KuroVector cell;
+
+  cell.x = (guint16)(move % BOARD_SIZE);
+  cell.y = (guint16)((move / BOARD_SIZE) % BOARD_SIZE);
+
+  kuro_undo_push(game->stack, UNDO_PAINT, cell);
+  kuro_undo_apply(game->stack->current, game->board);
+  kuro_propagator_update(game->propagator, cell);
+  if (game->board->cells[cell.x][cell.y].status & CELL_PAINTED)
+    assist_move(game, cell);
+
+  kuro_hint_worker_queue(game->hint_worker, game->board);
+  kuro_check_board(game->board);
+}
+
+/* Catch up with the moves from @first to @last, which have just been undone
+ * or redone */
+static void follow_moves(Game *game, const KuroUndo *first,
+                         const KuroUndo *last) {
+  const KuroUndo *move;
+
+  for (move = first; move != NULL; move = move->redo) {
+    if (move->type == UNDO_PAINT)
+      kuro_propagator_update(game->propagator, move->cell);
+    if (move == last)
+      break;
+  }
+
+  kuro_hint_worker_queue(game->hint_worker, game->board);
+  kuro_check_board(game->board);
+}
+
+static void undo(Game *game) {
+  const KuroUndo *last = game->stack->current;
+
+  follow_moves(game, kuro_undo_step_back(game->stack, game->board), last);
+}
+
+static void redo(Game *game) {
+  const KuroUndo *first = game->stack->current->redo;
+
+  follow_moves(game, first, kuro_undo_step_forward(game->stack, game->board));
+}
+
+/* Make some moves, undo and redo them all, then branch off half way back,
+ * checking the board after every step */
+static void play_game(Game *game) {
+  guint i;
+
+  for (i = 0; i < N_MOVES; i++)
+    make_move(game, i);
+
+  while (game->stack->current->type != UNDO_NEW_GAME)
+    undo(game);
+  while (game->stack->current->redo != NULL)
+    redo(game);
+
+  for (i = 0; i < N_MOVES / 2; i++)
+    undo(game);
+  for (i = 0; i < N_MOVES / 2; i++)
+    make_move(game, i * 3);
+
+  /* Back to the start for the next game */
+  while (game->stack->current->type != UNDO_NEW_GAME)
+    undo(game);
+  kuro_undo_clear(game->stack);
+}
+
+/* Once the undo stack has grown to fit a game, playing another shouldn't
+ * allocate at all. The hint worker allocates while working hints out, but
+ * in its own thread, so only allocations made by this one are counted. */
+static void test_steady_state(void) {
+  Game game;
+  guint64 n_allocations;
+  guint i;
+
+  if (!kuro_alloc_counter_is_supported()) {
+    g_test_skip("Allocations can't be counted on this platform");
+    return;
+  }
+
+  game.board = kuro_generator_new_board(BOARD_SIZE, BOARD_SEED, FALSE);
+  game.stack = kuro_undo_stack_new();
+  game.propagator = kuro_propagator_new(game.board);
+  game.hint_worker = kuro_hint_worker_new(hint_cb, NULL);
+
+  /* Warm up */
+  play_game(&game);
+
+  kuro_alloc_counter_reset();
+  for (i = 0; i < N_GAMES; i++)
+    play_game(&game);
+  n_allocations = kuro_alloc_counter_get_thread();
+
+  g_assert_cmpuint(n_allocations, ==, 0);
+
+  kuro_hint_worker_free(game.hint_worker);
+  kuro_propagator_free(game.propagator);
+  kuro_undo_stack_free(game.stack);
+  kuro_board_free(game.board);
+}
+
+/* The checks still accept the solution, and reject a broken one */
+static void test_solution(void) {
+  KuroBoard *board = kuro_generator_new_board(BOARD_SIZE, BOARD_SEED, FALSE);
+  KuroVector iter;
+
+  for (iter.x = 0; iter.x < board->size; iter.x++)
+    for (iter.y = 0; iter.y < board->size; iter.y++)
+      if (board->cells[iter.x][iter.y].status & CELL_SHOULD_BE_PAINTED)
+        board->cells[iter.x][iter.y].status |= CELL_PAINTED;
+
+  g_assert_true(kuro_check_board(board));
+
+  /* Painting next to a painted cell breaks rule 2 */
+  for (iter.x = 0; iter.x < board->size; iter.x++) {
+    for (iter.y = 0; iter.y + 1 < board->size; iter.y++) {
+      if (board->cells[iter.x][iter.y].status & CELL_PAINTED) {
+        board->cells[iter.x][iter.y + 1].status |= CELL_PAINTED;
+        g_assert_false(kuro_check_board(board));
+        g_assert_true(board->cells[iter.x][iter.y].status & CELL_ERROR);
+
+        kuro_board_free(board);
+        return;
+      }
+    }
+  }
+
+  g_assert_not_reached();
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_func("/rules/solution", test_solution);
+  g_test_add_func("/rules/steady-state-allocations", test_steady_state);
+
+  return g_test_run();
+}
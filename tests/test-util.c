@@ -0,0 +1,56 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include "generator.h"
+#include "test-util.h"
+
+/* The @index'th generated board of @size */
+KuroBoard *kuro_test_new_board(guint size, guint index) {
+  return kuro_generator_new_board(size, KURO_TEST_SEED + index, FALSE);
+}
+
+/* A board with every number the same in a row, which can't be solved, as
+ * only one cell of it could be left unpainted */
+KuroBoard *kuro_test_new_unsolvable_board(void) {
+  KuroBoard *board = kuro_board_new(4);
+  guint x, y;
+
+  for (x = 0; x < 4; x++)
+    for (y = 0; y < 4; y++)
+      board->cells[x][y].num = (y == 0) ? 1 : (x + y) % 4 + 1;
+  kuro_board_rehash(board);
+
+  return board;
+}
+
+/* Add @test_func once for each board size, as @path/NxN, passing it the size
+ * with GUINT_TO_POINTER() */
+void kuro_test_add_sizes(const gchar *path, const guint *sizes, guint n_sizes,
+                         GTestDataFunc test_func) {
+  guint i;
+
+  for (i = 0; i < n_sizes; i++) {
+    gchar *size_path = g_strdup_printf("%s/%ux%u", path, sizes[i], sizes[i]);
+
+    g_test_add_data_func(size_path, GUINT_TO_POINTER(sizes[i]), test_func);
+    g_free(size_path);
+  }
+}
@@ -0,0 +1,42 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Kuro
+ * Copyright (C) Thiago Fernandes 2026 <thiago@example.com>
+ *
+ * Kuro is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Kuro is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Kuro.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KURO_TEST_UTIL_H
+#define KURO_TEST_UTIL_H
+
+#include <glib.h>
+
+#include "board.h"
+
+G_BEGIN_DECLS
+
+/* Every test's boards are generated from seeds counting up from this, so
+ * they're the same from run to run */
+#define KURO_TEST_SEED 20260101u
+
+KuroBoard *kuro_test_new_board(guint size, guint index)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+KuroBoard *kuro_test_new_unsolvable_board(void)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void kuro_test_add_sizes(const gchar *path, const guint *sizes, guint n_sizes,
+                         GTestDataFunc test_func);
+
+G_END_DECLS
+
+#endif /* KURO_TEST_UTIL_H */